@@ -1,7 +1,76 @@
 #include "stdafx.h"
 #include "AiCharacterController.h"
+#include "Pedestrian.h"
+#include "PhysicsComponents.h"
+#include "CarnageGame.h"
+
+// max deviation from desired direction before pedestrian starts turning, sine of angle
+static const float MoveDirectionTolerance = 0.17f;
 
 void AiCharacterController::UpdateFrame(Pedestrian* pedestrian, Timespan deltaTime)
 {
+    debug_assert(pedestrian);
+
+    pedestrian->mCtlActions[ePedestrianAction_TurnLeft] = false;
+    pedestrian->mCtlActions[ePedestrianAction_TurnRight] = false;
+    pedestrian->mCtlActions[ePedestrianAction_WalkForward] = false;
+
+    if (!mHasMoveGoal)
+        return;
+
+    if (mFlowField == nullptr)
+        return;
+
+    // flow field is shared by all pedestrians heading to same goal
+    glm::vec2 moveDirection;
+    if (!gCarnageGame.mNavigationFlowFields.GetFlowDirection(mFlowField, pedestrian->mPhysicsComponent->GetPosition(), moveDirection))
+        return;
+
+    glm::vec2 signVector = pedestrian->mPhysicsComponent->GetSignVector();
+    float crossProduct = signVector.x * moveDirection.y - signVector.y * moveDirection.x;
+    float dotProduct = glm::dot(signVector, moveDirection);
+
+    // positive angular velocity rotates sign vector toward positive cross product
+    const bool facingAway = (dotProduct < 0.0f);
+    if (crossProduct > MoveDirectionTolerance || (facingAway && crossProduct >= 0.0f))
+    {
+        pedestrian->mCtlActions[ePedestrianAction_TurnRight] = true;
+    }
+    else if (crossProduct < -MoveDirectionTolerance || facingAway)
+    {
+        pedestrian->mCtlActions[ePedestrianAction_TurnLeft] = true;
+    }
+
+    // keep turning in place when facing away from desired direction
+    pedestrian->mCtlActions[ePedestrianAction_WalkForward] = !facingAway;
+}
+
+void AiCharacterController::PrepareFrame(Pedestrian* pedestrian)
+{
+    NavigationFlowFields& flowFields = gCarnageGame.mNavigationFlowFields;
+
+    // controller is shared by crowd so field gets resolved once per frame
+    if (mFlowFieldFrame == flowFields.GetFrameIndex())
+        return;
+
+    mFlowFieldFrame = flowFields.GetFrameIndex();
+    mFlowField = nullptr;
+    if (!mHasMoveGoal)
+        return;
+
+    // field is computed only once per goal, subsequent requests are cache hits
+    mFlowField = flowFields.GetFlowField(mMoveGoal);
+}
 
+void AiCharacterController::SetMoveGoal(const glm::vec3& goal)
+{
+    mMoveGoal = goal;
+    mHasMoveGoal = true;
+    mFlowFieldFrame = 0; // resolve again
+}
+
+void AiCharacterController::ClearMoveGoal()
+{
+    mHasMoveGoal = false;
+    mFlowFieldFrame = 0;
 }
@@ -2,11 +2,26 @@
 
 #include "CharacterController.h"
 
+struct NavigationFlowField;
+
 // defines ai character controller
+// single controller instance may be shared by crowd of pedestrians moving toward common goal
 class AiCharacterController final: public CharacterController
 {
 public:
     // process controller logic
     // @param deltaTime: Time since last frame
     void UpdateFrame(Pedestrian* pedestrian, Timespan deltaTime) override;
-};
\ No newline at end of file
+    void PrepareFrame(Pedestrian* pedestrian) override;
+
+    // set destination point, pedestrians will follow navigation flow field toward it
+    // @param goal: Destination world position
+    void SetMoveGoal(const glm::vec3& goal);
+    void ClearMoveGoal();
+
+private:
+    glm::vec3 mMoveGoal;
+    const NavigationFlowField* mFlowField = nullptr; // resolved before parallel update, read only while updating
+    unsigned int mFlowFieldFrame = 0; // flow fields frame index at the moment when field was resolved
+    bool mHasMoveGoal = false;
+};
@@ -7,6 +7,7 @@
 #include "PhysicsManager.h"
 #include "Pedestrian.h"
 #include "MemoryManager.h"
+#include "RenderSnapshot.h"
 
 CarnageGame gCarnageGame;
 
@@ -21,11 +22,28 @@ bool CarnageGame::Initialize()
     }
 
     gGameMap.LoadFromFile(gSystem.mStartupParams.mDebugMapName.c_str());
-    gSpriteManager.Cleanup();
-    gRenderManager.mMapRenderer.InvalidateMapMesh();
-    if (!gSpriteManager.InitLevelSprites())
+    if (!mNavigationGraph.Build())
     {
-        debug_assert(false);
+        gConsole.LogMessage(eLogMessage_Warning, "Cannot build navigation graph");
+    }
+    else if (!mNavigationHierarchy.Build())
+    {
+        gConsole.LogMessage(eLogMessage_Warning, "Cannot build navigation hierarchy");
+    }
+    if (!mTrafficLaneGraph.Build())
+    {
+        gConsole.LogMessage(eLogMessage_Warning, "Cannot build traffic lanes");
+    }
+    // there are no render resources in headless mode
+    if (!gSystem.mStartupParams.mHeadless)
+    {
+        gSpriteManager.Cleanup();
+        gRenderManager.mMapRenderer.InvalidateMapMesh();
+        gRenderManager.mSnapshots.Clear();
+        if (!gSpriteManager.InitLevelSprites())
+        {
+            debug_assert(false);
+        }
     }
     //gSpriteManager.DumpSpriteDeltas("D:/Temp/gta1_deltas");
     //gSpriteCache.DumpBlocksTexture("D:/Temp/gta1_blocks");
@@ -46,14 +64,6 @@ bool CarnageGame::Initialize()
     mPlayerPedestrian = mObjectsManager.CreatePedestrian(pos);
     mHumanController.SetCharacter(mPlayerPedestrian);
 
-
-
-    for (int icartype = 0; icartype < 6; ++icartype)
-    {
-        Vehicle* dummyCar = mObjectsManager.CreateCar(pos + glm::vec3 {2.0f + icartype * 1.3f, 0.0f, 2.0f}, icartype);
-        dummyCar->mPhysicsComponent->SetRotationAngle(cxx::angle_t::from_degrees(icartype * 60.0f));
-    }
-
     SetCameraController(&mFollowCameraController);
 
     mGameTime = 0;
@@ -62,8 +72,14 @@ bool CarnageGame::Initialize()
 
 void CarnageGame::Deinit()
 {
+    mTrafficManager.Cleanup();
+    mPedestrianDensityManager.Cleanup();
     mObjectsManager.Deinit();
     gPhysics.Deinit();
+    mTrafficLaneGraph.Cleanup();
+    mNavigationFlowFields.Cleanup();
+    mNavigationHierarchy.Cleanup();
+    mNavigationGraph.Cleanup();
     gGameMap.Cleanup();
 }
 
@@ -72,13 +88,25 @@ void CarnageGame::UpdateFrame(Timespan deltaTime)
     // advance game time
     mGameTime += deltaTime;
 
-    gSpriteManager.UpdateBlocksAnimations(deltaTime);
+    mTrafficManager.UpdateFrame(deltaTime);
+    mPedestrianDensityManager.UpdateFrame(deltaTime);
     gPhysics.UpdateFrame(deltaTime);
+    // graph is updated on its own so that it never gets stale even if hierarchy was not built
+    mNavigationGraph.UpdateModifiedChunks();
+    mNavigationHierarchy.UpdateModifiedClusters();
+    mNavigationFlowFields.UpdateFrame();
     mObjectsManager.UpdateFrame(deltaTime);
     if (mCameraController)
     {
         mCameraController->UpdateFrame(deltaTime);
     }
+}
+
+void CarnageGame::CaptureRenderSnapshot(RenderSnapshot& snapshot)
+{
+    snapshot.Clear();
+    snapshot.mCamera.SetFromCamera(gCamera);
+    mObjectsManager.CaptureDrawStates(snapshot);
 }
 
 void CarnageGame::InputEvent(KeyInputEvent& inputEvent)
@@ -93,7 +121,10 @@ void CarnageGame::InputEvent(KeyInputEvent& inputEvent)
     }
     if (inputEvent.mKeycode == KEYCODE_F3 && inputEvent.mPressed)
     {
-        gRenderManager.ReloadRenderPrograms();
+        if (!gSystem.mStartupParams.mHeadless)
+        {
+            gRenderManager.ReloadRenderPrograms();
+        }
         return;
     }
 
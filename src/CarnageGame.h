@@ -5,12 +5,23 @@
 #include "FreeLookCameraController.h"
 #include "GameObjectsManager.h"
 #include "HumanCharacterController.h"
+#include "NavigationHierarchy.h"
+#include "NavigationFlowField.h"
+#include "TrafficLaneGraph.h"
+#include "TrafficManager.h"
+#include "PedestrianDensityManager.h"
 
 // top level game application controller
 class CarnageGame final: public cxx::noncopyable
 {
 public:
     GameObjectsManager mObjectsManager;
+    NavigationGraph mNavigationGraph;
+    NavigationHierarchy mNavigationHierarchy {mNavigationGraph};
+    NavigationFlowFields mNavigationFlowFields {mNavigationGraph};
+    TrafficLaneGraph mTrafficLaneGraph;
+    TrafficManager mTrafficManager;
+    PedestrianDensityManager mPedestrianDensityManager;
     FollowCameraController mFollowCameraController;
     FreeLookCameraController mFreeLookCameraController;
     // gamestate
@@ -35,6 +46,10 @@ public:
     void InputEvent(MouseScrollInputEvent& inputEvent);
     void InputEvent(KeyCharEvent& inputEvent);
 
+    // copy state required for rendering at the end of simulation frame
+    // @param snapshot: Output snapshot
+    void CaptureRenderSnapshot(RenderSnapshot& snapshot);
+
     // public for debug purposes
     void SetCameraController(CameraController* controller);
 
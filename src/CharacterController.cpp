@@ -11,6 +11,10 @@ void CharacterController::UpdateFrame(Pedestrian* pedestrian, Timespan deltaTime
 {
 }
 
+void CharacterController::PrepareFrame(Pedestrian* pedestrian)
+{
+}
+
 void CharacterController::ResetControlState(Pedestrian* pedestrian)
 {
     // reset control actions
@@ -12,6 +12,10 @@ public:
     // @param deltaTime: Time since last frame
     virtual void UpdateFrame(Pedestrian* pedestrian, Timespan deltaTime);
 
+    // resolve shared data required by controller logic, called serially before pedestrians are updated in parallel
+    // @param pedestrian: Pedestrian which is going to be updated this frame
+    virtual void PrepareFrame(Pedestrian* pedestrian);
+
     // clear current state but keep target character bound to controller
     virtual void ResetControlState(Pedestrian* pedestrian);
 };
\ No newline at end of file
@@ -25,6 +25,8 @@ void Console::Deinit()
 
 void Console::LogMessage(eLogMessage messageCat, const char* format, ...)
 {
+    std::lock_guard<std::mutex> lock (mLinesMutex);
+
     VA_SCOPE_OPEN(format, vaList)
     cxx::f_vsnprintf(ConsoleMessageBuffer, sizeof(ConsoleMessageBuffer), format, vaList);
     VA_SCOPE_CLOSE(vaList)
@@ -42,5 +44,6 @@ void Console::LogMessage(eLogMessage messageCat, const char* format, ...)
 
 void Console::Flush()
 {
+    std::lock_guard<std::mutex> lock (mLinesMutex);
     mLines.clear();
 }
@@ -13,6 +13,7 @@ public:
     void Deinit();
 
     // Write text message in console, it could be ignored depending on currenyl active importance level filter
+    // Messages may be written from any thread
     // @param messageType: Message category
     // @param format: String format
     // @args: Arguments
@@ -23,6 +24,9 @@ public:
 
 public:
     std::deque<ConsoleLine> mLines;
+
+private:
+    std::mutex mLinesMutex;
 };
 
 extern Console gConsole;
\ No newline at end of file
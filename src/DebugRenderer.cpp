@@ -49,6 +49,8 @@ DebugRenderer::DebugRenderer()
 {
     mLineVertices.reserve(2048);
     mTrisVertices.reserve(2048);
+    mDrawLineVertices.reserve(2048);
+    mDrawTrisVertices.reserve(2048);
 }
 
 bool DebugRenderer::Initialize()
@@ -69,7 +71,14 @@ void DebugRenderer::Deinit()
 
 void DebugRenderer::RenderFrame()
 {
-    if (mLineVertices.empty() && mTrisVertices.empty())
+    // take primitives queued so far, new ones will be drawn on next frame
+    {
+        std::lock_guard<std::mutex> lock (mVerticesMutex);
+        mDrawLineVertices.swap(mLineVertices);
+        mDrawTrisVertices.swap(mTrisVertices);
+    }
+
+    if (mDrawLineVertices.empty() && mDrawTrisVertices.empty())
         return;
 
     gRenderManager.mDebugProgram.Activate();
@@ -82,13 +91,13 @@ void DebugRenderer::RenderFrame()
 
 void DebugRenderer::FlushLines()
 {
-    int numVertices = mLineVertices.size();
+    int numVertices = mDrawLineVertices.size();
 
     if (numVertices == 0)
         return;
 
     TransientBuffer vBuffer;
-    if (!mDebugVertexCache.AllocVertex(numVertices * Sizeof_Vertex3D_Debug, mLineVertices.data(), vBuffer))
+    if (!mDebugVertexCache.AllocVertex(numVertices * Sizeof_Vertex3D_Debug, mDrawLineVertices.data(), vBuffer))
     {
         debug_assert(false);
         return;
@@ -101,18 +110,18 @@ void DebugRenderer::FlushLines()
     gGraphicsDevice.BindVertexBuffer(vBuffer.mGraphicsBuffer, vFormat);
     gGraphicsDevice.RenderPrimitives(ePrimitiveType_Lines, 0, numVertices);
 
-    mLineVertices.clear();
+    mDrawLineVertices.clear();
 }
 
 void DebugRenderer::FlushTriangles()
 {
-    int numVertices = mTrisVertices.size();
+    int numVertices = mDrawTrisVertices.size();
 
     if (numVertices == 0)
         return;
 
     TransientBuffer vBuffer;
-    if (!mDebugVertexCache.AllocVertex(numVertices * Sizeof_Vertex3D_Debug, mTrisVertices.data(), vBuffer))
+    if (!mDebugVertexCache.AllocVertex(numVertices * Sizeof_Vertex3D_Debug, mDrawTrisVertices.data(), vBuffer))
     {
         debug_assert(false);
         return;
@@ -125,16 +134,18 @@ void DebugRenderer::FlushTriangles()
     gGraphicsDevice.BindVertexBuffer(vBuffer.mGraphicsBuffer, vFormat);
     gGraphicsDevice.RenderPrimitives(ePrimitiveType_Triangles, 0, numVertices);
 
-    mTrisVertices.clear();
+    mDrawTrisVertices.clear();
 }
 
 void DebugRenderer::DrawLine(const glm::vec3& point_a, const glm::vec3& point_b, unsigned int line_color)
 {
+    std::lock_guard<std::mutex> lock (mVerticesMutex);
     push_line_verts(point_a, point_b, line_color);
 }
 
 void DebugRenderer::FillTriangle(const glm::vec3& point_a, const glm::vec3& point_b, const glm::vec3& point_c, unsigned int tri_color)
 {
+    std::lock_guard<std::mutex> lock (mVerticesMutex);
     push_tri_verts(point_a, point_b, point_c, tri_color);
 }
 
@@ -164,6 +175,8 @@ void DebugRenderer::DrawCube(const glm::vec3& point_center, const glm::vec3& cub
         { point_center.x + cube_dimensions.x * 0.5f, point_center.y - cube_dimensions.y * 0.5f, point_center.z - cube_dimensions.z * 0.5f },
     };
 
+    std::lock_guard<std::mutex> lock (mVerticesMutex);
+
     // near quad
     push_line_verts(t_points[0], t_points[1], line_color); // top line
     push_line_verts(b_points[0], b_points[1], line_color); // bottom line
@@ -185,6 +198,8 @@ void DebugRenderer::DrawCube(const glm::vec3& point_center, const glm::vec3& cub
 
 void DebugRenderer::DrawSphere(const glm::vec3& point_center, float radius, unsigned int line_color)
 {
+    std::lock_guard<std::mutex> lock (mVerticesMutex);
+
     for (const auto& sphereLine : sg_sphere.lines)
     {
         const glm::vec3 startp (
@@ -21,7 +21,7 @@ public:
 private:
     void FlushLines();
     void FlushTriangles();
-    // insert line points to buffer
+    // insert line points to buffer, vertices mutex must be locked
     inline void push_line_verts(const glm::vec3& point_a, const glm::vec3& point_b, unsigned int color)
     {
         mLineVertices.emplace_back();
@@ -37,7 +37,7 @@ private:
             vertex.mColor = color;
         }
     }
-    // insert triangle points to buffer
+    // insert triangle points to buffer, vertices mutex must be locked
     inline void push_tri_verts(const glm::vec3& point_a, const glm::vec3& point_b, const glm::vec3& point_c, unsigned int color)
     {
         mTrisVertices.emplace_back();
@@ -62,6 +62,12 @@ private:
 private:
     StreamingVertexCache mDebugVertexCache;
 
+    // primitives may be queued by simulation thread while previous frame is rendered
+    std::mutex mVerticesMutex;
     std::vector<Vertex3D_Debug> mLineVertices;
     std::vector<Vertex3D_Debug> mTrisVertices;
+
+    // primitives taken for rendering current frame
+    std::vector<Vertex3D_Debug> mDrawLineVertices;
+    std::vector<Vertex3D_Debug> mDrawTrisVertices;
 };
\ No newline at end of file
@@ -0,0 +1,452 @@
+#include "stdafx.h"
+#include "GameBenchmarks.h"
+#include "GameMapManager.h"
+#include "CarnageGame.h"
+#include "PhysicsManager.h"
+
+using BenchmarkClock = std::chrono::high_resolution_clock;
+
+// get elapsed time in milliseconds
+inline double get_elapsed_ms(const BenchmarkClock::time_point& timeStart)
+{
+    return std::chrono::duration<double, std::milli>(BenchmarkClock::now() - timeStart).count();
+}
+
+// pick random pairs of walkable navigation nodes
+// @returns false if there is not enough walkable nodes on map
+static bool generate_path_queries(cxx::randomizer& random, int numQueries, int minDistance, int maxDistance,
+    std::vector<std::pair<int, int>>& outputQueries)
+{
+    const NavigationGraph& navigationGraph = gCarnageGame.mNavigationGraph;
+
+    outputQueries.reserve(numQueries);
+    for (int iattempt = 0, maxAttempts = numQueries * 10000; (int) outputQueries.size() < numQueries; ++iattempt)
+    {
+        if (iattempt == maxAttempts)
+            return false;
+
+        int startNode = navigationGraph.FindNode(random.generate_int(MAP_DIMENSIONS),
+            random.generate_int(MAP_DIMENSIONS), random.generate_int(MAP_LAYERS_COUNT));
+        if (startNode == -1)
+            continue;
+
+        int startx;
+        int starty;
+        int startLayer;
+        NavigationGraph::GetNodeLocation(startNode, startx, starty, startLayer);
+
+        int goalx = startx + random.generate_int(-maxDistance, maxDistance);
+        int goaly = starty + random.generate_int(-maxDistance, maxDistance);
+        if (glm::max(abs(goalx - startx), abs(goaly - starty)) < minDistance)
+            continue;
+
+        int goalNode = -1;
+        for (int goalLayer = 0; goalLayer < MAP_LAYERS_COUNT && goalNode == -1; ++goalLayer)
+        {
+            goalNode = navigationGraph.FindNode(goalx, goaly, goalLayer);
+        }
+        if (goalNode == -1)
+            continue;
+
+        outputQueries.emplace_back(startNode, goalNode);
+    }
+    return true;
+}
+
+// simulate dynamic bodies over map collision rectangles in separate physics world
+// @returns elapsed milliseconds
+static double simulate_map_collision(const std::vector<MapCollisionRect>& mapRects, const std::vector<glm::vec3>& positions, 
+    const std::vector<glm::vec2>& velocities, int numSteps)
+{
+    b2World physicsWorld {b2Vec2 {0.0f, 0.0f}};
+
+    b2BodyDef mapBodyDef;
+    mapBodyDef.type = b2_staticBody;
+
+    b2Body* mapBody = physicsWorld.CreateBody(&mapBodyDef);
+    for (const MapCollisionRect& currRect: mapRects)
+    {
+        b2PolygonShape shapeDef;
+        b2Vec2 center {
+            ((currRect.mX + currRect.mSizeX * 0.5f) * MAP_BLOCK_LENGTH) * PHYSICS_SCALE,
+            ((currRect.mZ + currRect.mSizeZ * 0.5f) * MAP_BLOCK_LENGTH) * PHYSICS_SCALE
+        };
+        shapeDef.SetAsBox(currRect.mSizeX * MAP_BLOCK_LENGTH * 0.5f * PHYSICS_SCALE,
+            currRect.mSizeZ * MAP_BLOCK_LENGTH * 0.5f * PHYSICS_SCALE, center, 0.0f);
+
+        b2FixtureDef fixtureDef;
+        fixtureDef.shape = &shapeDef;
+        fixtureDef.filter.categoryBits = PHYSICS_OBJCAT_MAP_SOLID_BLOCK | PHYSICS_OBJCAT_MAP_LAYER(currRect.mLayer);
+        mapBody->CreateFixture(&fixtureDef);
+    }
+
+    b2CircleShape bodyShapeDef;
+    bodyShapeDef.m_radius = PHYSICS_PED_BOUNDING_SPHERE_RADIUS * PHYSICS_SCALE;
+
+    b2FixtureDef bodyFixtureDef;
+    bodyFixtureDef.shape = &bodyShapeDef;
+    bodyFixtureDef.density = 0.3f;
+    bodyFixtureDef.filter.categoryBits = PHYSICS_OBJCAT_PED;
+
+    for (size_t ibody = 0; ibody < positions.size(); ++ibody)
+    {
+        b2BodyDef bodyDef;
+        bodyDef.type = b2_dynamicBody;
+        bodyDef.fixedRotation = true;
+        bodyDef.position.Set(positions[ibody].x * PHYSICS_SCALE, positions[ibody].z * PHYSICS_SCALE);
+        bodyDef.linearVelocity.Set(velocities[ibody].x * PHYSICS_SCALE, velocities[ibody].y * PHYSICS_SCALE);
+
+        // collide only with solid blocks on same layer
+        bodyFixtureDef.filter.maskBits = PHYSICS_OBJCAT_MAP_LAYER((int) positions[ibody].y);
+
+        b2Body* body = physicsWorld.CreateBody(&bodyDef);
+        body->CreateFixture(&bodyFixtureDef);
+    }
+
+    BenchmarkClock::time_point timeStart = BenchmarkClock::now();
+    for (int istep = 0; istep < numSteps; ++istep)
+    {
+        physicsWorld.Step(PHYSICS_SIMULATION_STEP, 3, 2);
+    }
+    return get_elapsed_ms(timeStart);
+}
+
+void GameBenchmarks::RunHeightQueries(int numPositions)
+{
+    debug_assert(numPositions > 0);
+
+    cxx::randomizer random(1);
+
+    std::vector<glm::vec3> positions(numPositions);
+    for (glm::vec3& currPosition: positions)
+    {
+        currPosition.x = random.generate_float() * MAP_DIMENSIONS;
+        currPosition.y = random.generate_float() * MAP_LAYERS_COUNT;
+        currPosition.z = random.generate_float() * MAP_DIMENSIONS;
+    }
+
+    std::vector<float> heightsSingle(numPositions);
+    std::vector<float> heightsBatched(numPositions);
+
+    BenchmarkClock::time_point timeStart = BenchmarkClock::now();
+    for (int ipos = 0; ipos < numPositions; ++ipos)
+    {
+        heightsSingle[ipos] = gGameMap.GetHeightAtPosition(positions[ipos]);
+    }
+    double singleMs = get_elapsed_ms(timeStart);
+
+    timeStart = BenchmarkClock::now();
+    gGameMap.GetHeightAtPositions(positions.data(), numPositions, heightsBatched.data());
+    double batchedMs = get_elapsed_ms(timeStart);
+
+    int numMismatches = 0;
+    for (int ipos = 0; ipos < numPositions; ++ipos)
+    {
+        if (fabs(heightsSingle[ipos] - heightsBatched[ipos]) > 0.0001f)
+        {
+            ++numMismatches;
+        }
+    }
+
+    gConsole.LogMessage(eLogMessage_Info, "Height queries (%d points): single %.3f ms, batched %.3f ms, mismatches %d",
+        numPositions, singleMs, batchedMs, numMismatches);
+}
+
+void GameBenchmarks::RunLinesOfSight(int numSegments, float segmentLength)
+{
+    debug_assert(numSegments > 0);
+
+    cxx::randomizer random(1);
+
+    std::vector<glm::vec3> origins(numSegments);
+    std::vector<glm::vec3> destinations(numSegments);
+    for (int isegment = 0; isegment < numSegments; ++isegment)
+    {
+        glm::vec3& origin = origins[isegment];
+        origin.x = random.generate_float() * MAP_DIMENSIONS;
+        origin.y = random.generate_float() * MAP_LAYERS_COUNT;
+        origin.z = random.generate_float() * MAP_DIMENSIONS;
+
+        glm::vec3& destination = destinations[isegment];
+        destination.x = origin.x + (random.generate_float() * 2.0f - 1.0f) * segmentLength;
+        destination.y = origin.y + (random.generate_float() * 2.0f - 1.0f);
+        destination.z = origin.z + (random.generate_float() * 2.0f - 1.0f) * segmentLength;
+    }
+
+    std::unique_ptr<bool[]> visibleFlags(new bool[numSegments]);
+
+    BenchmarkClock::time_point timeStart = BenchmarkClock::now();
+    int numVisible = gGameMap.TraceLinesOfSight(origins.data(), destinations.data(), numSegments, visibleFlags.get());
+    double elapsedMs = get_elapsed_ms(timeStart);
+
+    gConsole.LogMessage(eLogMessage_Info, "Lines of sight (%d segments, length %.1f): %.3f ms, visible %d",
+        numSegments, segmentLength, elapsedMs, numVisible);
+}
+
+void GameBenchmarks::RunPathQueries(int numQueries, int maxDistance)
+{
+    debug_assert(numQueries > 0);
+
+    NavigationGraph& navigationGraph = gCarnageGame.mNavigationGraph;
+
+    cxx::randomizer random(1);
+
+    // pick start and goal nodes in advance
+    std::vector<std::pair<int, int>> queries;
+    if (!generate_path_queries(random, numQueries, 0, maxDistance, queries))
+    {
+        gConsole.LogMessage(eLogMessage_Warning, "Not enough walkable nodes in navigation graph");
+        return;
+    }
+
+    std::vector<glm::vec3> pathPoints;
+    pathPoints.reserve(MAP_DIMENSIONS * 2);
+
+    int numPathsFound = 0;
+    int numPathPoints = 0;
+
+    BenchmarkClock::time_point timeStart = BenchmarkClock::now();
+    for (const std::pair<int, int>& currQuery: queries)
+    {
+        pathPoints.clear();
+        if (navigationGraph.FindPath(currQuery.first, currQuery.second, pathPoints))
+        {
+            ++numPathsFound;
+            numPathPoints += (int) pathPoints.size();
+        }
+    }
+    double elapsedMs = get_elapsed_ms(timeStart);
+
+    gConsole.LogMessage(eLogMessage_Info, "Path queries (%d, distance %d): %.3f ms, found %d, avg length %.1f",
+        numQueries, maxDistance, elapsedMs, numPathsFound, numPathsFound ? (1.0f * numPathPoints / numPathsFound) : 0.0f);
+}
+
+void GameBenchmarks::RunLongPathQueries(int numQueries, int minDistance)
+{
+    debug_assert(numQueries > 0);
+
+    NavigationGraph& navigationGraph = gCarnageGame.mNavigationGraph;
+    NavigationHierarchy& navigationHierarchy = gCarnageGame.mNavigationHierarchy;
+    if (!navigationHierarchy.IsBuilt())
+    {
+        gConsole.LogMessage(eLogMessage_Warning, "Navigation hierarchy is not built");
+        return;
+    }
+
+    cxx::randomizer random(1);
+
+    // pick start and goal nodes in advance
+    std::vector<std::pair<int, int>> queries;
+    if (!generate_path_queries(random, numQueries, minDistance, MAP_DIMENSIONS - 1, queries))
+    {
+        gConsole.LogMessage(eLogMessage_Warning, "Not enough walkable nodes in navigation graph");
+        return;
+    }
+
+    std::vector<glm::vec3> pathPoints;
+    pathPoints.reserve(MAP_DIMENSIONS * 4);
+
+    // plain search over whole graph
+    int numPathsFound = 0;
+    int numPathPoints = 0;
+    BenchmarkClock::time_point timeStart = BenchmarkClock::now();
+    for (const std::pair<int, int>& currQuery: queries)
+    {
+        pathPoints.clear();
+        if (navigationGraph.FindPath(currQuery.first, currQuery.second, pathPoints))
+        {
+            ++numPathsFound;
+            numPathPoints += (int) pathPoints.size();
+        }
+    }
+    double plainMs = get_elapsed_ms(timeStart);
+
+    // hierarchical search, second pass hits cached abstract paths
+    int numHierarchicalPathsFound = 0;
+    int numHierarchicalPathPoints = 0;
+    double hierarchicalMs[2];
+    for (int ipass = 0; ipass < 2; ++ipass)
+    {
+        numHierarchicalPathsFound = 0;
+        numHierarchicalPathPoints = 0;
+        timeStart = BenchmarkClock::now();
+        for (const std::pair<int, int>& currQuery: queries)
+        {
+            pathPoints.clear();
+            if (navigationHierarchy.FindPath(currQuery.first, currQuery.second, pathPoints))
+            {
+                ++numHierarchicalPathsFound;
+                numHierarchicalPathPoints += (int) pathPoints.size();
+            }
+        }
+        hierarchicalMs[ipass] = get_elapsed_ms(timeStart);
+    }
+
+    gConsole.LogMessage(eLogMessage_Info, "Long path queries (%d, min distance %d):", numQueries, minDistance);
+    gConsole.LogMessage(eLogMessage_Info, " - plain: %.3f ms, found %d, avg length %.1f",
+        plainMs, numPathsFound, numPathsFound ? (1.0f * numPathPoints / numPathsFound) : 0.0f);
+    gConsole.LogMessage(eLogMessage_Info, " - hierarchical: %.3f ms, cached: %.3f ms, found %d, avg length %.1f",
+        hierarchicalMs[0], hierarchicalMs[1], numHierarchicalPathsFound,
+        numHierarchicalPathsFound ? (1.0f * numHierarchicalPathPoints / numHierarchicalPathsFound) : 0.0f);
+}
+
+void GameBenchmarks::RunMapCollision(int numBodies, int numSteps)
+{
+    debug_assert(numBodies > 0);
+    debug_assert(numSteps > 0);
+
+    const NavigationGraph& navigationGraph = gCarnageGame.mNavigationGraph;
+
+    cxx::randomizer random(1);
+
+    // place bodies on walkable blocks
+    std::vector<glm::vec3> positions; // y is layer index
+    std::vector<glm::vec2> velocities;
+    positions.reserve(numBodies);
+    velocities.reserve(numBodies);
+    for (int iattempt = 0, maxAttempts = numBodies * 10000; (int) positions.size() < numBodies; ++iattempt)
+    {
+        if (iattempt == maxAttempts)
+        {
+            gConsole.LogMessage(eLogMessage_Warning, "Not enough walkable nodes in navigation graph");
+            return;
+        }
+
+        int mapx = random.generate_int(MAP_DIMENSIONS);
+        int mapz = random.generate_int(MAP_DIMENSIONS);
+        int layer = random.generate_int(MAP_LAYERS_COUNT);
+        if (navigationGraph.FindNode(mapx, mapz, layer) == -1)
+            continue;
+
+        positions.emplace_back((mapx + random.generate_float()) * MAP_BLOCK_LENGTH, layer * 1.0f, (mapz + random.generate_float()) * MAP_BLOCK_LENGTH);
+
+        cxx::angle_t direction = cxx::angle_t::from_degrees(random.generate_float() * 360.0f);
+        velocities.emplace_back(cos(glm::radians(direction.mDegrees)) * 1.5f, sin(glm::radians(direction.mDegrees)) * 1.5f);
+    }
+
+    std::vector<MapCollisionRect> blockRects;
+    std::vector<MapCollisionRect> mergedRects;
+
+    BenchmarkClock::time_point timeStart = BenchmarkClock::now();
+    for (int chunky = 0; chunky < MAP_CHUNKS_COUNT; ++chunky)
+    for (int chunkx = 0; chunkx < MAP_CHUNKS_COUNT; ++chunkx)
+    {
+        gPhysics.GetMapChunkCollisionRects(chunkx, chunky, false, blockRects);
+    }
+    double blockBuildMs = get_elapsed_ms(timeStart);
+
+    timeStart = BenchmarkClock::now();
+    for (int chunky = 0; chunky < MAP_CHUNKS_COUNT; ++chunky)
+    for (int chunkx = 0; chunkx < MAP_CHUNKS_COUNT; ++chunkx)
+    {
+        gPhysics.GetMapChunkCollisionRects(chunkx, chunky, true, mergedRects);
+    }
+    double mergedBuildMs = get_elapsed_ms(timeStart);
+
+    double blockStepMs = simulate_map_collision(blockRects, positions, velocities, numSteps);
+    double mergedStepMs = simulate_map_collision(mergedRects, positions, velocities, numSteps);
+
+    gConsole.LogMessage(eLogMessage_Info, "Map collision (%d bodies, %d steps):", numBodies, numSteps);
+    gConsole.LogMessage(eLogMessage_Info, " - per block: fixtures %d, build %.3f ms, step avg %.3f ms",
+        (int) blockRects.size(), blockBuildMs, blockStepMs / numSteps);
+    gConsole.LogMessage(eLogMessage_Info, " - merged: fixtures %d, build %.3f ms, step avg %.3f ms",
+        (int) mergedRects.size(), mergedBuildMs, mergedStepMs / numSteps);
+}
+
+void GameBenchmarks::RunCrowdContacts(int numPedestrians, int numSteps)
+{
+    debug_assert(numPedestrians > 0);
+    debug_assert(numSteps > 0);
+
+    const NavigationGraph& navigationGraph = gCarnageGame.mNavigationGraph;
+    GameObjectsManager& objectsManager = gCarnageGame.mObjectsManager;
+
+    cxx::randomizer random(1);
+
+    // find walkable block next to building
+    int centerNode = -1;
+    for (int iattempt = 0; iattempt < 100000 && centerNode == -1; ++iattempt)
+    {
+        int mapx = random.generate_int(MAP_DIMENSIONS);
+        int mapz = random.generate_int(MAP_DIMENSIONS);
+        int layer = random.generate_int(MAP_LAYERS_COUNT);
+
+        int nodeIndex = navigationGraph.FindNode(mapx, mapz, layer);
+        if (nodeIndex == -1)
+            continue;
+
+        if (gGameMap.GetBlockClamp(mapx + 1, mapz, layer)->mGroundType == eGroundType_Building ||
+            gGameMap.GetBlockClamp(mapx - 1, mapz, layer)->mGroundType == eGroundType_Building ||
+            gGameMap.GetBlockClamp(mapx, mapz + 1, layer)->mGroundType == eGroundType_Building ||
+            gGameMap.GetBlockClamp(mapx, mapz - 1, layer)->mGroundType == eGroundType_Building)
+        {
+            centerNode = nodeIndex;
+        }
+    }
+
+    if (centerNode == -1)
+    {
+        gConsole.LogMessage(eLogMessage_Warning, "Cannot find walkable block next to building");
+        return;
+    }
+
+    glm::vec3 centerPosition = navigationGraph.GetNodePosition(centerNode);
+
+    std::vector<Vehicle*> cars;
+    for (int icar = 0, numCars = glm::min((int) gGameMap.mStyleData.mCars.size(), 6); icar < numCars; ++icar)
+    {
+        cxx::angle_t direction = cxx::angle_t::from_degrees(icar * 60.0f);
+        glm::vec3 carPosition = centerPosition;
+        carPosition.x += cos(direction.to_radians()) * 2.0f;
+        carPosition.z += sin(direction.to_radians()) * 2.0f;
+
+        Vehicle* car = objectsManager.CreateCar(carPosition, icar);
+        car->mPhysicsComponent->SetRotationAngle(direction);
+        cars.push_back(car);
+    }
+
+    // pedestrians are walking towards center from all directions
+    std::vector<Pedestrian*> pedestrians;
+    pedestrians.reserve(numPedestrians);
+    for (int ipedestrian = 0; ipedestrian < numPedestrians; ++ipedestrian)
+    {
+        cxx::angle_t direction = cxx::angle_t::from_degrees(random.generate_float() * 360.0f);
+        float distance = 1.0f + random.generate_float() * 4.0f;
+
+        glm::vec3 pedestrianPosition = centerPosition;
+        pedestrianPosition.x += cos(direction.to_radians()) * distance;
+        pedestrianPosition.z += sin(direction.to_radians()) * distance;
+        pedestrianPosition.y = gGameMap.GetHeightAtPosition(pedestrianPosition);
+
+        Pedestrian* pedestrian = objectsManager.CreatePedestrian(pedestrianPosition);
+        pedestrian->mPhysicsComponent->SetLinearVelocity(glm::vec2(-cos(direction.to_radians()), -sin(direction.to_radians())));
+        pedestrians.push_back(pedestrian);
+    }
+
+    // frame time is slightly longer than simulation step so each frame does at least one step
+    int numFrames = 0;
+    int numSimulatedSteps = 0;
+    int maxContacts = 0;
+    BenchmarkClock::time_point timeStart = BenchmarkClock::now();
+    for (; numSimulatedSteps < numSteps; ++numFrames)
+    {
+        gPhysics.UpdateFrame(Timespan::FromSeconds(PHYSICS_SIMULATION_STEP) + 1);
+
+        const PhysicsSimulationStats& physicsStats = gPhysics.GetSimulationStats();
+        numSimulatedSteps += physicsStats.mFrameSteps;
+        maxContacts = glm::max(maxContacts, physicsStats.mContactsCount);
+    }
+    double elapsedMs = get_elapsed_ms(timeStart);
+
+    for (Pedestrian* currPedestrian: pedestrians)
+    {
+        objectsManager.DestroyGameObject(currPedestrian);
+    }
+    for (Vehicle* currCar: cars)
+    {
+        objectsManager.DestroyGameObject(currCar);
+    }
+
+    gConsole.LogMessage(eLogMessage_Info, "Crowd contacts (%d peds, %d cars, %d steps): %.3f ms, frame avg %.3f ms, step avg %.3f ms, max contacts %d",
+        numPedestrians, (int) cars.size(), numSimulatedSteps, elapsedMs, elapsedMs / numFrames, elapsedMs / numSimulatedSteps, maxContacts);
+}
\ No newline at end of file
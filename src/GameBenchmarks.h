@@ -0,0 +1,39 @@
+#pragma once
+
+// micro benchmarks for game subsystems, results are written to console
+class GameBenchmarks final
+{
+public:
+    // compare per point and batched map height queries
+    // @param numPositions: Number of random map points to query
+    static void RunHeightQueries(int numPositions);
+
+    // measure batched line of sight tests between random map points
+    // @param numSegments: Number of segments to trace
+    // @param segmentLength: Max distance between segment points in blocks
+    static void RunLinesOfSight(int numSegments, float segmentLength);
+
+    // measure pedestrian path queries between random walkable points
+    // @param numQueries: Number of path queries
+    // @param maxDistance: Max distance between start and goal points in blocks
+    static void RunPathQueries(int numQueries, int maxDistance);
+
+    // compare plain and hierarchical pedestrian path queries between distant walkable points
+    // @param numQueries: Number of path queries
+    // @param minDistance: Min distance between start and goal points in blocks
+    static void RunLongPathQueries(int numQueries, int minDistance);
+
+    // compare per block and merged map collision fixtures, bodies are moving over walkable map areas
+    // @param numBodies: Number of pedestrian sized dynamic bodies
+    // @param numSteps: Number of simulation steps
+    static void RunMapCollision(int numBodies, int numSteps);
+
+    // measure physics frames while pedestrians crowd around cars next to buildings,
+    // temporary objects are created in game world and destroyed afterwards
+    // @param numPedestrians: Number of pedestrians in crowd
+    // @param numSteps: Number of simulation steps
+    static void RunCrowdContacts(int numPedestrians, int numSteps);
+
+private:
+    GameBenchmarks();
+};
\ No newline at end of file
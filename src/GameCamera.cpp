@@ -2,6 +2,7 @@
 #include "GameCamera.h"
 
 GameCamera gCamera;
+GameCamera gRenderCamera;
 
 GameCamera::GameCamera()
     : mProjMatrixDirty(true)
@@ -156,3 +157,16 @@ void GameCamera::SetOrientation(const glm::vec3& dirForward, const glm::vec3& di
     mRightDirection = dirRight;
     mViewMatrixDirty = true;
 }
+
+void GameCamera::SetFromCamera(const GameCamera& sourceCamera)
+{
+    mPosition = sourceCamera.mPosition;
+    mFrontDirection = sourceCamera.mFrontDirection;
+    mUpDirection = sourceCamera.mUpDirection;
+    mRightDirection = sourceCamera.mRightDirection;
+    mCurrentMode = sourceCamera.mCurrentMode;
+    mPerspectiveParams = sourceCamera.mPerspectiveParams;
+    mOrthographicParams = sourceCamera.mOrthographicParams;
+    mProjMatrixDirty = true;
+    mViewMatrixDirty = true;
+}
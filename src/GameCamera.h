@@ -70,6 +70,10 @@ public:
     // Will swap Z and Y direction vectors
     void SetTopDownOrientation();
 
+    // Copy position, orientation and projection parameters from other camera
+    // @param sourceCamera: Source camera
+    void SetFromCamera(const GameCamera& sourceCamera);
+
 private:
     bool mProjMatrixDirty; // projection matrix need recomputation
     bool mViewMatrixDirty; // view matrix need recomputation
@@ -95,4 +99,7 @@ private:
     OrthographicParams mOrthographicParams;
 };
 
-extern GameCamera gCamera;
\ No newline at end of file
+extern GameCamera gCamera;
+
+// camera used by renderer, it is restored from render snapshot each frame and must not be touched by game logic
+extern GameCamera gRenderCamera;
\ No newline at end of file
@@ -5,6 +5,7 @@
 #include "PhysicsManager.h"
 #include "CarnageGame.h"
 #include "Pedestrian.h"
+#include "GameBenchmarks.h"
 
 GameCheatsWindow gGameCheatsWindow;
 
@@ -103,6 +104,37 @@ void GameCheatsWindow::DoUI(Timespan deltaTime)
     {
         ImGui::Checkbox("Enable map collisions", &mEnableMapCollisions);
         ImGui::Checkbox("Enable gravity", &mEnableGravity);
+
+        const PhysicsSimulationStats& physicsStats = gPhysics.GetSimulationStats();
+        ImGui::Text("steps: %d, pending: %d", physicsStats.mFrameSteps, physicsStats.mPendingSteps);
+        ImGui::Text("catch-up frames: %d", physicsStats.mCatchUpFramesCount);
+        ImGui::Text("dropped time: %.3fs in %d frames", physicsStats.mDroppedTime, physicsStats.mDropFramesCount);
+        ImGui::Text("contacts: %d", physicsStats.mContactsCount);
+        if (ImGui::Button("Save snapshot"))
+        {
+            gPhysics.SaveSnapshot(mPhysicsSnapshot);
+        }
+        ImGui::SameLine();
+        if (ImGui::Button("Restore snapshot") && !mPhysicsSnapshot.empty())
+        {
+            if (!gPhysics.RestoreSnapshot(mPhysicsSnapshot))
+            {
+                gConsole.LogMessage(eLogMessage_Warning, "Cannot restore physics snapshot");
+            }
+        }
+        ImGui::Text("snapshot: %d bytes", (int) mPhysicsSnapshot.size());
+        ImGui::Text("map fixtures: %d, chunks: %d", gPhysics.GetMapCollisionFixturesCount(), gPhysics.GetMapCollisionStreamedChunksCount());
+        ImGui::Separator();
+    }
+
+    if (ImGui::CollapsingHeader("Population"))
+    {
+        const PedestrianDensityStats& pedestriansStats = gCarnageGame.mPedestrianDensityManager.GetStats();
+        ImGui::Text("peds: %d / %d", pedestriansStats.mLiveCount, pedestriansStats.mTargetCount);
+        ImGui::Text("peds spawns: %.1f/s, despawns: %.1f/s", pedestriansStats.mSpawnsPerSecond, pedestriansStats.mDespawnsPerSecond);
+        ImGui::Text("peds pool: %d, high water mark: %d", pedestriansStats.mPoolAllocatedCount, pedestriansStats.mPoolHighWaterMark);
+        ImGui::Text("traffic cars: %d, physics: %d", gCarnageGame.mTrafficManager.GetCarsCount(), 
+            gCarnageGame.mTrafficManager.GetPhysicsCarsCount());
         ImGui::Separator();
     }
 
@@ -142,5 +174,33 @@ void GameCheatsWindow::DoUI(Timespan deltaTime)
         }
     }
 
+    if (ImGui::CollapsingHeader("Benchmarks"))
+    {
+        if (ImGui::Button("Map height queries"))
+        {
+            GameBenchmarks::RunHeightQueries(1024 * 1024);
+        }
+        if (ImGui::Button("Map lines of sight"))
+        {
+            GameBenchmarks::RunLinesOfSight(64 * 1024, 32.0f);
+        }
+        if (ImGui::Button("Navigation paths"))
+        {
+            GameBenchmarks::RunPathQueries(500, 32);
+        }
+        if (ImGui::Button("Navigation long paths"))
+        {
+            GameBenchmarks::RunLongPathQueries(200, 128);
+        }
+        if (ImGui::Button("Map collision"))
+        {
+            GameBenchmarks::RunMapCollision(1000, 300);
+        }
+        if (ImGui::Button("Crowd contacts"))
+        {
+            GameBenchmarks::RunCrowdContacts(1000, 300);
+        }
+    }
+
     ImGui::End();
 }
\ No newline at end of file
@@ -11,6 +11,8 @@ public:
     bool mEnableGravity;
     bool mEnableBlocksAnimation;
 
+    std::vector<unsigned char> mPhysicsSnapshot; // saved physics state for quick retry
+
 public:
     GameCheatsWindow();
     // process window state
@@ -17,6 +17,10 @@
 #define MAP_DIMENSIONS 256
 #define MAP_LAYERS_COUNT 6
 
+// map blocks are stored in chunks of columns, chunk contains all layers
+#define MAP_CHUNK_DIMENSIONS 16
+#define MAP_CHUNKS_COUNT (MAP_DIMENSIONS / MAP_CHUNK_DIMENSIONS)
+
 #define MAP_PIXELS_PER_TILE MAP_BLOCK_TEXTURE_DIMS
 
 #define SPRITE_ZERO_ANGLE 90.0f // all sprites in game are rotated at 90 degrees
@@ -136,8 +140,21 @@ decl_enum_strings(eBlockFace);
 using SpriteDeltaBits_t = unsigned int;
 static_assert(sizeof(SpriteDeltaBits_t) * 8 >= MAX_SPRITE_DELTAS, "Delta bits underlying type is too small, see MAX_SPRITE_DELTAS");
 
+// game object identifier is generational handle - lower bits store object slot index,
+// upper bits store slot generation which changes each time slot gets reused
 using GameObjectID_t = unsigned int;
 
+#define GAMEOBJECT_ID_NULL 0
+#define GAMEOBJECT_ID_INDEX_BITS 20
+#define GAMEOBJECT_ID_INDEX_MASK ((1U << GAMEOBJECT_ID_INDEX_BITS) - 1)
+#define GAMEOBJECT_ID_GENERATION_MASK ((1U << (32 - GAMEOBJECT_ID_INDEX_BITS)) - 1)
+
+// get object slot index from identifier
+inline int GetGameObjectSlotIndex(GameObjectID_t objectID)
+{
+    return static_cast<int>(objectID & GAMEOBJECT_ID_INDEX_MASK);
+}
+
 // defines draw vertex of city mesh
 struct CityVertex3D
 {
@@ -741,4 +758,15 @@ enum ePedestrianState
     ePedestrianState_COUNT
 };
 
-decl_enum_strings(ePedestrianState);
\ No newline at end of file
+decl_enum_strings(ePedestrianState);
+
+// game object simulation level of detail, chosen by distance to camera
+enum eSimulationLOD
+{
+    eSimulationLOD_Full, // updated every frame
+    eSimulationLOD_Reduced, // updated every few frames with accumulated delta time
+    eSimulationLOD_Dormant, // not updated, physics body is put to sleep
+    eSimulationLOD_COUNT
+};
+
+decl_enum_strings(eSimulationLOD);
\ No newline at end of file
@@ -21,6 +21,13 @@ public:
     static float GetSlopeHeightMin(int slope);
     static float GetSlopeHeightMax(int slope);
 
+    // get slope linear interpolation params, height = lerp(slopeMin, slopeMax, alongX ? posx : posy)
+    // @param slope: Index
+    // @param slopeMin, slopeMax: Heights at start and at end of slope
+    // @param alongX: Slope direction, x or y
+    // @returns false if there is no slope
+    static bool GetSlopeParams(int slope, float& slopeMin, float& slopeMax, bool& alongX);
+
 private:
     GameMapHelpers();
     // internals
@@ -1,6 +1,11 @@
 #include "stdafx.h"
 #include "GameMapManager.h"
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #define GAMEMAP_SSE2_HEIGHT_QUERIES
+    #include <emmintrin.h>
+#endif
+
 GameMapManager gGameMap;
 
 //////////////////////////////////////////////////////////////////////////
@@ -62,6 +67,94 @@ struct GTAFileHeaderCMP
     int nav_data_size;
 };
 
+//////////////////////////////////////////////////////////////////////////
+
+enum
+{
+    MAP_CACHE_FILE_MAGIC = 0x434D3343, // 'C3MC'
+    MAP_CACHE_FILE_VERSION = 4,
+};
+
+static const char* MapCacheDirectory = "cache";
+
+// binary map cache file header, followed by MapData and height index
+struct MapCacheFileHeader
+{
+    unsigned int mMagic;
+    unsigned int mVersion;
+    unsigned int mSizeofBlockStyle;
+    unsigned int mDataLength;
+    unsigned int mHeightIndexLength;
+    unsigned int mReserved;
+    unsigned long long mSourceLength; // source map file length
+    long long mSourceWriteTime; // source map file last write time
+    unsigned long long mSourceChecksum; // source map file checksum, used only if write time does not match
+};
+
+// compute FNV-1a checksum of data
+inline unsigned long long compute_checksum(const void* data, unsigned int dataLength, unsigned long long checksum = 14695981039346656037ULL)
+{
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    for (unsigned int ibyte = 0; ibyte < dataLength; ++ibyte)
+    {
+        checksum ^= bytes[ibyte];
+        checksum *= 1099511628211ULL;
+    }
+    return checksum;
+}
+
+// compute FNV-1a checksum of whole stream content, read position is restored afterwards
+inline bool compute_stream_checksum(std::ifstream& filestream, unsigned long long& outputChecksum)
+{
+    outputChecksum = compute_checksum(nullptr, 0);
+
+    filestream.clear(); // stream could be read till the end
+    const std::streampos readPosition = filestream.tellg();
+    filestream.seekg(0, std::ios::beg);
+
+    char buffer[16 * 1024];
+    for (;;)
+    {
+        filestream.read(buffer, sizeof(buffer));
+        unsigned int numBytesRead = static_cast<unsigned int>(filestream.gcount());
+        if (numBytesRead == 0)
+            break;
+
+        outputChecksum = compute_checksum(buffer, numBytesRead, outputChecksum);
+    }
+
+    if (filestream.bad())
+        return false;
+
+    filestream.clear(); // reset eof flag
+    filestream.seekg(readPosition, std::ios::beg);
+    return true;
+}
+
+GameMapManager::GameMapManager()
+    : mMapData()
+    , mMapDataStorage(new MapData())
+    , mMapVersion()
+{
+    mMapData = mMapDataStorage.get();
+    memset(mChunksVersions, 0, sizeof(mChunksVersions));
+    for (int islope = 0; islope < CountOf(mSlopeLerpParams); ++islope)
+    {
+        float slopeMin = 0.0f;
+        float slopeMax = 0.0f;
+        bool alongX = false;
+        // slope types above 44 are not ramps
+        if (islope > 44 || !GameMapHelpers::GetSlopeParams(islope, slopeMin, slopeMax, alongX))
+        {
+            slopeMin = 0.0f;
+            slopeMax = 0.0f;
+        }
+        mSlopeLerpParams[islope].mHeightMin = slopeMin;
+        mSlopeLerpParams[islope].mHeightDelta = slopeMax - slopeMin;
+        mSlopeLerpParams[islope].mAlongXMask = alongX ? 0xFFFFFFFFU : 0U;
+    }
+}
+
 bool GameMapManager::LoadFromFile(const char* filename)
 {
     Cleanup();
@@ -80,10 +173,31 @@ bool GameMapManager::LoadFromFile(const char* filename)
         return false;
     }
 
-    if (!ReadCompressedMapData(file, header.column_size, header.block_size))
+    // source file is identified by its size and write time, so it is not read when cache is valid
+    std::string sourcePath;
+    unsigned long long sourceLength = 0;
+    long long sourceWriteTime = 0;
+    const bool useMapCache = gSystem.mConfig.mEnableMapCache && gFiles.GetFullPathToFile(filename, sourcePath) &&
+        cxx::get_file_stats(sourcePath, sourceLength, sourceWriteTime);
+
+    if (useMapCache && LoadMapCache(filename, file, sourceLength, sourceWriteTime))
     {
-        gConsole.LogMessage(eLogMessage_Warning, "Cannot read compressed map data from '%s'", filename);
-        return false;
+        gConsole.LogMessage(eLogMessage_Debug, "Map data loaded from cache");
+    }
+    else
+    {
+        if (!ReadCompressedMapData(file, header.column_size, header.block_size))
+        {
+            gConsole.LogMessage(eLogMessage_Warning, "Cannot read compressed map data from '%s'", filename);
+            return false;
+        }
+
+        BuildHeightIndex();
+
+        if (useMapCache && !SaveMapCache(filename, file, sourceLength, sourceWriteTime))
+        {
+            gConsole.LogMessage(eLogMessage_Warning, "Cannot save map cache for '%s'", filename);
+        }
     }
 
     // load corresponding style data
@@ -101,14 +215,21 @@ bool GameMapManager::LoadFromFile(const char* filename)
 void GameMapManager::Cleanup()
 {
     mStyleData.Cleanup();
-    for (int tiley = 0; tiley < MAP_DIMENSIONS; ++tiley)
-    for (int tilex = 0; tilex < MAP_DIMENSIONS; ++tilex)
+
+    mMapCacheFile.unmap_file();
+    if (mMapDataStorage)
     {
-        for (int tilez = 0; tilez < MAP_LAYERS_COUNT; ++tilez)
-        {
-            memset(&mMapTiles[tilez][tiley][tilex], 0, Sizeof_BlockStyle);
-        }
+        memset(mMapDataStorage.get(), 0, sizeof(MapData));
+    }
+    else
+    {
+        mMapDataStorage.reset(new MapData());
     }
+    mMapData = mMapDataStorage.get();
+    memset(mHeightIndex, 0, sizeof(mHeightIndex));
+
+    // keep counting so data built for previous map never gets reused
+    BumpAllChunksVersions();
 }
 
 bool GameMapManager::IsLoaded() const
@@ -120,7 +241,7 @@ bool GameMapManager::ReadCompressedMapData(std::ifstream& file, int columnLength
 {
     // reading base data
     const int baseDataLength = MAP_DIMENSIONS * MAP_DIMENSIONS * sizeof(int);
-    if (!file.read(reinterpret_cast<char*>(mBaseTilesData), baseDataLength))
+    if (!file.read(reinterpret_cast<char*>(mMapData->mBaseTilesData), baseDataLength))
         return false;
 
     // reading column data
@@ -179,13 +300,13 @@ bool GameMapManager::ReadCompressedMapData(std::ifstream& file, int columnLength
     for (int tiley = 0; tiley < MAP_DIMENSIONS; ++tiley)
     for (int tilex = 0; tilex < MAP_DIMENSIONS; ++tilex)
     {
-        const int columnElement = mBaseTilesData[tiley][tilex] / sizeof(unsigned short);
-        assert((mBaseTilesData[tiley][tilex] % sizeof(unsigned short)) == 0);
+        const int columnElement = mMapData->mBaseTilesData[tiley][tilex] / sizeof(unsigned short);
+        assert((mMapData->mBaseTilesData[tiley][tilex] % sizeof(unsigned short)) == 0);
         const int columnHeight = MAP_LAYERS_COUNT - columnData[columnElement];
         for (int tilez = 0; tilez < columnHeight; ++tilez)
         {
             int srcBlock = columnData[columnElement + columnHeight - tilez];
-            mMapTiles[tilez][tiley][tilex] = blocksData[srcBlock];
+            GetBlockData(tilex, tiley, tilez) = blocksData[srcBlock];
         }
     }
     //FixShiftedBits();
@@ -198,7 +319,7 @@ BlockStyle* GameMapManager::GetBlock(int coordx, int coordy, int layer) const
     debug_assert(coordx > -1 && coordx < MAP_DIMENSIONS);
     debug_assert(coordy > -1 && coordy < MAP_DIMENSIONS);
     // remember kids, don't try this at home!
-    return const_cast<BlockStyle*> (&mMapTiles[layer][coordy][coordx]);
+    return &GetBlockData(coordx, coordy, layer);
 }
 
 BlockStyle* GameMapManager::GetBlockClamp(int coordx, int coordy, int layer) const
@@ -207,7 +328,83 @@ BlockStyle* GameMapManager::GetBlockClamp(int coordx, int coordy, int layer) con
     coordx = glm::clamp(coordx, 0, MAP_DIMENSIONS - 1);
     coordy = glm::clamp(coordy, 0, MAP_DIMENSIONS - 1);
     // remember kids, don't try this at home!
-    return const_cast<BlockStyle*> (&mMapTiles[layer][coordy][coordx]);
+    return &GetBlockData(coordx, coordy, layer);
+}
+
+void GameMapManager::SetBlock(int coordx, int coordy, int layer, const BlockStyle& blockData)
+{
+    debug_assert(layer > -1 && layer < MAP_LAYERS_COUNT);
+    debug_assert(coordx > -1 && coordx < MAP_DIMENSIONS);
+    debug_assert(coordy > -1 && coordy < MAP_DIMENSIONS);
+
+    BlockStyle& mapBlock = GetBlockData(coordx, coordy, layer);
+    mapBlock = blockData;
+    mapBlock.mSlopeType &= 0x3F; // same range as in map file, slope tables are indexed by it
+    UpdateHeightIndex(coordx, coordy);
+
+    // collision and mesh data of neighbour columns depends on that block too,
+    // so adjacent chunks get invalidated when block lies on chunk border
+    const int chunkxMin = (coordx - 1 < 0) ? 0 : (coordx - 1) / MAP_CHUNK_DIMENSIONS;
+    const int chunkyMin = (coordy - 1 < 0) ? 0 : (coordy - 1) / MAP_CHUNK_DIMENSIONS;
+    const int chunkxMax = glm::min(coordx + 1, MAP_DIMENSIONS - 1) / MAP_CHUNK_DIMENSIONS;
+    const int chunkyMax = glm::min(coordy + 1, MAP_DIMENSIONS - 1) / MAP_CHUNK_DIMENSIONS;
+    for (int currChunky = chunkyMin; currChunky <= chunkyMax; ++currChunky)
+    for (int currChunkx = chunkxMin; currChunkx <= chunkxMax; ++currChunkx)
+    {
+        ++mChunksVersions[currChunky][currChunkx];
+    }
+    ++mMapVersion;
+}
+
+void GameMapManager::ClearBlock(int coordx, int coordy, int layer)
+{
+    BlockStyle blockData;
+    memset(&blockData, 0, sizeof(blockData));
+    blockData.mGroundType = eGroundType_Air;
+
+    SetBlock(coordx, coordy, layer, blockData);
+}
+
+void GameMapManager::SetBlockLid(int coordx, int coordy, int layer, int lidFace)
+{
+    debug_assert(lidFace > -1 && lidFace < 256);
+
+    BlockStyle blockData = *GetBlock(coordx, coordy, layer);
+    blockData.mFaces[eBlockFace_Lid] = lidFace;
+
+    SetBlock(coordx, coordy, layer, blockData);
+}
+
+void GameMapManager::SetBlockSlope(int coordx, int coordy, int layer, int slopeType)
+{
+    debug_assert(slopeType > -1 && slopeType < 64);
+
+    BlockStyle blockData = *GetBlock(coordx, coordy, layer);
+    blockData.mSlopeType = slopeType;
+
+    SetBlock(coordx, coordy, layer, blockData);
+}
+
+unsigned int GameMapManager::GetChunkVersion(int chunkx, int chunky) const
+{
+    debug_assert(chunkx > -1 && chunkx < MAP_CHUNKS_COUNT);
+    debug_assert(chunky > -1 && chunky < MAP_CHUNKS_COUNT);
+    return mChunksVersions[chunky][chunkx];
+}
+
+unsigned int GameMapManager::GetMapVersion() const
+{
+    return mMapVersion;
+}
+
+void GameMapManager::BumpAllChunksVersions()
+{
+    for (int chunky = 0; chunky < MAP_CHUNKS_COUNT; ++chunky)
+    for (int chunkx = 0; chunkx < MAP_CHUNKS_COUNT; ++chunkx)
+    {
+        ++mChunksVersions[chunky][chunkx];
+    }
+    ++mMapVersion;
 }
 
 void GameMapManager::FixShiftedBits()
@@ -228,8 +425,8 @@ void GameMapManager::FixShiftedBits()
     {
         for (int tilez = 0; tilez < MAP_LAYERS_COUNT - 2; ++tilez)
         {
-            BlockStyle& currBlock = mMapTiles[tilez][tiley][tilex];
-            BlockStyle& aboveBlock = mMapTiles[tilez + 1][tiley][tilex];
+            BlockStyle& currBlock = GetBlockData(tilex, tiley, tilez);
+            BlockStyle& aboveBlock = GetBlockData(tilex, tiley, tilez + 1);
 
             currBlock.mLeftDirection = aboveBlock.mLeftDirection;
             currBlock.mRightDirection = aboveBlock.mRightDirection;
@@ -240,7 +437,7 @@ void GameMapManager::FixShiftedBits()
         }
 
         // top most block set to air
-        BlockStyle& topBlock = mMapTiles[MAP_LAYERS_COUNT - 1][tiley][tilex];
+        BlockStyle& topBlock = GetBlockData(tilex, tiley, MAP_LAYERS_COUNT - 1);
         topBlock.mLeftDirection = 0;
         topBlock.mRightDirection = 0;
         topBlock.mDownDirection = 0;
@@ -256,33 +453,144 @@ float GameMapManager::GetHeightAtPosition(const glm::vec3& position) const
     int mapcoordy = (int) position.z;
     int maplayer = (int) (position.y + 0.5f);
 
-    float height = maplayer * 1.0f; // reset height to ground
+    int slope = 0;
+    float height = GetGroundHeight(mapcoordx, mapcoordy, maplayer, slope);
+    if (slope) // compute slope height
+    {
+        float cx = position.x - mapcoordx;
+        float cy = position.z - mapcoordy;
+        height += GameMapHelpers::GetSlopeHeight(slope, cx, cy);
+    }
+    return height;
+}
+
+float GameMapManager::GetGroundHeight(int coordx, int coordy, int layer, int& slopeType) const
+{
+    slopeType = 0;
+    if (layer < 1) // nothing below
+        return layer * 1.0f;
 
-    for (;height > 0.0f;)
+    const MapGroundInfo& groundInfo = mHeightIndex[glm::clamp(coordy, 0, MAP_DIMENSIONS - 1)]
+        [glm::clamp(coordx, 0, MAP_DIMENSIONS - 1)][glm::min(layer, MAP_LAYERS_COUNT - 1)];
+
+    slopeType = groundInfo.mSlopeType;
+    // top most layer is solid, so ground is exactly at start position
+    if (layer >= MAP_LAYERS_COUNT && groundInfo.mLayer == MAP_LAYERS_COUNT - 1)
+        return layer * 1.0f;
+
+    return groundInfo.mLayer * 1.0f;
+}
+
+void GameMapManager::GetHeightAtPositions(const glm::vec3* positions, int numPositions, float* outputHeights) const
+{
+    debug_assert(numPositions == 0 || (positions && outputHeights));
+
+    int icurrent = 0;
+#ifdef GAMEMAP_SSE2_HEIGHT_QUERIES
+    alignas(16) int lanesCoordX[4];
+    alignas(16) int lanesCoordY[4];
+    alignas(16) int lanesLayer[4];
+    alignas(16) float lanesGroundHeight[4];
+    alignas(16) float lanesSlopeMin[4];
+    alignas(16) float lanesSlopeDelta[4];
+    alignas(16) unsigned int lanesAlongXMask[4];
+
+    const __m128 halfBlock = _mm_set1_ps(0.5f);
+    for (; icurrent + 4 <= numPositions; icurrent += 4)
     {
-        BlockStyle* blockData = GetBlockClamp(mapcoordx, mapcoordy, maplayer);
+        const glm::vec3* currPositions = positions + icurrent;
+        __m128 posx = _mm_setr_ps(currPositions[0].x, currPositions[1].x, currPositions[2].x, currPositions[3].x);
+        __m128 posy = _mm_setr_ps(currPositions[0].y, currPositions[1].y, currPositions[2].y, currPositions[3].y);
+        __m128 posz = _mm_setr_ps(currPositions[0].z, currPositions[1].z, currPositions[2].z, currPositions[3].z);
+
+        // truncate to map coords
+        __m128i mapcoordx = _mm_cvttps_epi32(posx);
+        __m128i mapcoordy = _mm_cvttps_epi32(posz);
+        __m128i maplayer = _mm_cvttps_epi32(_mm_add_ps(posy, halfBlock));
+        _mm_store_si128(reinterpret_cast<__m128i*>(lanesCoordX), mapcoordx);
+        _mm_store_si128(reinterpret_cast<__m128i*>(lanesCoordY), mapcoordy);
+        _mm_store_si128(reinterpret_cast<__m128i*>(lanesLayer), maplayer);
+
+        // fetch ground info
+        for (int ilane = 0; ilane < 4; ++ilane)
+        {
+            int slope = 0;
+            lanesGroundHeight[ilane] = GetGroundHeight(lanesCoordX[ilane], lanesCoordY[ilane], lanesLayer[ilane], slope);
+
+            const SlopeLerpParams& slopeParams = mSlopeLerpParams[slope];
+            lanesSlopeMin[ilane] = slopeParams.mHeightMin;
+            lanesSlopeDelta[ilane] = slopeParams.mHeightDelta;
+            lanesAlongXMask[ilane] = slopeParams.mAlongXMask;
+        }
+
+        // compute slope heights, non slope blocks have zero min and delta
+        __m128 cx = _mm_sub_ps(posx, _mm_cvtepi32_ps(mapcoordx));
+        __m128 cy = _mm_sub_ps(posz, _mm_cvtepi32_ps(mapcoordy));
+        __m128 alongXMask = _mm_castsi128_ps(_mm_load_si128(reinterpret_cast<const __m128i*>(lanesAlongXMask)));
+        __m128 t = _mm_or_ps(_mm_and_ps(alongXMask, cx), _mm_andnot_ps(alongXMask, cy));
+        __m128 slopeHeight = _mm_add_ps(_mm_load_ps(lanesSlopeMin), _mm_mul_ps(t, _mm_load_ps(lanesSlopeDelta)));
+        _mm_storeu_ps(outputHeights + icurrent, _mm_add_ps(_mm_load_ps(lanesGroundHeight), slopeHeight));
+    }
+#endif
+
+    // scalar path, also processes remaining points
+    for (; icurrent < numPositions; ++icurrent)
+    {
+        const glm::vec3& position = positions[icurrent];
+
+        int mapcoordx = (int) position.x;
+        int mapcoordy = (int) position.z;
+        int maplayer = (int) (position.y + 0.5f);
 
-        // slope
-        int slope = blockData->mSlopeType;
+        int slope = 0;
+        float height = GetGroundHeight(mapcoordx, mapcoordy, maplayer, slope);
 
-        if (slope) // compute slope height
+        const SlopeLerpParams& slopeParams = mSlopeLerpParams[slope];
+        float t = slopeParams.mAlongXMask ? (position.x - mapcoordx) : (position.z - mapcoordy);
+        outputHeights[icurrent] = height + (slopeParams.mHeightMin + t * slopeParams.mHeightDelta);
+    }
+}
+
+void GameMapManager::BuildHeightIndex()
+{
+    for (int tiley = 0; tiley < MAP_DIMENSIONS; ++tiley)
+    for (int tilex = 0; tilex < MAP_DIMENSIONS; ++tilex)
+    {
+        UpdateHeightIndex(tilex, tiley);
+    }
+}
+
+void GameMapManager::UpdateHeightIndex(int coordx, int coordy)
+{
+    debug_assert(coordx > -1 && coordx < MAP_DIMENSIONS);
+    debug_assert(coordy > -1 && coordy < MAP_DIMENSIONS);
+
+    MapGroundInfo* columnInfo = mHeightIndex[coordy][coordx];
+
+    // there is nothing below first layer
+    columnInfo[0].mLayer = 0;
+    columnInfo[0].mSlopeType = 0;
+
+    // walk from bottom to top, each layer either stops falling or falls through to layer below
+    for (int maplayer = 1; maplayer < MAP_LAYERS_COUNT; ++maplayer)
+    {
+        const BlockStyle& blockData = GetBlockData(coordx, coordy, maplayer);
+        if (blockData.mSlopeType)
         {
-            float cx = position.x - mapcoordx;
-            float cy = position.z - mapcoordy;
-            height += GameMapHelpers::GetSlopeHeight(slope, cx, cy);
-            break;
+            columnInfo[maplayer].mLayer = maplayer;
+            columnInfo[maplayer].mSlopeType = blockData.mSlopeType;
+            continue;
         }
 
-        if (blockData->mGroundType == eGroundType_Air || blockData->mGroundType == eGroundType_Water) // fall through non solid block
+        if (blockData.mGroundType == eGroundType_Air || blockData.mGroundType == eGroundType_Water) // fall through non solid block
         {
-            height -= MAP_BLOCK_LENGTH;
-            --maplayer;
+            columnInfo[maplayer] = columnInfo[maplayer - 1];
             continue;
         }
 
-        break;
+        columnInfo[maplayer].mLayer = maplayer;
+        columnInfo[maplayer].mSlopeType = 0;
     }
-    return height;
 }
 
 bool GameMapManager::TraceSegment2D(const glm::vec2& origin, const glm::vec2& destination, float height, glm::vec2& outPoint)
@@ -292,6 +600,10 @@ bool GameMapManager::TraceSegment2D(const glm::vec2& origin, const glm::vec2& de
 
     int mapcoord_z = (int) height;
 
+    // segment is too short
+    if (mapcoord_start == mapcoord_end)
+        return false;
+
     glm::vec2 direction = glm::normalize(destination - origin);
 
     // find all cells intersecting with line
@@ -337,8 +649,8 @@ bool GameMapManager::TraceSegment2D(const glm::vec2& origin, const glm::vec2& de
         sideDistY = (mapcoord_curr.y + 1.0f - posY) * deltaDistY;
     }
 
-    //perform DDA
-    const int MaxSteps = 16;
+    //perform DDA, each step crosses exactly one cell boundary
+    const int MaxSteps = std::abs(mapcoord_end.x - mapcoord_start.x) + std::abs(mapcoord_end.y - mapcoord_start.y);
     for (int istep = 0; ; ++istep)
     {
         if (istep == MaxSteps)
@@ -376,3 +688,240 @@ bool GameMapManager::TraceSegment2D(const glm::vec2& origin, const glm::vec2& de
 
     return false;
 }
+
+bool GameMapManager::TraceSegment(const glm::vec3& origin, const glm::vec3& destination, glm::vec3& outPoint) const
+{
+    float hitFraction = 0.0f;
+    if (TraceSegmentFraction(origin, destination, hitFraction))
+    {
+        outPoint = origin + (destination - origin) * hitFraction;
+        return true;
+    }
+    return false;
+}
+
+int GameMapManager::TraceLinesOfSight(const glm::vec3* origins, const glm::vec3* destinations, int numSegments, bool* outputVisible) const
+{
+    debug_assert(numSegments == 0 || (origins && destinations && outputVisible));
+
+    int numVisible = 0;
+    for (int isegment = 0; isegment < numSegments; ++isegment)
+    {
+        float hitFraction = 0.0f;
+        outputVisible[isegment] = !TraceSegmentFraction(origins[isegment], destinations[isegment], hitFraction);
+        if (outputVisible[isegment])
+        {
+            ++numVisible;
+        }
+    }
+    return numVisible;
+}
+
+bool GameMapManager::TraceSegmentFraction(const glm::vec3& origin, const glm::vec3& destination, float& outHitFraction) const
+{
+    const glm::vec3 delta = destination - origin;
+
+    // map coords x, y are x and z, layer is y
+    glm::ivec3 mapcoord_curr ((int) floorf(origin.x), (int) floorf(origin.y), (int) floorf(origin.z));
+    glm::ivec3 mapcoord_end ((int) floorf(destination.x), (int) floorf(destination.y), (int) floorf(destination.z));
+
+    // setup traversal, all distances are measured in fractions of segment length
+    glm::ivec3 step;
+    glm::vec3 fractionMax; // fraction at which next cell boundary is crossed on each axis
+    glm::vec3 fractionDelta; // fraction between two cell boundaries on each axis
+    for (int iaxis = 0; iaxis < 3; ++iaxis)
+    {
+        if (delta[iaxis] > 0.0f)
+        {
+            step[iaxis] = 1;
+            fractionDelta[iaxis] = 1.0f / delta[iaxis];
+            fractionMax[iaxis] = (mapcoord_curr[iaxis] + 1.0f - origin[iaxis]) * fractionDelta[iaxis];
+        }
+        else if (delta[iaxis] < 0.0f)
+        {
+            step[iaxis] = -1;
+            fractionDelta[iaxis] = -1.0f / delta[iaxis];
+            fractionMax[iaxis] = (origin[iaxis] - mapcoord_curr[iaxis]) * fractionDelta[iaxis];
+        }
+        else // segment is parallel to axis, boundaries never crossed
+        {
+            step[iaxis] = 0;
+            fractionDelta[iaxis] = 2.0f;
+            fractionMax[iaxis] = 2.0f;
+        }
+    }
+
+    const int numCells = std::abs(mapcoord_end.x - mapcoord_curr.x) + 
+        std::abs(mapcoord_end.y - mapcoord_curr.y) + 
+        std::abs(mapcoord_end.z - mapcoord_curr.z) + 1;
+
+    float fractionEnter = 0.0f;
+    bool enteredAlongY = false;
+    for (int icell = 0; icell < numCells; ++icell)
+    {
+        float fractionExit = glm::min(glm::min(fractionMax.x, fractionMax.y), glm::min(fractionMax.z, 1.0f));
+
+        bool insideMap = (mapcoord_curr.x > -1 && mapcoord_curr.x < MAP_DIMENSIONS) &&
+            (mapcoord_curr.z > -1 && mapcoord_curr.z < MAP_DIMENSIONS);
+
+        // flat ground blocks are solid at bottom plane
+        if (insideMap && enteredAlongY)
+        {
+            int lidLayer = (step.y > 0) ? mapcoord_curr.y : mapcoord_curr.y + 1;
+            if (lidLayer > -1 && lidLayer < MAP_LAYERS_COUNT)
+            {
+                const BlockStyle& lidBlock = GetBlockData(mapcoord_curr.x, mapcoord_curr.z, lidLayer);
+                if (lidBlock.mSlopeType == 0 && lidBlock.mGroundType != eGroundType_Air && lidBlock.mGroundType != eGroundType_Water)
+                {
+                    outHitFraction = fractionEnter;
+                    return true;
+                }
+            }
+        }
+
+        if (insideMap && mapcoord_curr.y > -1 && mapcoord_curr.y < MAP_LAYERS_COUNT)
+        {
+            const BlockStyle& blockData = GetBlockData(mapcoord_curr.x, mapcoord_curr.z, mapcoord_curr.y);
+            if (blockData.mSlopeType)
+            {
+                // segment height above slope surface changes linearly within block
+                const SlopeLerpParams& slopeParams = mSlopeLerpParams[blockData.mSlopeType];
+
+                float slopeBase = mapcoord_curr.y + slopeParams.mHeightMin;
+                float slopeOriginT = slopeParams.mAlongXMask ? (origin.x - mapcoord_curr.x) : (origin.z - mapcoord_curr.z);
+                float slopeDeltaT = slopeParams.mAlongXMask ? delta.x : delta.z;
+
+                float heightEnter = origin.y + delta.y * fractionEnter - (slopeBase + slopeParams.mHeightDelta * (slopeOriginT + slopeDeltaT * fractionEnter));
+                float heightExit = origin.y + delta.y * fractionExit - (slopeBase + slopeParams.mHeightDelta * (slopeOriginT + slopeDeltaT * fractionExit));
+                if (heightEnter <= 0.0f)
+                {
+                    outHitFraction = fractionEnter;
+                    return true;
+                }
+                if (heightExit < 0.0f)
+                {
+                    outHitFraction = fractionEnter + (fractionExit - fractionEnter) * (heightEnter / (heightEnter - heightExit));
+                    return true;
+                }
+            }
+            else if (blockData.mGroundType == eGroundType_Building)
+            {
+                outHitFraction = fractionEnter;
+                return true;
+            }
+        }
+
+        if (fractionExit >= 1.0f)
+            break;
+
+        // step to next cell
+        int iaxis = 0;
+        if (fractionMax.y < fractionMax[iaxis]) iaxis = 1;
+        if (fractionMax.z < fractionMax[iaxis]) iaxis = 2;
+
+        mapcoord_curr[iaxis] += step[iaxis];
+        fractionEnter = fractionMax[iaxis];
+        fractionMax[iaxis] += fractionDelta[iaxis];
+        enteredAlongY = (iaxis == 1);
+    }
+    return false;
+}
+
+void GameMapManager::GetMapCachePath(const char* filename, std::string& outputPath) const
+{
+    outputPath = gFiles.mWorkingDirectoryPath + "/" + MapCacheDirectory + "/" + cxx::lower_string(cxx::get_file_name(filename)) + ".cache";
+}
+
+bool GameMapManager::LoadMapCache(const char* filename, std::ifstream& sourceFile, unsigned long long sourceLength, long long sourceWriteTime)
+{
+    std::string cachePath;
+    GetMapCachePath(filename, cachePath);
+
+    if (!cxx::is_file_exists(cachePath) || !mMapCacheFile.map_file(cachePath))
+        return false;
+
+    // map data is validated by header only, its pages are loaded lazily on first access
+    bool isValidCache = false;
+    for (;;)
+    {
+        if (mMapCacheFile.get_data_length() != sizeof(MapCacheFileHeader) + sizeof(MapData) + sizeof(mHeightIndex))
+            break;
+
+        const MapCacheFileHeader* header = reinterpret_cast<const MapCacheFileHeader*>(mMapCacheFile.get_data());
+        if (header->mMagic != MAP_CACHE_FILE_MAGIC || header->mVersion != MAP_CACHE_FILE_VERSION ||
+            header->mSizeofBlockStyle != Sizeof_BlockStyle || header->mDataLength != sizeof(MapData) ||
+            header->mHeightIndexLength != sizeof(mHeightIndex))
+        {
+            break;
+        }
+
+        if (header->mSourceLength != sourceLength) // source was changed
+            break;
+
+        // source could be touched or copied without changes, whole file is hashed only in that case
+        if (header->mSourceWriteTime != sourceWriteTime)
+        {
+            unsigned long long sourceChecksum = 0;
+            if (!compute_stream_checksum(sourceFile, sourceChecksum) || header->mSourceChecksum != sourceChecksum)
+                break;
+        }
+
+        isValidCache = true;
+        break;
+    }
+
+    if (!isValidCache)
+    {
+        mMapCacheFile.unmap_file();
+        return false;
+    }
+
+    // use mapped data in place, own storage is not needed until next cleanup
+    mMapData = reinterpret_cast<MapData*>(mMapCacheFile.get_data() + sizeof(MapCacheFileHeader));
+    mMapDataStorage.reset();
+
+    // height index is stored along with map data, building it would touch every map block
+    memcpy(mHeightIndex, mMapCacheFile.get_data() + sizeof(MapCacheFileHeader) + sizeof(MapData), sizeof(mHeightIndex));
+    return true;
+}
+
+bool GameMapManager::SaveMapCache(const char* filename, std::ifstream& sourceFile, unsigned long long sourceLength, long long sourceWriteTime) const
+{
+    std::string cachePath;
+    GetMapCachePath(filename, cachePath);
+
+    std::string cacheDirectory = cxx::get_parent_directory(cachePath);
+    if (!cxx::is_directory_exists(cacheDirectory) && !cxx::ensure_path_exists(cacheDirectory))
+        return false;
+
+    MapCacheFileHeader header;
+    header.mMagic = MAP_CACHE_FILE_MAGIC;
+    header.mVersion = MAP_CACHE_FILE_VERSION;
+    header.mSizeofBlockStyle = Sizeof_BlockStyle;
+    header.mDataLength = sizeof(MapData);
+    header.mHeightIndexLength = sizeof(mHeightIndex);
+    header.mReserved = 0;
+    header.mSourceLength = sourceLength;
+    header.mSourceWriteTime = sourceWriteTime;
+    if (!compute_stream_checksum(sourceFile, header.mSourceChecksum))
+        return false;
+
+    // write to temporary file first so partially written cache never gets mapped
+    std::string tempPath = cachePath + ".tmp";
+    {
+        std::ofstream file (tempPath, std::ios::out | std::ios::binary | std::ios::trunc);
+        if (!file.is_open())
+            return false;
+
+        if (!file.write(reinterpret_cast<const char*>(&header), sizeof(header)) ||
+            !file.write(reinterpret_cast<const char*>(mMapData), sizeof(MapData)) ||
+            !file.write(reinterpret_cast<const char*>(mHeightIndex), sizeof(mHeightIndex)))
+        {
+            file.close();
+            ::remove(tempPath.c_str());
+            return false;
+        }
+    }
+    ::remove(cachePath.c_str());
+    return ::rename(tempPath.c_str(), cachePath.c_str()) == 0;
+}
\ No newline at end of file
@@ -3,6 +3,30 @@
 #include "GameDefs.h"
 #include "StyleData.h"
 
+// square area of map columns including all layers
+struct MapChunk
+{
+public:
+    BlockStyle mBlocks[MAP_LAYERS_COUNT][MAP_CHUNK_DIMENSIONS][MAP_CHUNK_DIMENSIONS]; // z, y, x within chunk
+};
+
+// decoded city scape data
+// warning - layout is shared with binary map cache files, bump cache version on changes
+struct MapData
+{
+public:
+    int mBaseTilesData[MAP_DIMENSIONS][MAP_DIMENSIONS]; // y x
+    MapChunk mChunks[MAP_CHUNKS_COUNT][MAP_CHUNKS_COUNT]; // y, x
+};
+
+// precomputed ground location for map column, see GameMapManager::GetHeightAtPosition
+struct MapGroundInfo
+{
+public:
+    unsigned char mLayer; // first solid or slope layer found when walking down from start layer
+    unsigned char mSlopeType; // slope type of that block, 0 = none
+};
+
 // this class manages GTA map and style data which get loaded from CMP/G24-files
 class GameMapManager final: public cxx::noncopyable
 {
@@ -11,6 +35,8 @@ public:
     StyleData mStyleData;
 
 public:
+    GameMapManager();
+
     // load map data from specific file, returns false on error
     // @param filename: Target file name
     bool LoadFromFile(const char* filename);
@@ -27,10 +53,44 @@ public:
     BlockStyle* GetBlock(int coordx, int coordy, int layer) const;
     BlockStyle* GetBlockClamp(int coordx, int coordy, int layer) const;
 
+    // modify map block at specific location, bumps version of chunk which contains that block
+    // note that location coords should never exceed MAP_DIMENSIONS for x,y and MAP_LAYERS_COUNT for layer
+    // @param coordx, coordy, layer: Block location
+    // @param blockData: New block data
+    void SetBlock(int coordx, int coordy, int layer, const BlockStyle& blockData);
+
+    // clear map block at specific location, block becomes air
+    // @param coordx, coordy, layer: Block location
+    void ClearBlock(int coordx, int coordy, int layer);
+
+    // change lid or slope of map block at specific location
+    // @param coordx, coordy, layer: Block location
+    // @param lidFace: Graphic square index, 0 for no lid
+    // @param slopeType: Slope index, see BlockStyle::mSlopeType
+    void SetBlockLid(int coordx, int coordy, int layer, int lidFace);
+    void SetBlockSlope(int coordx, int coordy, int layer, int slopeType);
+
+    // get modification counter of map chunk, it changes each time blocks within chunk or its border gets modified
+    // @param chunkx, chunky: Chunk location, should never exceed MAP_CHUNKS_COUNT
+    unsigned int GetChunkVersion(int chunkx, int chunky) const;
+
+    // get modification counter of whole map, it changes each time any chunk gets modified
+    unsigned int GetMapVersion() const;
+
     // get real height at specified map point
     // @param position: Current position on map
     float GetHeightAtPosition(const glm::vec3& position) const;
 
+    // get real heights for multiple map points at once, produces same results as GetHeightAtPosition
+    // @param positions: Points on map
+    // @param numPositions: Number of points
+    // @param outputHeights: Output heights, must have room for numPositions elements
+    void GetHeightAtPositions(const glm::vec3* positions, int numPositions, float* outputHeights) const;
+
+    // refresh precomputed ground info for map column, should be called each time column blocks are modified
+    // @param coordx, coordy: Column location
+    void UpdateHeightIndex(int coordx, int coordy);
+
     // get intersection with solid blocks on specific map layer, ignores slopes
     // @param origin: Start position
     // @param destination: End position
@@ -39,15 +99,75 @@ public:
     // @returns true if intersection detected or false otherwise
     bool TraceSegment2D(const glm::vec2& origin, const glm::vec2& destination, float height, glm::vec2& outPoint);
 
+    // get first intersection with solid blocks along segment, slopes are taken into account
+    // @param origin: Start position
+    // @param destination: End position
+    // @param outPoint: Intersection point
+    // @returns true if intersection detected or false otherwise
+    bool TraceSegment(const glm::vec3& origin, const glm::vec3& destination, glm::vec3& outPoint) const;
+
+    // test visibility between multiple pairs of points
+    // @param origins: Start positions
+    // @param destinations: End positions
+    // @param numSegments: Number of segments
+    // @param outputVisible: Output visibility flags, must have room for numSegments elements
+    // @returns number of unobstructed segments
+    int TraceLinesOfSight(const glm::vec3* origins, const glm::vec3* destinations, int numSegments, bool* outputVisible) const;
+
 private:
     // Reading map data internals
     // @param file: Source stream
     bool ReadCompressedMapData(std::ifstream& file, int columnLength, int blockLength);
     void FixShiftedBits();
+    void BuildHeightIndex();
+
+    // get map block without bounds checking
+    // @param coordx, coordy, layer: Block location
+    inline BlockStyle& GetBlockData(int coordx, int coordy, int layer) const
+    {
+        return mMapData->mChunks[coordy / MAP_CHUNK_DIMENSIONS][coordx / MAP_CHUNK_DIMENSIONS].mBlocks[layer]
+            [coordy % MAP_CHUNK_DIMENSIONS][coordx % MAP_CHUNK_DIMENSIONS];
+    }
+
+    // invalidate all chunks data
+    void BumpAllChunksVersions();
+
+    // get height of ground block at specified map location, slopes are not applied
+    // @param coordx, coordy, layer: Map location
+    // @param slopeType: Output slope type of ground block
+    float GetGroundHeight(int coordx, int coordy, int layer, int& slopeType) const;
+
+    // walk through map blocks along segment using 3d dda
+    // @param origin, destination: Segment
+    // @param outHitFraction: Intersection point position along segment in range [0, 1]
+    // @returns true if intersection detected or false otherwise
+    bool TraceSegmentFraction(const glm::vec3& origin, const glm::vec3& destination, float& outHitFraction) const;
+
+    // Binary map cache internals, cache stores fully decoded map data and height index, map data gets mapped into memory
+    // @param filename: Source map file name
+    // @param sourceFile: Source map file stream, it is hashed only when cache is saved or source write time differs
+    // @param sourceLength, sourceWriteTime: Source map file signature
+    bool LoadMapCache(const char* filename, std::ifstream& sourceFile, unsigned long long sourceLength, long long sourceWriteTime);
+    bool SaveMapCache(const char* filename, std::ifstream& sourceFile, unsigned long long sourceLength, long long sourceWriteTime) const;
+    void GetMapCachePath(const char* filename, std::string& outputPath) const;
 
 private:
-    BlockStyle mMapTiles[MAP_LAYERS_COUNT][MAP_DIMENSIONS][MAP_DIMENSIONS]; // z, y, x
-    int mBaseTilesData[MAP_DIMENSIONS][MAP_DIMENSIONS]; // y x
+    MapData* mMapData; // points to either own data storage or mapped cache data
+    std::unique_ptr<MapData> mMapDataStorage; // released while mapped cache data is in use
+    MapGroundInfo mHeightIndex[MAP_DIMENSIONS][MAP_DIMENSIONS][MAP_LAYERS_COUNT]; // y, x, start layer
+    unsigned int mChunksVersions[MAP_CHUNKS_COUNT][MAP_CHUNKS_COUNT]; // y, x
+    unsigned int mMapVersion;
+
+    // slope interpolation params indexed by slope type, used by batched height queries
+    struct SlopeLerpParams
+    {
+    public:
+        float mHeightMin;
+        float mHeightDelta;
+        unsigned int mAlongXMask; // all bits set if slope goes along x axis
+    };
+    SlopeLerpParams mSlopeLerpParams[64];
+    cxx::mapped_file mMapCacheFile;
 };
 
 extern GameMapManager gGameMap;
\ No newline at end of file
@@ -17,4 +17,7 @@ public:
     const GameObjectID_t mObjectID; // its unique for all game objects
 
     bool mMarkForDeletion = false; // destroy object at next frame
+
+    eSimulationLOD mSimulationLOD = eSimulationLOD_Full;
+    Timespan mSimulationDeltaTime; // time accumulated since last update on reduced simulation rate
 };
\ No newline at end of file
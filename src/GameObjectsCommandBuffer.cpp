@@ -0,0 +1,159 @@
+#include "stdafx.h"
+#include "GameObjectsCommandBuffer.h"
+#include "PhysicsComponents.h"
+#include "CarnageGame.h"
+
+static thread_local GameObjectsCommandBuffer* CurrentCommandBuffer = nullptr;
+
+void GameObjectsCommandBuffer::SetLinearVelocity(PhysicsComponent* physicsComponent, const glm::vec2& velocity)
+{
+    PushPhysicsCommand(eGameObjectCommand_SetLinearVelocity, physicsComponent, glm::vec3(velocity.x, velocity.y, 0.0f), 0.0f);
+}
+
+void GameObjectsCommandBuffer::SetAngularVelocity(PhysicsComponent* physicsComponent, float angularVelocity)
+{
+    PushPhysicsCommand(eGameObjectCommand_SetAngularVelocity, physicsComponent, glm::vec3(0.0f), angularVelocity);
+}
+
+void GameObjectsCommandBuffer::SetPosition(PhysicsComponent* physicsComponent, const glm::vec3& position)
+{
+    PushPhysicsCommand(eGameObjectCommand_SetPosition, physicsComponent, position, 0.0f);
+}
+
+void GameObjectsCommandBuffer::SetPosition(PhysicsComponent* physicsComponent, const glm::vec3& position, cxx::angle_t rotationAngle)
+{
+    PushPhysicsCommand(eGameObjectCommand_SetPositionAndRotation, physicsComponent, position, rotationAngle.mDegrees);
+}
+
+void GameObjectsCommandBuffer::SetRotationAngle(PhysicsComponent* physicsComponent, cxx::angle_t rotationAngle)
+{
+    PushPhysicsCommand(eGameObjectCommand_SetRotationAngle, physicsComponent, glm::vec3(0.0f), rotationAngle.mDegrees);
+}
+
+void GameObjectsCommandBuffer::AddForce(PhysicsComponent* physicsComponent, const glm::vec2& force)
+{
+    PushPhysicsCommand(eGameObjectCommand_AddForce, physicsComponent, glm::vec3(force.x, force.y, 0.0f), 0.0f);
+}
+
+void GameObjectsCommandBuffer::AddLinearImpulse(PhysicsComponent* physicsComponent, const glm::vec2& impulse)
+{
+    PushPhysicsCommand(eGameObjectCommand_AddLinearImpulse, physicsComponent, glm::vec3(impulse.x, impulse.y, 0.0f), 0.0f);
+}
+
+void GameObjectsCommandBuffer::AddAngularImpulse(PhysicsComponent* physicsComponent, float impulse)
+{
+    PushPhysicsCommand(eGameObjectCommand_AddAngularImpulse, physicsComponent, glm::vec3(0.0f), impulse);
+}
+
+void GameObjectsCommandBuffer::ClearForces(PhysicsComponent* physicsComponent)
+{
+    PushPhysicsCommand(eGameObjectCommand_ClearForces, physicsComponent, glm::vec3(0.0f), 0.0f);
+}
+
+void GameObjectsCommandBuffer::PushPhysicsCommand(eGameObjectCommand commandType, PhysicsComponent* physicsComponent, const glm::vec3& vector, float scalar)
+{
+    debug_assert(physicsComponent);
+
+    GameObjectCommand command;
+    command.mCommandType = commandType;
+    command.mPhysicsComponent = physicsComponent;
+    command.mPedestrian = nullptr;
+    command.mVector = vector;
+    command.mScalar = scalar;
+    mCommands.push_back(command);
+}
+
+void GameObjectsCommandBuffer::CreatePedestrian(const glm::vec3& position)
+{
+    GameObjectCommand command;
+    command.mCommandType = eGameObjectCommand_CreatePedestrian;
+    command.mPhysicsComponent = nullptr;
+    command.mPedestrian = nullptr;
+    command.mVector = position;
+    command.mScalar = 0.0f;
+    mCommands.push_back(command);
+}
+
+void GameObjectsCommandBuffer::DestroyPedestrian(Pedestrian* pedestrian)
+{
+    debug_assert(pedestrian);
+
+    GameObjectCommand command;
+    command.mCommandType = eGameObjectCommand_DestroyPedestrian;
+    command.mPhysicsComponent = nullptr;
+    command.mPedestrian = pedestrian;
+    command.mVector = glm::vec3(0.0f);
+    command.mScalar = 0.0f;
+    mCommands.push_back(command);
+}
+
+void GameObjectsCommandBuffer::Execute()
+{
+    // commands must be applied directly
+    debug_assert(CurrentCommandBuffer == nullptr);
+
+    for (const GameObjectCommand& currCommand: mCommands)
+    {
+        switch (currCommand.mCommandType)
+        {
+            case eGameObjectCommand_SetLinearVelocity:
+                currCommand.mPhysicsComponent->SetLinearVelocity(glm::vec2(currCommand.mVector.x, currCommand.mVector.y));
+            break;
+
+            case eGameObjectCommand_SetAngularVelocity:
+                currCommand.mPhysicsComponent->SetAngularVelocity(currCommand.mScalar);
+            break;
+
+            case eGameObjectCommand_SetPosition:
+                currCommand.mPhysicsComponent->SetPosition(currCommand.mVector);
+            break;
+
+            case eGameObjectCommand_SetPositionAndRotation:
+                currCommand.mPhysicsComponent->SetPosition(currCommand.mVector, cxx::angle_t::from_degrees(currCommand.mScalar));
+            break;
+
+            case eGameObjectCommand_SetRotationAngle:
+                currCommand.mPhysicsComponent->SetRotationAngle(cxx::angle_t::from_degrees(currCommand.mScalar));
+            break;
+
+            case eGameObjectCommand_AddForce:
+                currCommand.mPhysicsComponent->AddForce(glm::vec2(currCommand.mVector.x, currCommand.mVector.y));
+            break;
+
+            case eGameObjectCommand_AddLinearImpulse:
+                currCommand.mPhysicsComponent->AddLinearImpulse(glm::vec2(currCommand.mVector.x, currCommand.mVector.y));
+            break;
+
+            case eGameObjectCommand_AddAngularImpulse:
+                currCommand.mPhysicsComponent->AddAngularImpulse(currCommand.mScalar);
+            break;
+
+            case eGameObjectCommand_ClearForces:
+                currCommand.mPhysicsComponent->ClearForces();
+            break;
+
+            case eGameObjectCommand_CreatePedestrian:
+            {
+                Pedestrian* pedestrian = gCarnageGame.mObjectsManager.CreatePedestrian(currCommand.mVector);
+                debug_assert(pedestrian);
+            }
+            break;
+
+            case eGameObjectCommand_DestroyPedestrian:
+                // pedestrian gets removed from active list on next update
+                currCommand.mPedestrian->mMarkForDeletion = true;
+            break;
+        }
+    }
+    mCommands.clear();
+}
+
+GameObjectsCommandBuffer* GameObjectsCommandBuffer::GetCurrent()
+{
+    return CurrentCommandBuffer;
+}
+
+void GameObjectsCommandBuffer::SetCurrent(GameObjectsCommandBuffer* commandBuffer)
+{
+    CurrentCommandBuffer = commandBuffer;
+}
\ No newline at end of file
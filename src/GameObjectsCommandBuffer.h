@@ -0,0 +1,84 @@
+#pragma once
+
+#include "GameDefs.h"
+#include "PhysicsDefs.h"
+
+// deferred game objects command type
+enum eGameObjectCommand
+{
+    eGameObjectCommand_SetLinearVelocity,
+    eGameObjectCommand_SetAngularVelocity,
+    eGameObjectCommand_SetPosition,
+    eGameObjectCommand_SetPositionAndRotation,
+    eGameObjectCommand_SetRotationAngle,
+    eGameObjectCommand_AddForce,
+    eGameObjectCommand_AddLinearImpulse,
+    eGameObjectCommand_AddAngularImpulse,
+    eGameObjectCommand_ClearForces,
+    eGameObjectCommand_CreatePedestrian,
+    eGameObjectCommand_DestroyPedestrian,
+};
+
+// deferred game objects command
+struct GameObjectCommand
+{
+public:
+    eGameObjectCommand mCommandType;
+    PhysicsComponent* mPhysicsComponent;
+    Pedestrian* mPedestrian;
+    glm::vec3 mVector;
+    float mScalar;
+};
+
+// defines list of structural changes and physics commands recorded during parallel game objects update,
+// commands are applied later at sync point on single thread
+class GameObjectsCommandBuffer final
+{
+public:
+    // record physics commands
+    // @param physicsComponent: Target physics body
+    // @param velocity: Linear velocity in blocks per second or angular velocity in degrees per second
+    void SetLinearVelocity(PhysicsComponent* physicsComponent, const glm::vec2& velocity);
+    void SetAngularVelocity(PhysicsComponent* physicsComponent, float angularVelocity);
+
+    // record physics transform commands
+    // @param physicsComponent: Target physics body
+    // @param position: World position
+    // @param rotationAngle: Heading angle
+    void SetPosition(PhysicsComponent* physicsComponent, const glm::vec3& position);
+    void SetPosition(PhysicsComponent* physicsComponent, const glm::vec3& position, cxx::angle_t rotationAngle);
+    void SetRotationAngle(PhysicsComponent* physicsComponent, cxx::angle_t rotationAngle);
+
+    // record physics forces commands
+    // @param physicsComponent: Target physics body
+    // @param force: World force vector
+    // @param impulse: World impulse vector or angular impulse
+    void AddForce(PhysicsComponent* physicsComponent, const glm::vec2& force);
+    void AddLinearImpulse(PhysicsComponent* physicsComponent, const glm::vec2& impulse);
+    void AddAngularImpulse(PhysicsComponent* physicsComponent, float impulse);
+    void ClearForces(PhysicsComponent* physicsComponent);
+
+    // record spawn of new pedestrian
+    // @param position: World position
+    void CreatePedestrian(const glm::vec3& position);
+
+    // record pedestrian deletion
+    // @param pedestrian: Pedestrian to delete
+    void DestroyPedestrian(Pedestrian* pedestrian);
+
+    // apply all recorded commands in order they were recorded and clear buffer
+    void Execute();
+
+    inline bool IsEmpty() const { return mCommands.empty(); }
+
+    // command buffer bound to current thread, physics components and objects manager record commands into it
+    // instead of applying them immediately
+    static GameObjectsCommandBuffer* GetCurrent();
+    static void SetCurrent(GameObjectsCommandBuffer* commandBuffer);
+
+private:
+    void PushPhysicsCommand(eGameObjectCommand commandType, PhysicsComponent* physicsComponent, const glm::vec3& vector, float scalar);
+
+private:
+    std::vector<GameObjectCommand> mCommands;
+};
\ No newline at end of file
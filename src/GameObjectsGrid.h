@@ -0,0 +1,223 @@
+#pragma once
+
+#include "GameDefs.h"
+
+// grid membership data, should be embedded into game object as mGridNode
+template<typename TObject>
+class GameObjectsGridNode final
+{
+public:
+    GameObjectsGridNode(TObject* object)
+        : mListNode(object)
+        , mPosition()
+        , mCellIndex(-1)
+    {
+    }
+
+public:
+    cxx::intrusive_node<TObject> mListNode;
+    glm::vec2 mPosition; // world x and z at last grid update
+    int mCellIndex; // -1 if not in grid
+};
+
+// defines uniform grid of game objects aligned to map blocks, used for fast proximity queries
+// objects outside of map bounds are kept in border cells
+template<typename TObject>
+class GameObjectsGrid final: public cxx::noncopyable
+{
+public:
+    // add object to grid or update its location
+    // @param object: Game object
+    // @param position: World position, y coord is ignored
+    inline void UpdateObject(TObject* object, const glm::vec3& position)
+    {
+        debug_assert(object);
+
+        GameObjectsGridNode<TObject>& gridNode = object->mGridNode;
+        gridNode.mPosition.x = position.x;
+        gridNode.mPosition.y = position.z;
+
+        int cellIndex = GetCellIndex(GetCellCoord(position.x), GetCellCoord(position.z));
+        if (gridNode.mCellIndex == cellIndex)
+            return;
+
+        if (gridNode.mCellIndex != -1)
+        {
+            mCells[gridNode.mCellIndex].remove(&gridNode.mListNode);
+        }
+        mCells[cellIndex].insert(&gridNode.mListNode);
+        gridNode.mCellIndex = cellIndex;
+    }
+
+    // remove object from grid
+    // @param object: Game object
+    inline void RemoveObject(TObject* object)
+    {
+        debug_assert(object);
+
+        GameObjectsGridNode<TObject>& gridNode = object->mGridNode;
+        if (gridNode.mCellIndex == -1)
+            return;
+
+        mCells[gridNode.mCellIndex].remove(&gridNode.mListNode);
+        gridNode.mCellIndex = -1;
+    }
+
+    // find objects within circle, results are appended to output list
+    // @param center: World x and z
+    // @param radius: Circle radius
+    // @param outputObjects: Output list
+    // @returns number of objects found
+    int QueryRadius(const glm::vec2& center, float radius, std::vector<TObject*>& outputObjects) const
+    {
+        const float radius2 = radius * radius;
+        const int cellMinX = GetCellCoord(center.x - radius);
+        const int cellMinY = GetCellCoord(center.y - radius);
+        const int cellMaxX = GetCellCoord(center.x + radius);
+        const int cellMaxY = GetCellCoord(center.y + radius);
+
+        int numObjects = 0;
+        for (int celly = cellMinY; celly <= cellMaxY; ++celly)
+        for (int cellx = cellMinX; cellx <= cellMaxX; ++cellx)
+        {
+            for (TObject* currObject: mCells[GetCellIndex(cellx, celly)])
+            {
+                if (glm::length2(currObject->mGridNode.mPosition - center) > radius2)
+                    continue;
+
+                outputObjects.push_back(currObject);
+                ++numObjects;
+            }
+        }
+        return numObjects;
+    }
+
+    // find objects within axis aligned box, results are appended to output list
+    // @param minPoint, maxPoint: World x and z of box corners
+    // @param outputObjects: Output list
+    // @returns number of objects found
+    int QueryAABB(const glm::vec2& minPoint, const glm::vec2& maxPoint, std::vector<TObject*>& outputObjects) const
+    {
+        const int cellMinX = GetCellCoord(minPoint.x);
+        const int cellMinY = GetCellCoord(minPoint.y);
+        const int cellMaxX = GetCellCoord(maxPoint.x);
+        const int cellMaxY = GetCellCoord(maxPoint.y);
+
+        int numObjects = 0;
+        for (int celly = cellMinY; celly <= cellMaxY; ++celly)
+        for (int cellx = cellMinX; cellx <= cellMaxX; ++cellx)
+        {
+            for (TObject* currObject: mCells[GetCellIndex(cellx, celly)])
+            {
+                const glm::vec2& position = currObject->mGridNode.mPosition;
+                if (position.x < minPoint.x || position.y < minPoint.y ||
+                    position.x > maxPoint.x || position.y > maxPoint.y)
+                {
+                    continue;
+                }
+                outputObjects.push_back(currObject);
+                ++numObjects;
+            }
+        }
+        return numObjects;
+    }
+
+    // find closest objects, results are sorted by distance and appended to output list
+    // @param center: World x and z
+    // @param maxCount: Max number of objects to find
+    // @param maxRadius: Max search distance
+    // @param outputObjects: Output list
+    // @returns number of objects found
+    int QueryNearest(const glm::vec2& center, int maxCount, float maxRadius, std::vector<TObject*>& outputObjects) const
+    {
+        if (maxCount < 1)
+            return 0;
+
+        std::vector<std::pair<float, TObject*>> candidates;
+
+        const float maxRadius2 = maxRadius * maxRadius;
+        const int centerCellX = GetCellCoord(center.x);
+        const int centerCellY = GetCellCoord(center.y);
+        const int maxRing = (int) (maxRadius / MAP_BLOCK_LENGTH) + 1;
+
+        // walk square rings of cells around center cell
+        for (int iring = 0; iring <= maxRing && iring < MAP_DIMENSIONS; ++iring)
+        {
+            for (int celly = centerCellY - iring; celly <= centerCellY + iring; ++celly)
+            {
+                if (celly < 0 || celly >= MAP_DIMENSIONS)
+                    continue;
+
+                // inner rows contain only two cells of ring
+                const int stepx = (celly == centerCellY - iring || celly == centerCellY + iring) ? 1 : (iring * 2);
+                for (int cellx = centerCellX - iring; cellx <= centerCellX + iring; cellx += stepx)
+                {
+                    if (cellx < 0 || cellx >= MAP_DIMENSIONS)
+                        continue;
+
+                    for (TObject* currObject: mCells[GetCellIndex(cellx, celly)])
+                    {
+                        float distance2 = glm::length2(currObject->mGridNode.mPosition - center);
+                        if (distance2 > maxRadius2)
+                            continue;
+
+                        candidates.emplace_back(distance2, currObject);
+                    }
+                }
+            }
+
+            // objects in next rings are at least that far from center
+            if ((int) candidates.size() >= maxCount)
+            {
+                std::nth_element(candidates.begin(), candidates.begin() + (maxCount - 1), candidates.end(),
+                    [](const std::pair<float, TObject*>& lhs, const std::pair<float, TObject*>& rhs)
+                    {
+                        return lhs.first < rhs.first;
+                    });
+
+                const float ringDistance = iring * MAP_BLOCK_LENGTH;
+                if (candidates[maxCount - 1].first <= ringDistance * ringDistance)
+                    break;
+
+                candidates.resize(maxCount); // farther candidates are not needed anymore
+            }
+        }
+
+        const int numObjects = glm::min(maxCount, (int) candidates.size());
+        std::partial_sort(candidates.begin(), candidates.begin() + numObjects, candidates.end(),
+            [](const std::pair<float, TObject*>& lhs, const std::pair<float, TObject*>& rhs)
+            {
+                return lhs.first < rhs.first;
+            });
+
+        for (int iobject = 0; iobject < numObjects; ++iobject)
+        {
+            outputObjects.push_back(candidates[iobject].second);
+        }
+        return numObjects;
+    }
+
+    // get number of objects within map block
+    // @param cellx, celly: Map block coord
+    inline int GetObjectsCount(int cellx, int celly) const
+    {
+        return mCells[GetCellIndex(cellx, celly)].size();
+    }
+
+private:
+    inline int GetCellCoord(float worldCoord) const
+    {
+        int cellCoord = (int) floorf(worldCoord / MAP_BLOCK_LENGTH);
+        return glm::clamp(cellCoord, 0, MAP_DIMENSIONS - 1);
+    }
+
+    inline int GetCellIndex(int cellx, int celly) const
+    {
+        debug_assert(cellx > -1 && cellx < MAP_DIMENSIONS);
+        debug_assert(celly > -1 && celly < MAP_DIMENSIONS);
+        return celly * MAP_DIMENSIONS + cellx;
+    }
+
+private:
+    cxx::intrusive_list<TObject> mCells[MAP_DIMENSIONS * MAP_DIMENSIONS];
+};
\ No newline at end of file
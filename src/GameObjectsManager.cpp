@@ -4,10 +4,44 @@
 #include "Pedestrian.h"
 #include "PhysicsComponents.h"
 #include "GameMapManager.h"
+#include "GameCamera.h"
+#include "CarnageGame.h"
+#include "TaskScheduler.h"
+#include "RenderSnapshot.h"
+
+#define PEDESTRIANS_UPDATE_BATCH_SIZE 64
+
+#define SIMULATION_LOD_RADIUS_HYSTERESIS 2.0f // prevents objects from switching level of detail back and forth
+
+static inline eSimulationLOD choose_simulation_lod(const glm::vec3& position, eSimulationLOD currentLOD)
+{
+    const float distance2 = glm::length2(glm::vec2(position.x - gCamera.mPosition.x, position.z - gCamera.mPosition.z));
+
+    // keep lower level of detail a bit longer when object approaches camera
+    float fullRateRadius = gGameRules.mSimulationFullRateRadius;
+    if (currentLOD != eSimulationLOD_Full)
+    {
+        fullRateRadius -= SIMULATION_LOD_RADIUS_HYSTERESIS;
+    }
+    float reducedRateRadius = gGameRules.mSimulationReducedRateRadius;
+    if (currentLOD == eSimulationLOD_Dormant)
+    {
+        reducedRateRadius -= SIMULATION_LOD_RADIUS_HYSTERESIS;
+    }
+
+    if (distance2 <= fullRateRadius * fullRateRadius)
+        return eSimulationLOD_Full;
+
+    if (distance2 <= reducedRateRadius * reducedRateRadius)
+        return eSimulationLOD_Reduced;
+
+    return eSimulationLOD_Dormant;
+}
 
 bool GameObjectsManager::Initialize()
 {
-    mIDsCounter = 0;
+    mObjectsSlots.clear();
+    mFreeObjectsSlots.clear();
 
     return true;
 }
@@ -19,20 +53,51 @@ void GameObjectsManager::Deinit()
 
     DestroyObjectsInList(mActiveCarsList);
     DestroyObjectsInList(mDeleteCarsList);
+
+    mObjectsSlots.clear();
+    mFreeObjectsSlots.clear();
 }
 
 void GameObjectsManager::UpdateFrame(Timespan deltaTime)
 {
     DestroyPendingObjects();
+
+    ++mFrameIndex;
+
+    Timespan updateDeltaTime;
+
+    // choose pedestrians to update, level of detail is processed serially since it may wake up physics bodies
+    mUpdatePedestrians.clear();
+    for (Pedestrian* currentPed: mActivePedestriansList)
+    {
+        if (currentPed->mMarkForDeletion)
+            continue;
+
+        debug_assert(!mDeletePedestriansList.contains(&currentPed->mDeletePedsNode));
+        if (ProcessSimulationLOD(currentPed, currentPed->mPhysicsComponent, deltaTime, updateDeltaTime))
+        {
+            PedestrianUpdate pedestrianUpdate;
+            pedestrianUpdate.mPedestrian = currentPed;
+            pedestrianUpdate.mDeltaTime = updateDeltaTime;
+            mUpdatePedestrians.push_back(pedestrianUpdate);
+
+            // shared controller data such as flow fields is resolved here so workers only read it
+            if (currentPed->mController)
+            {
+                currentPed->mController->PrepareFrame(currentPed);
+            }
+        }
+    }
+
+    UpdatePedestrians();
     
-    // update pedestrians
+    // sync point for pedestrians
     bool hasDeletePeds = false;
     for (Pedestrian* currentPed: mActivePedestriansList) // warning: dont add or remove peds during this loop
     {
         if (!currentPed->mMarkForDeletion)
         {
-            debug_assert(!mDeletePedestriansList.contains(&currentPed->mDeletePedsNode));
-            currentPed->UpdateFrame(deltaTime);
+            mPedestriansGrid.UpdateObject(currentPed, currentPed->mPhysicsComponent->GetPosition());
         }
 
         if (currentPed->mMarkForDeletion)
@@ -58,7 +123,11 @@ void GameObjectsManager::UpdateFrame(Timespan deltaTime)
         if (!currentCar->mMarkForDeletion)
         {
             debug_assert(!mDeleteCarsList.contains(&currentCar->mDeleteCarsNode));
-            currentCar->UpdateFrame(deltaTime);
+            if (ProcessSimulationLOD(currentCar, currentCar->mPhysicsComponent, deltaTime, updateDeltaTime))
+            {
+                currentCar->UpdateFrame(updateDeltaTime);
+            }
+            mCarsGrid.UpdateObject(currentCar, currentCar->mPhysicsComponent->GetPosition());
         }
 
         if (currentCar->mMarkForDeletion)
@@ -78,37 +147,143 @@ void GameObjectsManager::UpdateFrame(Timespan deltaTime)
     }
 }
 
+void GameObjectsManager::UpdatePedestrians()
+{
+    const int numPedestrians = (int) mUpdatePedestrians.size();
+    const int numBatches = (numPedestrians + PEDESTRIANS_UPDATE_BATCH_SIZE - 1) / PEDESTRIANS_UPDATE_BATCH_SIZE;
+    if ((int) mPedestriansCommandBuffers.size() < numBatches)
+    {
+        mPedestriansCommandBuffers.resize(numBatches);
+    }
+
+    gTaskScheduler.ParallelFor(numPedestrians, PEDESTRIANS_UPDATE_BATCH_SIZE, [this](int rangeBegin, int rangeEnd)
+        {
+            GameObjectsCommandBuffer& commandBuffer = mPedestriansCommandBuffers[rangeBegin / PEDESTRIANS_UPDATE_BATCH_SIZE];
+            GameObjectsCommandBuffer::SetCurrent(&commandBuffer);
+            for (int ipedestrian = rangeBegin; ipedestrian < rangeEnd; ++ipedestrian)
+            {
+                const PedestrianUpdate& pedestrianUpdate = mUpdatePedestrians[ipedestrian];
+                pedestrianUpdate.mPedestrian->UpdateFrame(pedestrianUpdate.mDeltaTime);
+            }
+            GameObjectsCommandBuffer::SetCurrent(nullptr);
+        });
+
+    // apply recorded commands
+    for (int ibatch = 0; ibatch < numBatches; ++ibatch)
+    {
+        mPedestriansCommandBuffers[ibatch].Execute();
+    }
+}
+
+bool GameObjectsManager::ProcessSimulationLOD(GameObject* object, PhysicsComponent* physicsComponent, Timespan deltaTime, Timespan& updateDeltaTime)
+{
+    eSimulationLOD simulationLOD = choose_simulation_lod(physicsComponent->GetPosition(), object->mSimulationLOD);
+    if (object == gCarnageGame.mPlayerPedestrian)
+    {
+        simulationLOD = eSimulationLOD_Full;
+    }
+
+    if (object->mSimulationLOD != simulationLOD)
+    {
+        if (simulationLOD == eSimulationLOD_Dormant)
+        {
+            physicsComponent->SetAwake(false);
+        }
+        else if (object->mSimulationLOD == eSimulationLOD_Dormant)
+        {
+            physicsComponent->SetAwake(true);
+        }
+        object->mSimulationLOD = simulationLOD;
+    }
+
+    // time is frozen for dormant objects
+    if (simulationLOD == eSimulationLOD_Dormant)
+    {
+        object->mSimulationDeltaTime = 0;
+        return false;
+    }
+
+    object->mSimulationDeltaTime += deltaTime;
+    if (simulationLOD == eSimulationLOD_Reduced)
+    {
+        // spread updates of different objects across frames
+        const unsigned int updateInterval = (unsigned int) glm::max(gGameRules.mSimulationReducedRateInterval, 1);
+        if ((mFrameIndex + GetGameObjectSlotIndex(object->mObjectID)) % updateInterval != 0)
+            return false;
+    }
+
+    updateDeltaTime = object->mSimulationDeltaTime;
+    object->mSimulationDeltaTime = 0;
+    return true;
+}
+
 void GameObjectsManager::DebugDraw()
 {
 }
 
+void GameObjectsManager::CaptureDrawStates(RenderSnapshot& snapshot)
+{
+    SpriteDrawState drawState;
+    for (Pedestrian* currPedestrian: mActivePedestriansList)
+    {
+        currPedestrian->CaptureDrawState(drawState);
+        snapshot.mPedestrians.push_back(drawState);
+    }
+    for (Vehicle* currCar: mActiveCarsList)
+    {
+        currCar->CaptureDrawState(drawState);
+        snapshot.mCars.push_back(drawState);
+    }
+
+    snapshot.mDestroyedObjects.insert(snapshot.mDestroyedObjects.end(), mDestroyedCarsIDs.begin(), mDestroyedCarsIDs.end());
+    mDestroyedCarsIDs.clear();
+}
+
 Pedestrian* GameObjectsManager::CreatePedestrian(const glm::vec3& position)
 {
+    // lists, pool and grid are modified only on single thread
+    if (GameObjectsCommandBuffer* commandBuffer = GameObjectsCommandBuffer::GetCurrent())
+    {
+        commandBuffer->CreatePedestrian(position);
+        return nullptr;
+    }
+
     GameObjectID_t pedestrianID = GenerateUniqueID();
 
     Pedestrian* instance = mPedestriansPool.create(pedestrianID);
     debug_assert(instance);
 
+    mObjectsSlots[GetGameObjectSlotIndex(pedestrianID)].mPedestrian = instance;
+
     AddToActiveList(instance);
 
     // init
     instance->EnterTheGame();
     instance->mPhysicsComponent->SetPosition(position);
+    mPedestriansGrid.UpdateObject(instance, position);
     return instance;
 }
 
 Pedestrian* GameObjectsManager::GetPedestrianByID(GameObjectID_t objectID) const
 {
-    for (const Pedestrian* currVehicle: mActivePedestriansList)
-    {
-        if (currVehicle->mObjectID == objectID)
-            return const_cast<Pedestrian*>(currVehicle);
-    }
-    return nullptr;
+    int slotIndex = GetGameObjectSlotIndex(objectID);
+    if (slotIndex >= (int) mObjectsSlots.size())
+        return nullptr;
+
+    const ObjectSlot& objectSlot = mObjectsSlots[slotIndex];
+    if (objectSlot.mObjectID != objectID || objectSlot.mPedestrian == nullptr)
+        return nullptr;
+
+    if (!mActivePedestriansList.contains(&objectSlot.mPedestrian->mActivePedsNode))
+        return nullptr;
+
+    return objectSlot.mPedestrian;
 }
 
 Vehicle* GameObjectsManager::CreateCar(const glm::vec3& position, int carTypeId)
 {
+    debug_assert(GameObjectsCommandBuffer::GetCurrent() == nullptr);
+
     StyleData& styleData = gGameMap.mStyleData;
 
     debug_assert(styleData.IsLoaded());
@@ -119,23 +294,32 @@ Vehicle* GameObjectsManager::CreateCar(const glm::vec3& position, int carTypeId)
     Vehicle* instance = mCarsPool.create(carID);
     debug_assert(instance);
 
+    mObjectsSlots[GetGameObjectSlotIndex(carID)].mCar = instance;
+
     AddToActiveList(instance);
 
     // init
     instance->mCarStyle = &gGameMap.mStyleData.mCars[carTypeId];
     instance->EnterTheGame();
     instance->mPhysicsComponent->SetPosition(position);
+    mCarsGrid.UpdateObject(instance, position);
     return instance;
 }
 
 Vehicle* GameObjectsManager::GetCarByID(GameObjectID_t objectID) const
 {
-    for (const Vehicle* currVehicle: mActiveCarsList)
-    {
-        if (currVehicle->mObjectID == objectID)
-            return const_cast<Vehicle*>(currVehicle);
-    }
-    return nullptr;
+    int slotIndex = GetGameObjectSlotIndex(objectID);
+    if (slotIndex >= (int) mObjectsSlots.size())
+        return nullptr;
+
+    const ObjectSlot& objectSlot = mObjectsSlots[slotIndex];
+    if (objectSlot.mObjectID != objectID || objectSlot.mCar == nullptr)
+        return nullptr;
+
+    if (!mActiveCarsList.contains(&objectSlot.mCar->mActiveCarsNode))
+        return nullptr;
+
+    return objectSlot.mCar;
 }
 
 void GameObjectsManager::DestroyGameObject(Pedestrian* object)
@@ -146,6 +330,13 @@ void GameObjectsManager::DestroyGameObject(Pedestrian* object)
         return;
     }
 
+    // lists, pool and grid are modified only on single thread
+    if (GameObjectsCommandBuffer* commandBuffer = GameObjectsCommandBuffer::GetCurrent())
+    {
+        commandBuffer->DestroyPedestrian(object);
+        return;
+    }
+
     if (mDeletePedestriansList.contains(&object->mDeletePedsNode))
     {
         mDeletePedestriansList.remove(&object->mDeletePedsNode);
@@ -155,12 +346,16 @@ void GameObjectsManager::DestroyGameObject(Pedestrian* object)
     {
         mActivePedestriansList.remove(&object->mActivePedsNode);
     }
+    mPedestriansGrid.RemoveObject(object);
 
+    ReleaseUniqueID(object->mObjectID);
     mPedestriansPool.destroy(object);
 }
 
 void GameObjectsManager::DestroyGameObject(Vehicle* object)
 {
+    debug_assert(GameObjectsCommandBuffer::GetCurrent() == nullptr);
+
     if (object == nullptr)
     {
         debug_assert(false);
@@ -176,7 +371,14 @@ void GameObjectsManager::DestroyGameObject(Vehicle* object)
     {
         mActiveCarsList.remove(&object->mActiveCarsNode);
     }
+    mCarsGrid.RemoveObject(object);
 
+    // destroyed ids are only consumed by render snapshots which are never captured in headless mode
+    if (!gSystem.mStartupParams.mHeadless)
+    {
+        mDestroyedCarsIDs.push_back(object->mObjectID);
+    }
+    ReleaseUniqueID(object->mObjectID);
     mCarsPool.destroy(object);
 }
 
@@ -188,6 +390,7 @@ void GameObjectsManager::DestroyObjectsInList(cxx::intrusive_list<Pedestrian>& o
         objectsList.remove(pedestrianNode);
 
         Pedestrian* pedestrian = pedestrianNode->get_element();
+        ReleaseUniqueID(pedestrian->mObjectID);
         mPedestriansPool.destroy(pedestrian);
     }
 }
@@ -200,6 +403,11 @@ void GameObjectsManager::DestroyObjectsInList(cxx::intrusive_list<Vehicle>& obje
         objectsList.remove(carNode);
 
         Vehicle* carInstance = carNode->get_element();
+        if (!gSystem.mStartupParams.mHeadless)
+        {
+            mDestroyedCarsIDs.push_back(carInstance->mObjectID);
+        }
+        ReleaseUniqueID(carInstance->mObjectID);
         mCarsPool.destroy(carInstance);
     }
 }
@@ -232,6 +440,7 @@ void GameObjectsManager::RemoveFromActiveList(Pedestrian* object)
     if (object && mActivePedestriansList.contains(&object->mActivePedsNode))
     {
         mActivePedestriansList.remove(&object->mActivePedsNode);
+        mPedestriansGrid.RemoveObject(object);
     }
 }
 
@@ -241,6 +450,7 @@ void GameObjectsManager::RemoveFromActiveList(Vehicle* object)
     if (object && mActiveCarsList.contains(&object->mActiveCarsNode))
     {
         mActiveCarsList.remove(&object->mActiveCarsNode);
+        mCarsGrid.RemoveObject(object);
     }
 }
 
@@ -252,10 +462,44 @@ void GameObjectsManager::DestroyPendingObjects()
 
 GameObjectID_t GameObjectsManager::GenerateUniqueID()
 {
-    GameObjectID_t newID = ++mIDsCounter;
-    if (newID == 0) // overflow
+    if (mFreeObjectsSlots.empty())
     {
-        debug_assert(false);
+        int slotIndex = (int) mObjectsSlots.size();
+        if (slotIndex > (int) GAMEOBJECT_ID_INDEX_MASK) // overflow
+        {
+            debug_assert(false);
+            return GAMEOBJECT_ID_NULL;
+        }
+
+        ObjectSlot objectSlot;
+        objectSlot.mObjectID = (1U << GAMEOBJECT_ID_INDEX_BITS) | slotIndex;
+        objectSlot.mPedestrian = nullptr;
+        objectSlot.mCar = nullptr;
+        mObjectsSlots.push_back(objectSlot);
+        return objectSlot.mObjectID;
+    }
+
+    int slotIndex = mFreeObjectsSlots.back();
+    mFreeObjectsSlots.pop_back();
+    return mObjectsSlots[slotIndex].mObjectID;
+}
+
+void GameObjectsManager::ReleaseUniqueID(GameObjectID_t objectID)
+{
+    int slotIndex = GetGameObjectSlotIndex(objectID);
+    debug_assert(slotIndex < (int) mObjectsSlots.size());
+
+    ObjectSlot& objectSlot = mObjectsSlots[slotIndex];
+    debug_assert(objectSlot.mObjectID == objectID);
+
+    // bump generation so all existing references become stale, zero generation is never used
+    GameObjectID_t generation = ((objectID >> GAMEOBJECT_ID_INDEX_BITS) + 1) & GAMEOBJECT_ID_GENERATION_MASK;
+    if (generation == 0)
+    {
+        generation = 1;
     }
-    return newID;
+    objectSlot.mObjectID = (generation << GAMEOBJECT_ID_INDEX_BITS) | slotIndex;
+    objectSlot.mPedestrian = nullptr;
+    objectSlot.mCar = nullptr;
+    mFreeObjectsSlots.push_back(slotIndex);
 }
\ No newline at end of file
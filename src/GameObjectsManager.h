@@ -2,6 +2,9 @@
 
 #include "Pedestrian.h"
 #include "Vehicle.h"
+#include "GameObjectsCommandBuffer.h"
+
+class RenderSnapshot;
 
 // define game objects manager class
 class GameObjectsManager final: public cxx::noncopyable
@@ -14,34 +17,49 @@ public:
     cxx::intrusive_list<Vehicle> mActiveCarsList;
     cxx::intrusive_list<Vehicle> mDeleteCarsList;
 
+    // active objects locations, updated each frame
+    GameObjectsGrid<Pedestrian> mPedestriansGrid;
+    GameObjectsGrid<Vehicle> mCarsGrid;
+
 public:
     bool Initialize();
     void Deinit();
     void UpdateFrame(Timespan deltaTime);
     void DebugDraw();
 
-    // add pedestrian to map at specific location
+    // copy draw states of active objects to render snapshot
+    // @param snapshot: Output snapshot
+    void CaptureDrawStates(RenderSnapshot& snapshot);
+
+    // add pedestrian to map at specific location, during parallel pedestrians update spawn is deferred
+    // until sync point and null is returned
     // @param position: Real world position
     Pedestrian* CreatePedestrian(const glm::vec3& position);
 
-    // find pedestrian object by its unique identifier
+    // find active pedestrian object by its unique identifier, returns null if object is gone
     // @param objectID: Unique identifier
     Pedestrian* GetPedestrianByID(GameObjectID_t objectID) const;
 
-    // add car instance to map at specific location
+    // add car instance to map at specific location, must not be called during parallel pedestrians update
     // @param position: Real world position
     // @param carTypeId: Index of car type in citystyle
     Vehicle* CreateCar(const glm::vec3& position, int carTypeId);
 
-    // find car object by its unique identifier
+    // find active car object by its unique identifier, returns null if object is gone
     // @param objectID: Unique identifier
     Vehicle* GetCarByID(GameObjectID_t objectID) const;
 
-    // will immediately destroy game object, make sure it is not in use at this moment
+    // will immediately destroy game object, make sure it is not in use at this moment,
+    // during parallel pedestrians update pedestrian is only marked for deletion at sync point
+    // and cars must not be destroyed
     // @param object: Object to destroy
     void DestroyGameObject(Pedestrian* object);
     void DestroyGameObject(Vehicle* object);
 
+    // get objects pools stats
+    inline int GetPedestriansPoolAllocatedCount() const { return mPedestriansPool.get_allocated_count(); }
+    inline int GetPedestriansPoolHighWaterMark() const { return mPedestriansPool.get_high_water_mark(); }
+
 private:
     void DestroyObjectsInList(cxx::intrusive_list<Pedestrian>& objectsList);
     void DestroyObjectsInList(cxx::intrusive_list<Vehicle>& objectsList);
@@ -53,10 +71,51 @@ private:
     void RemoveFromActiveList(Vehicle* object);
 
     void DestroyPendingObjects();
+
+    // update pedestrians in parallel batches, each batch records physics commands and structural changes
+    // into its own command buffer, buffers are applied afterwards in batches order so result does not depend
+    // on number of threads
+    void UpdatePedestrians();
+
+    // choose simulation level of detail for object and compute its update delta time
+    // @param object: Game object
+    // @param physicsComponent: Object physics body
+    // @param deltaTime: Time since last frame
+    // @param updateDeltaTime: Output time since last object update
+    // @returns false if object should not be updated this frame
+    bool ProcessSimulationLOD(GameObject* object, PhysicsComponent* physicsComponent, Timespan deltaTime, Timespan& updateDeltaTime);
+
+    // allocate or release object slot, released identifier becomes stale
+    // @param objectID: Unique identifier
     GameObjectID_t GenerateUniqueID();
+    void ReleaseUniqueID(GameObjectID_t objectID);
 
 private:
-    GameObjectID_t mIDsCounter = 0;
+    // objects slots table indexed by identifier slot index
+    struct ObjectSlot
+    {
+    public:
+        GameObjectID_t mObjectID; // current identifier of object in slot or next identifier for free slot
+        Pedestrian* mPedestrian;
+        Vehicle* mCar;
+    };
+    std::vector<ObjectSlot> mObjectsSlots;
+    std::vector<int> mFreeObjectsSlots;
+
+    unsigned int mFrameIndex = 0; // used to spread reduced rate updates across frames
+
+    // pedestrians update
+    struct PedestrianUpdate
+    {
+    public:
+        Pedestrian* mPedestrian;
+        Timespan mDeltaTime;
+    };
+    std::vector<PedestrianUpdate> mUpdatePedestrians;
+    std::vector<GameObjectsCommandBuffer> mPedestriansCommandBuffers; // per batch
+
+    // cars destroyed since last render snapshot capture, their sprites are cached by renderer
+    std::vector<GameObjectID_t> mDestroyedCarsIDs;
 
     // objects pools
     cxx::object_pool<Pedestrian> mPedestriansPool;
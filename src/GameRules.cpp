@@ -15,4 +15,23 @@ void GameRules::LoadDefaults()
     mPedestrianSlideOnCarSpeed = MAP_BLOCK_LENGTH * 1.2f;
     mPedestrianWalkSpeed = MAP_BLOCK_LENGTH * 0.7f;
     mPedestrianRunSpeed = MAP_BLOCK_LENGTH * 1.5f;
+
+    mTrafficCarsBudget = 500;
+    mTrafficSpawnRadius = MAP_BLOCK_LENGTH * 48.0f;
+    mTrafficSpawnMinDistance = MAP_BLOCK_LENGTH * 14.0f;
+    mTrafficDespawnRadius = MAP_BLOCK_LENGTH * 56.0f;
+    mTrafficPhysicsRadius = MAP_BLOCK_LENGTH * 12.0f;
+    mTrafficCarSpeed = MAP_BLOCK_LENGTH * 3.0f;
+
+    mPedestriansDensity = 0.03f;
+    mPedestriansMaxCount = 150;
+    mPedestriansMaxSpawnsPerFrame = 2;
+    mPedestriansMaxDespawnsPerFrame = 4;
+    mPedestriansSpawnMinDistance = MAP_BLOCK_LENGTH * 10.0f;
+    mPedestriansSpawnRadius = MAP_BLOCK_LENGTH * 22.0f;
+    mPedestriansDespawnRadius = MAP_BLOCK_LENGTH * 26.0f;
+
+    mSimulationFullRateRadius = MAP_BLOCK_LENGTH * 16.0f;
+    mSimulationReducedRateRadius = MAP_BLOCK_LENGTH * 32.0f;
+    mSimulationReducedRateInterval = 4;
 }
\ No newline at end of file
@@ -16,6 +16,28 @@ public:
     float mPedestrianSlideOnCarSpeed; // in blocks per second
     float mPedestrianWalkSpeed; // in blocks per second
     float mPedestrianRunSpeed; // in blocks per second
+
+    // traffic
+    int mTrafficCarsBudget; // max number of ambient cars around player
+    float mTrafficSpawnRadius; // in blocks
+    float mTrafficSpawnMinDistance; // in blocks, cars are not spawned right in front of player
+    float mTrafficDespawnRadius; // in blocks
+    float mTrafficPhysicsRadius; // in blocks, cars within radius around camera are fully simulated
+    float mTrafficCarSpeed; // in blocks per second
+
+    // ambient pedestrians
+    float mPedestriansDensity; // pedestrians per square block of spawn area
+    int mPedestriansMaxCount; // max number of ambient pedestrians
+    int mPedestriansMaxSpawnsPerFrame;
+    int mPedestriansMaxDespawnsPerFrame;
+    float mPedestriansSpawnMinDistance; // in blocks, pedestrians are not spawned right in front of camera
+    float mPedestriansSpawnRadius; // in blocks
+    float mPedestriansDespawnRadius; // in blocks
+
+    // simulation level of detail
+    float mSimulationFullRateRadius; // in blocks, objects within radius around camera are updated every frame
+    float mSimulationReducedRateRadius; // in blocks, objects beyond radius are dormant
+    int mSimulationReducedRateInterval; // in frames
 };
 
 extern GameRules gGameRules;
\ No newline at end of file
@@ -0,0 +1,334 @@
+#include "stdafx.h"
+#include "InputsRecorder.h"
+#include "CarnageGame.h"
+
+enum
+{
+    INPUTS_RECORD_FILE_MAGIC = 0x52493343, // 'C3IR'
+    INPUTS_RECORD_FILE_VERSION = 1,
+};
+
+struct InputsRecordFileHeader
+{
+    unsigned int mMagic;
+    unsigned int mVersion;
+    unsigned int mSizeofEvent;
+    int mFramesCount;
+    int mEventsCount;
+};
+
+// get value at specified percentile of sorted samples
+inline float get_sorted_percentile(const std::vector<float>& sortedSamples, float percentile)
+{
+    if (sortedSamples.empty())
+        return 0.0f;
+
+    int sampleIndex = static_cast<int>((sortedSamples.size() - 1) * percentile + 0.5f);
+    return sortedSamples[sampleIndex];
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+InputsRecorder gInputsRecorder;
+
+void InputsRecorder::StartRecording(const char* filePath)
+{
+    debug_assert(filePath);
+    debug_assert(!mReplaying);
+
+    mFilePath = filePath;
+    mFramesDeltaTime.clear();
+    mEvents.clear();
+    mRecordingStartTimestamp = gSystem.GetSysMilliseconds();
+    mFrameIndex = 0;
+    mRecording = true;
+
+    gConsole.LogMessage(eLogMessage_Info, "Recording inputs to '%s'", filePath);
+}
+
+bool InputsRecorder::StopRecording()
+{
+    if (!mRecording)
+        return false;
+
+    mRecording = false;
+
+    InputsRecordFileHeader header;
+    header.mMagic = INPUTS_RECORD_FILE_MAGIC;
+    header.mVersion = INPUTS_RECORD_FILE_VERSION;
+    header.mSizeofEvent = sizeof(InputsRecordEvent);
+    header.mFramesCount = static_cast<int>(mFramesDeltaTime.size());
+    header.mEventsCount = static_cast<int>(mEvents.size());
+
+    std::ofstream file (mFilePath, std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!file.is_open())
+    {
+        gConsole.LogMessage(eLogMessage_Warning, "Cannot write inputs record '%s'", mFilePath.c_str());
+        return false;
+    }
+
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    if (header.mFramesCount > 0)
+    {
+        file.write(reinterpret_cast<const char*>(mFramesDeltaTime.data()), mFramesDeltaTime.size() * sizeof(int));
+    }
+    if (header.mEventsCount > 0)
+    {
+        file.write(reinterpret_cast<const char*>(mEvents.data()), mEvents.size() * sizeof(InputsRecordEvent));
+    }
+
+    if (!file)
+    {
+        gConsole.LogMessage(eLogMessage_Warning, "Cannot write inputs record '%s'", mFilePath.c_str());
+        return false;
+    }
+
+    gConsole.LogMessage(eLogMessage_Info, "Inputs record saved: %d frames, %d events", header.mFramesCount, header.mEventsCount);
+    return true;
+}
+
+bool InputsRecorder::StartReplay(const char* filePath)
+{
+    debug_assert(filePath);
+    debug_assert(!mRecording);
+
+    mFramesDeltaTime.clear();
+    mEvents.clear();
+    mFramesTime.clear();
+    mReplayStats = InputsReplayStats();
+
+    std::ifstream file (filePath, std::ios::in | std::ios::binary);
+    if (!file.is_open())
+    {
+        gConsole.LogMessage(eLogMessage_Warning, "Cannot open inputs record '%s'", filePath);
+        return false;
+    }
+
+    InputsRecordFileHeader header;
+    if (!file.read(reinterpret_cast<char*>(&header), sizeof(header)) || header.mMagic != INPUTS_RECORD_FILE_MAGIC ||
+        header.mVersion != INPUTS_RECORD_FILE_VERSION || header.mSizeofEvent != sizeof(InputsRecordEvent) ||
+        header.mFramesCount < 0 || header.mEventsCount < 0)
+    {
+        gConsole.LogMessage(eLogMessage_Warning, "Inputs record '%s' has unsupported format", filePath);
+        return false;
+    }
+
+    mFramesDeltaTime.resize(header.mFramesCount);
+    mEvents.resize(header.mEventsCount);
+    if ((header.mFramesCount > 0 && !file.read(reinterpret_cast<char*>(mFramesDeltaTime.data()), mFramesDeltaTime.size() * sizeof(int))) ||
+        (header.mEventsCount > 0 && !file.read(reinterpret_cast<char*>(mEvents.data()), mEvents.size() * sizeof(InputsRecordEvent))))
+    {
+        gConsole.LogMessage(eLogMessage_Warning, "Inputs record '%s' is corrupted", filePath);
+        mFramesDeltaTime.clear();
+        mEvents.clear();
+        return false;
+    }
+
+    mFramesTime.reserve(mFramesDeltaTime.size());
+    mFrameIndex = 0;
+    mNextEventIndex = 0;
+    mReplaying = true;
+
+    gConsole.LogMessage(eLogMessage_Info, "Replaying inputs from '%s': %d frames, %d events", filePath, header.mFramesCount, header.mEventsCount);
+    return true;
+}
+
+void InputsRecorder::StopReplay()
+{
+    if (!mReplaying)
+        return;
+
+    mReplaying = false;
+
+    std::vector<float> sortedFramesTime = mFramesTime;
+    std::sort(sortedFramesTime.begin(), sortedFramesTime.end());
+
+    mReplayStats = InputsReplayStats();
+    mReplayStats.mFramesCount = static_cast<int>(sortedFramesTime.size());
+    if (sortedFramesTime.empty())
+        return;
+
+    for (float currFrameTime: sortedFramesTime)
+    {
+        mReplayStats.mTotalMilliseconds += currFrameTime;
+    }
+    mReplayStats.mMinFrameMilliseconds = sortedFramesTime.front();
+    mReplayStats.mMaxFrameMilliseconds = sortedFramesTime.back();
+    mReplayStats.mAverageFrameMilliseconds = mReplayStats.mTotalMilliseconds / mReplayStats.mFramesCount;
+    mReplayStats.mMedianFrameMilliseconds = get_sorted_percentile(sortedFramesTime, 0.5f);
+    mReplayStats.mPercentile95FrameMilliseconds = get_sorted_percentile(sortedFramesTime, 0.95f);
+    mReplayStats.mPercentile99FrameMilliseconds = get_sorted_percentile(sortedFramesTime, 0.99f);
+}
+
+bool InputsRecorder::BeginFrame(Timespan& deltaTime)
+{
+    if (mRecording)
+    {
+        mFramesDeltaTime.push_back(static_cast<int>(deltaTime.mMilliseconds));
+        ++mFrameIndex;
+        return true;
+    }
+
+    if (!mReplaying)
+        return true;
+
+    if (mFrameIndex >= static_cast<int>(mFramesDeltaTime.size()))
+        return false;
+
+    // events captured during previous frame present are dispatched before current frame gets updated,
+    // same as with live inputs
+    for (int numEvents = static_cast<int>(mEvents.size()); mNextEventIndex < numEvents; ++mNextEventIndex)
+    {
+        const InputsRecordEvent& currEvent = mEvents[mNextEventIndex];
+        if (currEvent.mFrameIndex > mFrameIndex)
+            break;
+
+        DispatchEvent(currEvent);
+    }
+
+    deltaTime = mFramesDeltaTime[mFrameIndex];
+    ++mFrameIndex;
+
+    mFrameStartTime = std::chrono::steady_clock::now();
+    return true;
+}
+
+void InputsRecorder::EndFrame()
+{
+    if (!mReplaying)
+        return;
+
+    std::chrono::duration<float, std::milli> frameTime = std::chrono::steady_clock::now() - mFrameStartTime;
+    mFramesTime.push_back(frameTime.count());
+}
+
+void InputsRecorder::RecordEvent(const MouseButtonInputEvent& inputEvent)
+{
+    InputsRecordEvent recordEvent {};
+    recordEvent.mEventType = eInputsRecordEvent_MouseButton;
+    recordEvent.mParams[0] = inputEvent.mButton;
+    recordEvent.mParams[1] = inputEvent.mMods;
+    recordEvent.mPressed = inputEvent.mPressed;
+    recordEvent.mConsumed = inputEvent.mConsumed;
+    PushEvent(recordEvent);
+}
+
+void InputsRecorder::RecordEvent(const MouseMovedInputEvent& inputEvent)
+{
+    InputsRecordEvent recordEvent {};
+    recordEvent.mEventType = eInputsRecordEvent_MouseMoved;
+    recordEvent.mParams[0] = inputEvent.mCursorPositionX;
+    recordEvent.mParams[1] = inputEvent.mCursorPositionY;
+    recordEvent.mParams[2] = inputEvent.mDeltaX;
+    recordEvent.mParams[3] = inputEvent.mDeltaY;
+    recordEvent.mConsumed = inputEvent.mConsumed;
+    PushEvent(recordEvent);
+}
+
+void InputsRecorder::RecordEvent(const MouseScrollInputEvent& inputEvent)
+{
+    InputsRecordEvent recordEvent {};
+    recordEvent.mEventType = eInputsRecordEvent_MouseScroll;
+    recordEvent.mParams[0] = inputEvent.mScrollX;
+    recordEvent.mParams[1] = inputEvent.mScrollY;
+    recordEvent.mConsumed = inputEvent.mConsumed;
+    PushEvent(recordEvent);
+}
+
+void InputsRecorder::RecordEvent(const KeyInputEvent& inputEvent)
+{
+    InputsRecordEvent recordEvent {};
+    recordEvent.mEventType = eInputsRecordEvent_Key;
+    recordEvent.mParams[0] = inputEvent.mKeycode;
+    recordEvent.mParams[1] = inputEvent.mScancode;
+    recordEvent.mParams[2] = inputEvent.mMods;
+    recordEvent.mPressed = inputEvent.mPressed;
+    recordEvent.mConsumed = inputEvent.mConsumed;
+    PushEvent(recordEvent);
+}
+
+void InputsRecorder::RecordEvent(const KeyCharEvent& inputEvent)
+{
+    InputsRecordEvent recordEvent {};
+    recordEvent.mEventType = eInputsRecordEvent_KeyChar;
+    recordEvent.mParams[0] = static_cast<int>(inputEvent.mUnicodeChar);
+    recordEvent.mConsumed = inputEvent.mConsumed;
+    PushEvent(recordEvent);
+}
+
+void InputsRecorder::DumpReplayStats() const
+{
+    gConsole.LogMessage(eLogMessage_Info, "Replay frames: %d, total time: %.2f ms", mReplayStats.mFramesCount, mReplayStats.mTotalMilliseconds);
+    gConsole.LogMessage(eLogMessage_Info, "Frame time ms: min %.3f, avg %.3f, median %.3f, p95 %.3f, p99 %.3f, max %.3f",
+        mReplayStats.mMinFrameMilliseconds,
+        mReplayStats.mAverageFrameMilliseconds,
+        mReplayStats.mMedianFrameMilliseconds,
+        mReplayStats.mPercentile95FrameMilliseconds,
+        mReplayStats.mPercentile99FrameMilliseconds,
+        mReplayStats.mMaxFrameMilliseconds);
+}
+
+void InputsRecorder::PushEvent(InputsRecordEvent& recordEvent)
+{
+    if (!mRecording)
+        return;
+
+    // events are dispatched during present so they affect next frame
+    recordEvent.mFrameIndex = mFrameIndex;
+    recordEvent.mTimestamp = static_cast<int>(gSystem.GetSysMilliseconds() - mRecordingStartTimestamp);
+    mEvents.push_back(recordEvent);
+}
+
+void InputsRecorder::DispatchEvent(const InputsRecordEvent& recordEvent)
+{
+    // gui is bypassed, whether event was consumed by it is known from record
+    switch (recordEvent.mEventType)
+    {
+        case eInputsRecordEvent_Key:
+        {
+            KeyInputEvent inputEvent (recordEvent.mParams[0], recordEvent.mParams[1], recordEvent.mParams[2], recordEvent.mPressed);
+            inputEvent.mConsumed = recordEvent.mConsumed;
+            gInputs.HandleEvent(inputEvent);
+            gCarnageGame.InputEvent(inputEvent);
+        }
+        break;
+
+        case eInputsRecordEvent_KeyChar:
+        {
+            KeyCharEvent inputEvent (static_cast<unsigned int>(recordEvent.mParams[0]));
+            inputEvent.mConsumed = recordEvent.mConsumed;
+            gInputs.HandleEvent(inputEvent);
+            gCarnageGame.InputEvent(inputEvent);
+        }
+        break;
+
+        case eInputsRecordEvent_MouseButton:
+        {
+            MouseButtonInputEvent inputEvent (recordEvent.mParams[0], recordEvent.mParams[1], recordEvent.mPressed);
+            inputEvent.mConsumed = recordEvent.mConsumed;
+            gInputs.HandleEvent(inputEvent);
+            gCarnageGame.InputEvent(inputEvent);
+        }
+        break;
+
+        case eInputsRecordEvent_MouseMoved:
+        {
+            MouseMovedInputEvent inputEvent (recordEvent.mParams[0], recordEvent.mParams[1]);
+            inputEvent.mDeltaX = recordEvent.mParams[2];
+            inputEvent.mDeltaY = recordEvent.mParams[3];
+            inputEvent.mConsumed = recordEvent.mConsumed;
+            gInputs.HandleEvent(inputEvent);
+            gCarnageGame.InputEvent(inputEvent);
+        }
+        break;
+
+        case eInputsRecordEvent_MouseScroll:
+        {
+            MouseScrollInputEvent inputEvent (recordEvent.mParams[0], recordEvent.mParams[1]);
+            inputEvent.mConsumed = recordEvent.mConsumed;
+            gInputs.HandleEvent(inputEvent);
+            gCarnageGame.InputEvent(inputEvent);
+        }
+        break;
+    }
+}
\ No newline at end of file
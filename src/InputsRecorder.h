@@ -0,0 +1,101 @@
+#pragma once
+
+// recorded input event type
+enum eInputsRecordEvent
+{
+    eInputsRecordEvent_Key,
+    eInputsRecordEvent_KeyChar,
+    eInputsRecordEvent_MouseButton,
+    eInputsRecordEvent_MouseMoved,
+    eInputsRecordEvent_MouseScroll,
+};
+
+// defines input event captured during recording session
+struct InputsRecordEvent
+{
+public:
+    eInputsRecordEvent mEventType;
+    int mFrameIndex; // frame before which event gets dispatched
+    int mTimestamp; // milliseconds since recording started
+    int mParams[4]; // event specific data
+    bool mPressed;
+    bool mConsumed; // event was consumed by gui and never reached game
+};
+
+// frame time statistics collected during replay
+struct InputsReplayStats
+{
+public:
+    int mFramesCount = 0;
+    float mTotalMilliseconds = 0.0f;
+    float mMinFrameMilliseconds = 0.0f;
+    float mMaxFrameMilliseconds = 0.0f;
+    float mAverageFrameMilliseconds = 0.0f;
+    float mMedianFrameMilliseconds = 0.0f;
+    float mPercentile95FrameMilliseconds = 0.0f;
+    float mPercentile99FrameMilliseconds = 0.0f;
+};
+
+// records input events stream along with frames delta time sequence and replays it with deterministic timing,
+// so that same session can be simulated again for benchmarking
+class InputsRecorder final: public cxx::noncopyable
+{
+public:
+    InputsReplayStats mReplayStats;
+
+public:
+    // start capture of input events and frames delta time
+    // @param filePath: Output file, written once recording is stopped
+    void StartRecording(const char* filePath);
+
+    // stop capture and write recorded session to file
+    bool StopRecording();
+
+    // load recorded session and start replay from first frame
+    // @param filePath: Recorded session file
+    bool StartReplay(const char* filePath);
+
+    // stop replay and compute frame time statistics
+    void StopReplay();
+
+    // must be called at the beginning of each frame before game gets updated,
+    // during replay it dispatches recorded events and overrides frame delta time
+    // @param deltaTime: Frame delta time, gets replaced by recorded one during replay
+    // @returns false if replay is finished
+    bool BeginFrame(Timespan& deltaTime);
+
+    // must be called at the end of each frame, measures frame time during replay
+    void EndFrame();
+
+    // capture input event, ignored if recording is not started
+    // @param inputEvent: Event data after it was handled by gui
+    void RecordEvent(const MouseButtonInputEvent& inputEvent);
+    void RecordEvent(const MouseMovedInputEvent& inputEvent);
+    void RecordEvent(const MouseScrollInputEvent& inputEvent);
+    void RecordEvent(const KeyInputEvent& inputEvent);
+    void RecordEvent(const KeyCharEvent& inputEvent);
+
+    // print frame time statistics of last replay to console
+    void DumpReplayStats() const;
+
+    inline bool IsRecording() const { return mRecording; }
+    inline bool IsReplaying() const { return mReplaying; }
+
+private:
+    void PushEvent(InputsRecordEvent& recordEvent);
+    void DispatchEvent(const InputsRecordEvent& recordEvent);
+
+private:
+    std::string mFilePath;
+    std::vector<int> mFramesDeltaTime; // milliseconds
+    std::vector<InputsRecordEvent> mEvents;
+    std::vector<float> mFramesTime; // measured frame time in milliseconds
+    std::chrono::steady_clock::time_point mFrameStartTime;
+    long mRecordingStartTimestamp = 0;
+    int mFrameIndex = 0;
+    int mNextEventIndex = 0;
+    bool mRecording = false;
+    bool mReplaying = false;
+};
+
+extern InputsRecorder gInputsRecorder;
\ No newline at end of file
@@ -16,6 +16,24 @@ int main(int argc, char *argv[])
             iarg += 2;
             continue;
         }
+        if (cxx_stricmp(argv[iarg], "-record") == 0 && (argc > iarg + 1))
+        {
+            sysStartupParams.mRecordInputsPath = argv[iarg + 1];
+            iarg += 2;
+            continue;
+        }
+        if (cxx_stricmp(argv[iarg], "-replay") == 0 && (argc > iarg + 1))
+        {
+            sysStartupParams.mReplayInputsPath = argv[iarg + 1];
+            iarg += 2;
+            continue;
+        }
+        if (cxx_stricmp(argv[iarg], "-headless") == 0)
+        {
+            sysStartupParams.mHeadless = true;
+            ++iarg;
+            continue;
+        }
         ++iarg;
     }
 
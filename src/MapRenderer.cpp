@@ -8,92 +8,112 @@
 #include "GameCheatsWindow.h"
 #include "PhysicsComponents.h"
 #include "PhysicsManager.h"
-#include "Pedestrian.h"
-#include "Vehicle.h"
+#include "RenderSnapshot.h"
 
 bool MapRenderer::Initialize()
 {
-    mCityMeshBufferV = gGraphicsDevice.CreateBuffer(eBufferContent_Vertices);
-    debug_assert(mCityMeshBufferV);
-
-    mCityMeshBufferI = gGraphicsDevice.CreateBuffer(eBufferContent_Indices);
-    debug_assert(mCityMeshBufferI);
-
-    if (mCityMeshBufferV == nullptr || mCityMeshBufferI == nullptr)
-        return false;
-
     if (!mSpritesBatch.Initialize())
     {
         gConsole.LogMessage(eLogMessage_Warning, "Cannot initialize sprites batch");
         return false;
     }
 
-    mCityMapRectangle.SetNull();
+    mCityMeshChunksArea.SetNull();
     return true;
 }
 
 void MapRenderer::Deinit()
 {
     mSpritesBatch.Deinit();
-    if (mCityMeshBufferV)
-    {
-        gGraphicsDevice.DestroyBuffer(mCityMeshBufferV);
-        mCityMeshBufferV = nullptr;
-    }
-
-    if (mCityMeshBufferI)
+    for (int chunky = 0; chunky < MAP_CHUNKS_COUNT; ++chunky)
+    for (int chunkx = 0; chunkx < MAP_CHUNKS_COUNT; ++chunkx)
     {
-        gGraphicsDevice.DestroyBuffer(mCityMeshBufferI);
-        mCityMeshBufferI = nullptr;
+        ReleaseCityMeshChunk(chunkx, chunky);
     }
 
     for (int iLayer = 0; iLayer < MAP_LAYERS_COUNT; ++iLayer)
     {
         mCityMeshData[iLayer].SetNull();
     }
-    mCityMapRectangle.SetNull();
+    mCityMeshChunksArea.SetNull();
 }
 
-void MapRenderer::RenderFrame()
+void MapRenderer::RenderFrame(const RenderSnapshot& snapshot)
 {
     BuildMapMesh();
     DrawCityMesh();
 
     // collect and render game objects sprites
-    for (Pedestrian* currPedestrian: gCarnageGame.mObjectsManager.mActivePedestriansList)
+    DrawSprites(snapshot.mPedestrians);
+    DrawSprites(snapshot.mCars);
+    mSpritesBatch.Flush();
+}
+
+void MapRenderer::DrawSprites(const std::vector<SpriteDrawState>& drawStates)
+{
+    Sprite drawSprite;
+
+    // draw states are already interpolated between physics steps at capture time
+    for (const SpriteDrawState& currState: drawStates)
     {
-        currPedestrian->DrawFrame(mSpritesBatch);
+        gSpriteManager.GetSpriteTexture(currState.mObjectID, currState.mSpriteIndex, currState.mSpriteDeltaBits, drawSprite);
+        drawSprite.mPosition = glm::vec2(currState.mPosition.x, currState.mPosition.z);
+        drawSprite.mScale = SPRITE_SCALE;
+        drawSprite.mRotateAngle = currState.mRotateAngle;
+        drawSprite.mHeight = currState.mPosition.y;
+        drawSprite.SetOriginToCenter();
+        mSpritesBatch.DrawSprite(drawSprite);
     }
-    for (Vehicle* currVehicle: gCarnageGame.mObjectsManager.mActiveCarsList)
-    {
-        currVehicle->DrawFrame(mSpritesBatch);
-    }
-    mSpritesBatch.Flush();
 }
 
-void MapRenderer::CommitCityMeshData()
+void MapRenderer::BuildCityMeshChunk(int chunkx, int chunky)
 {
+    CityMeshChunk& meshChunk = mCityMeshChunks[chunky][chunkx];
+    meshChunk.mMapChunkVersion = gGameMap.GetChunkVersion(chunkx, chunky);
+    meshChunk.mIsBuilt = true;
+
+    Rect2D chunkArea { chunkx * MAP_CHUNK_DIMENSIONS, chunky * MAP_CHUNK_DIMENSIONS, MAP_CHUNK_DIMENSIONS, MAP_CHUNK_DIMENSIONS };
+
     int totalIndexCount = 0;
     int totalVertexCount = 0;
 
     for (int iLayer = 0; iLayer < MAP_LAYERS_COUNT; ++iLayer)
     {
+        GameMapHelpers::BuildMapMesh(gGameMap, chunkArea, iLayer, mCityMeshData[iLayer]);
+
         int numVertices = mCityMeshData[iLayer].mBlocksVertices.size();
+        meshChunk.mLayerVerticesCount[iLayer] = numVertices;
         totalVertexCount += numVertices;
 
         int numIndices = mCityMeshData[iLayer].mBlocksIndices.size();
+        meshChunk.mLayerIndicesCount[iLayer] = numIndices;
         totalIndexCount += numIndices;
     }
 
     if (totalIndexCount == 0 || totalVertexCount == 0)
         return;
 
+    if (meshChunk.mBufferV == nullptr)
+    {
+        meshChunk.mBufferV = gGraphicsDevice.CreateBuffer(eBufferContent_Vertices);
+        debug_assert(meshChunk.mBufferV);
+    }
+
+    if (meshChunk.mBufferI == nullptr)
+    {
+        meshChunk.mBufferI = gGraphicsDevice.CreateBuffer(eBufferContent_Indices);
+        debug_assert(meshChunk.mBufferI);
+    }
+
+    if (meshChunk.mBufferV == nullptr || meshChunk.mBufferI == nullptr)
+        return;
+
     int totalIndexDataBytes = totalIndexCount * Sizeof_DrawIndex_t;
     int totalVertexDataBytes = totalVertexCount * Sizeof_CityVertex3D;
 
     // upload vertex data
-    mCityMeshBufferV->Setup(eBufferUsage_Static, totalVertexDataBytes, nullptr);
-    if (void* pdata = mCityMeshBufferV->Lock(BufferAccess_Write))
+    meshChunk.mBufferV->Setup(eBufferUsage_Static, totalVertexDataBytes, nullptr);
+    if (void* pdata = meshChunk.mBufferV->Lock(BufferAccess_Write))
     {
         char* pcursor = static_cast<char*>(pdata);
         for (int iLayer = 0; iLayer < MAP_LAYERS_COUNT; ++iLayer)
@@ -104,12 +124,12 @@ void MapRenderer::CommitCityMeshData()
             memcpy(pcursor, mCityMeshData[iLayer].mBlocksVertices.data(), dataLength);
             pcursor += dataLength;
         }
-        mCityMeshBufferV->Unlock();
+        meshChunk.mBufferV->Unlock();
     }
 
     // upload index data
-    mCityMeshBufferI->Setup(eBufferUsage_Static, totalIndexDataBytes, nullptr);
-    if (void* pdata = mCityMeshBufferI->Lock(BufferAccess_Write))
+    meshChunk.mBufferI->Setup(eBufferUsage_Static, totalIndexDataBytes, nullptr);
+    if (void* pdata = meshChunk.mBufferI->Lock(BufferAccess_Write))
     {
         char* pcursor = static_cast<char*>(pdata);
         for (int iLayer = 0; iLayer < MAP_LAYERS_COUNT; ++iLayer)
@@ -120,56 +140,74 @@ void MapRenderer::CommitCityMeshData()
             memcpy(pcursor, mCityMeshData[iLayer].mBlocksIndices.data(), dataLength);
             pcursor += dataLength;
         }
-        mCityMeshBufferI->Unlock();
+        meshChunk.mBufferI->Unlock();
     }
 }
 
-void MapRenderer::BuildMapMesh()
+void MapRenderer::ReleaseCityMeshChunk(int chunkx, int chunky)
 {
-    if (gGameCheatsWindow.mGenerateFullMeshForMap && mCityMapRectangle.h == 0 && mCityMapRectangle.w == 0)
+    CityMeshChunk& meshChunk = mCityMeshChunks[chunky][chunkx];
+    if (meshChunk.mBufferV)
     {
-        mCityMapRectangle.x = 0;
-        mCityMapRectangle.y = 0;
-        mCityMapRectangle.w = MAP_DIMENSIONS;
-        mCityMapRectangle.h = MAP_DIMENSIONS;  
-
-        gConsole.LogMessage(eLogMessage_Debug, "City mesh invalidated [full]");
-        for (int i = 0; i < MAP_LAYERS_COUNT; ++i)
-        {
-            GameMapHelpers::BuildMapMesh(gGameMap, mCityMapRectangle, i, gRenderManager.mMapRenderer.mCityMeshData[i]);
-        }
-        gRenderManager.mMapRenderer.CommitCityMeshData();
-        return;
+        gGraphicsDevice.DestroyBuffer(meshChunk.mBufferV);
+        meshChunk.mBufferV = nullptr;
     }
 
-    int viewBlocks = 14;
-
-    int tilex = static_cast<int>(gCamera.mPosition.x / MAP_BLOCK_LENGTH);
-    int tiley = static_cast<int>(gCamera.mPosition.z / MAP_BLOCK_LENGTH);
+    if (meshChunk.mBufferI)
+    {
+        gGraphicsDevice.DestroyBuffer(meshChunk.mBufferI);
+        meshChunk.mBufferI = nullptr;
+    }
+    meshChunk.mIsBuilt = false;
+}
 
-    Rect2D rcMapView { -viewBlocks / 2 + tilex, -viewBlocks / 2 + tiley, viewBlocks, viewBlocks };
+void MapRenderer::BuildMapMesh()
+{
+    Rect2D chunksArea { 0, 0, MAP_CHUNKS_COUNT, MAP_CHUNKS_COUNT };
+    if (!gGameCheatsWindow.mGenerateFullMeshForMap)
+    {
+        // chunks within cached map area around camera
+        int cacheNumBlocks = 32;
 
-    bool invalidateCache = mCityMapRectangle.w == 0 || mCityMapRectangle.h == 0 || 
-        rcMapView.x < mCityMapRectangle.x || rcMapView.y < mCityMapRectangle.y ||
-        rcMapView.x + rcMapView.w > mCityMapRectangle.x + mCityMapRectangle.w ||
-        rcMapView.y + rcMapView.h > mCityMapRectangle.y + mCityMapRectangle.h;
+        int tilex = static_cast<int>(gRenderCamera.mPosition.x / MAP_BLOCK_LENGTH);
+        int tiley = static_cast<int>(gRenderCamera.mPosition.z / MAP_BLOCK_LENGTH);
 
-    if (!invalidateCache)
-        return;
+        const int chunkxMin = glm::clamp(tilex - cacheNumBlocks / 2, 0, MAP_DIMENSIONS - 1) / MAP_CHUNK_DIMENSIONS;
+        const int chunkyMin = glm::clamp(tiley - cacheNumBlocks / 2, 0, MAP_DIMENSIONS - 1) / MAP_CHUNK_DIMENSIONS;
+        const int chunkxMax = glm::clamp(tilex + cacheNumBlocks / 2, 0, MAP_DIMENSIONS - 1) / MAP_CHUNK_DIMENSIONS;
+        const int chunkyMax = glm::clamp(tiley + cacheNumBlocks / 2, 0, MAP_DIMENSIONS - 1) / MAP_CHUNK_DIMENSIONS;
+        chunksArea.x = chunkxMin;
+        chunksArea.y = chunkyMin;
+        chunksArea.w = chunkxMax - chunkxMin + 1;
+        chunksArea.h = chunkyMax - chunkyMin + 1;
+    }
 
-    gConsole.LogMessage(eLogMessage_Debug, "City mesh invalidated [partial]");
+    for (int chunky = 0; chunky < MAP_CHUNKS_COUNT; ++chunky)
+    for (int chunkx = 0; chunkx < MAP_CHUNKS_COUNT; ++chunkx)
+    {
+        const CityMeshChunk& meshChunk = mCityMeshChunks[chunky][chunkx];
 
-    int cacheNumBlocks = 32;
-    mCityMapRectangle.x = (-cacheNumBlocks / 2) + tilex;
-    mCityMapRectangle.y = (-cacheNumBlocks / 2) + tiley;
-    mCityMapRectangle.w = cacheNumBlocks;
-    mCityMapRectangle.h = cacheNumBlocks;
+        bool insideArea = chunkx >= chunksArea.x && chunkx < chunksArea.x + chunksArea.w &&
+            chunky >= chunksArea.y && chunky < chunksArea.y + chunksArea.h;
+        if (insideArea)
+        {
+            // only chunks which were modified since mesh was built get rebuilt
+            if (!meshChunk.mIsBuilt || meshChunk.mMapChunkVersion != gGameMap.GetChunkVersion(chunkx, chunky))
+            {
+                BuildCityMeshChunk(chunkx, chunky);
+            }
+            continue;
+        }
 
-    for (int i = 0; i < MAP_LAYERS_COUNT; ++i)
-    {
-        GameMapHelpers::BuildMapMesh(gGameMap, mCityMapRectangle, i, gRenderManager.mMapRenderer.mCityMeshData[i]);
+        // keep one chunk margin around area so that chunks are not rebuilt while camera moves back and forth
+        bool insideMargin = chunkx >= chunksArea.x - 1 && chunkx <= chunksArea.x + chunksArea.w &&
+            chunky >= chunksArea.y - 1 && chunky <= chunksArea.y + chunksArea.h;
+        if (!insideMargin && (meshChunk.mIsBuilt || meshChunk.mBufferV || meshChunk.mBufferI))
+        {
+            ReleaseCityMeshChunk(chunkx, chunky);
+        }
     }
-    gRenderManager.mMapRenderer.CommitCityMeshData();
+    mCityMeshChunksArea = chunksArea;
 }
 
 void MapRenderer::DrawCityMesh()
@@ -182,21 +220,27 @@ void MapRenderer::DrawCityMesh()
     gRenderManager.mCityMeshProgram.UploadCameraTransformMatrices();
     gRenderManager.mCityMeshProgram.SetTextureMappingEnabled(gSpriteManager.mBlocksTextureArray != nullptr);
 
-    if (mCityMeshBufferV && mCityMeshBufferI)
+    gGraphicsDevice.BindTexture(eTextureUnit_0, gSpriteManager.mBlocksTextureArray);
+    gGraphicsDevice.BindTexture(eTextureUnit_1, gSpriteManager.mBlocksIndicesTable);
+
+    for (int chunky = mCityMeshChunksArea.y; chunky < mCityMeshChunksArea.y + mCityMeshChunksArea.h; ++chunky)
+    for (int chunkx = mCityMeshChunksArea.x; chunkx < mCityMeshChunksArea.x + mCityMeshChunksArea.w; ++chunkx)
     {
-        gGraphicsDevice.BindVertexBuffer(mCityMeshBufferV, CityVertex3D_Format::Get());
-        gGraphicsDevice.BindIndexBuffer(mCityMeshBufferI);
-        gGraphicsDevice.BindTexture(eTextureUnit_0, gSpriteManager.mBlocksTextureArray);
-        gGraphicsDevice.BindTexture(eTextureUnit_1, gSpriteManager.mBlocksIndicesTable);
+        const CityMeshChunk& meshChunk = mCityMeshChunks[chunky][chunkx];
+        if (!meshChunk.mIsBuilt || meshChunk.mBufferV == nullptr || meshChunk.mBufferI == nullptr)
+            continue;
+
+        gGraphicsDevice.BindVertexBuffer(meshChunk.mBufferV, CityVertex3D_Format::Get());
+        gGraphicsDevice.BindIndexBuffer(meshChunk.mBufferI);
 
         int currBaseVertex = 0;
         int currIndexOffset = 0;
-        
+
         for (int i = 0; i < MAP_LAYERS_COUNT; ++i)
         {
-            int numIndices = mCityMeshData[i].mBlocksIndices.size();
-            int numVertices = mCityMeshData[i].mBlocksVertices.size();
-            if (gGameCheatsWindow.mDrawMapLayers[i])
+            int numIndices = meshChunk.mLayerIndicesCount[i];
+            int numVertices = meshChunk.mLayerVerticesCount[i];
+            if (gGameCheatsWindow.mDrawMapLayers[i] && numIndices > 0)
             {
                 int currIndexOffsetBytes = currIndexOffset * Sizeof_DrawIndex_t;
                 gGraphicsDevice.RenderIndexedPrimitives(ePrimitiveType_Triangles, eIndicesType_i32, currIndexOffsetBytes, numIndices, currBaseVertex);
@@ -210,5 +254,10 @@ void MapRenderer::DrawCityMesh()
 
 void MapRenderer::InvalidateMapMesh()
 {
-    mCityMapRectangle.SetNull();
-}
\ No newline at end of file
+    // buffers are kept and reused when chunks get rebuilt
+    for (int chunky = 0; chunky < MAP_CHUNKS_COUNT; ++chunky)
+    for (int chunkx = 0; chunkx < MAP_CHUNKS_COUNT; ++chunkx)
+    {
+        mCityMeshChunks[chunky][chunkx].mIsBuilt = false;
+    }
+}
@@ -2,24 +2,46 @@
 
 #include "SpriteBatch.h"
 
+class RenderSnapshot;
+struct SpriteDrawState;
+
 // renders map mesh, peds, cars and map objects
 class MapRenderer final: public cxx::noncopyable
 {
 public:
     bool Initialize();
     void Deinit();
-    void RenderFrame();
     void InvalidateMapMesh();
 
+    // render map and objects sprites from snapshot
+    // @param snapshot: Snapshot to render
+    void RenderFrame(const RenderSnapshot& snapshot);
+
 private:
+    // city mesh of single map chunk, all layers are stored in same vertex and index buffers
+    struct CityMeshChunk
+    {
+    public:
+        GpuBuffer* mBufferV = nullptr;
+        GpuBuffer* mBufferI = nullptr;
+        int mLayerIndicesCount[MAP_LAYERS_COUNT] = {};
+        int mLayerVerticesCount[MAP_LAYERS_COUNT] = {};
+        unsigned int mMapChunkVersion = 0; // map chunk version at the moment when mesh was built
+        bool mIsBuilt = false;
+    };
+
     void BuildMapMesh();
-    void CommitCityMeshData();
     void DrawCityMesh();
+    void DrawSprites(const std::vector<SpriteDrawState>& drawStates);
+
+    // build and upload mesh of single map chunk, other chunks are left intact
+    // @param chunkx, chunky: Map chunk coordinate
+    void BuildCityMeshChunk(int chunkx, int chunky);
+    void ReleaseCityMeshChunk(int chunkx, int chunky);
 
 private:
-    Rect2D mCityMapRectangle; // cached map area in tiles
+    Rect2D mCityMeshChunksArea; // chunks which are currently drawn, in chunks
+    CityMeshChunk mCityMeshChunks[MAP_CHUNKS_COUNT][MAP_CHUNKS_COUNT]; // y, x
     SpriteBatch mSpritesBatch;
-    MapMeshData mCityMeshData[MAP_LAYERS_COUNT];
-    GpuBuffer* mCityMeshBufferV;
-    GpuBuffer* mCityMeshBufferI;
+    MapMeshData mCityMeshData[MAP_LAYERS_COUNT]; // temporary data used while chunk mesh gets built
 };
\ No newline at end of file
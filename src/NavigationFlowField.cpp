@@ -0,0 +1,197 @@
+#include "stdafx.h"
+#include "NavigationFlowField.h"
+
+NavigationFlowFields::NavigationFlowFields(NavigationGraph& navigationGraph)
+    : mNavigationGraph(navigationGraph)
+    , mFrameIndex()
+{
+}
+
+void NavigationFlowFields::Cleanup()
+{
+    // frame index is never reset so fields resolved before cleanup are not mistaken for current ones
+    mFlowFields.clear();
+    mOpenList.clear();
+}
+
+void NavigationFlowFields::UpdateFrame()
+{
+    ++mFrameIndex;
+
+    if ((int) mFlowFields.size() <= NAVIGATION_FLOW_FIELDS_COUNT)
+        return;
+
+    // most recently used fields go first
+    std::sort(mFlowFields.begin(), mFlowFields.end(), [](const std::unique_ptr<NavigationFlowField>& lhs, const std::unique_ptr<NavigationFlowField>& rhs)
+        {
+            return lhs->mLastUseFrame > rhs->mLastUseFrame;
+        });
+
+    // fields requested during previous frame will likely be requested again
+    int keepCount = NAVIGATION_FLOW_FIELDS_COUNT;
+    while (keepCount < (int) mFlowFields.size() && mFlowFields[keepCount]->mLastUseFrame + 1 == mFrameIndex)
+    {
+        ++keepCount;
+    }
+    mFlowFields.resize(keepCount);
+}
+
+const NavigationFlowField* NavigationFlowFields::GetFlowField(const glm::vec3& goal)
+{
+    int goalNode = mNavigationGraph.FindNode(goal);
+    if (goalNode == -1)
+        return nullptr;
+
+    return GetFlowField(goalNode);
+}
+
+const NavigationFlowField* NavigationFlowFields::GetFlowField(int goalNode)
+{
+    debug_assert(goalNode > -1 && goalNode < NAVIGATION_NODES_COUNT);
+
+    // find cached field or least recently used one which is not in use during current frame
+    NavigationFlowField* flowField = nullptr;
+    NavigationFlowField* unusedField = nullptr;
+    for (const std::unique_ptr<NavigationFlowField>& currField: mFlowFields)
+    {
+        if (currField->mGoalNode == goalNode)
+        {
+            flowField = currField.get();
+            break;
+        }
+        if (currField->mLastUseFrame == mFrameIndex)
+            continue;
+
+        if (unusedField == nullptr || currField->mLastUseFrame < unusedField->mLastUseFrame)
+        {
+            unusedField = currField.get();
+        }
+    }
+
+    if (flowField == nullptr)
+    {
+        flowField = unusedField;
+        if (flowField == nullptr || (int) mFlowFields.size() < NAVIGATION_FLOW_FIELDS_COUNT)
+        {
+            mFlowFields.emplace_back(new NavigationFlowField);
+            flowField = mFlowFields.back().get();
+        }
+    }
+
+    flowField->mLastUseFrame = mFrameIndex;
+    if (flowField->mGoalNode != goalNode || flowField->mGraphVersion != mNavigationGraph.GetVersion())
+    {
+        ComputeFlowField(*flowField, goalNode);
+    }
+    return flowField;
+}
+
+void NavigationFlowFields::ComputeFlowField(NavigationFlowField& flowField, int goalNode)
+{
+    flowField.mGoalNode = goalNode;
+    flowField.mGraphVersion = mNavigationGraph.GetVersion();
+    flowField.mIntegrationField.assign(NAVIGATION_NODES_COUNT, std::numeric_limits<float>::max());
+    flowField.mDirectionField.assign(NAVIGATION_NODES_COUNT, NAVIGATION_FLOW_DIRECTION_NONE);
+
+    auto compare_open_nodes = [](const OpenNode& lhs, const OpenNode& rhs)
+    {
+        return lhs.mCost > rhs.mCost;
+    };
+
+    // integration field is computed with dijkstra expanding from goal over incoming links
+    mOpenList.clear();
+    mOpenList.push_back({0.0f, goalNode});
+    flowField.mIntegrationField[goalNode] = 0.0f;
+
+    while (!mOpenList.empty())
+    {
+        std::pop_heap(mOpenList.begin(), mOpenList.end(), compare_open_nodes);
+        const OpenNode currNode = mOpenList.back();
+        mOpenList.pop_back();
+
+        if (currNode.mCost > flowField.mIntegrationField[currNode.mNodeIndex]) // outdated open list entry
+            continue;
+
+        int coordx;
+        int coordy;
+        int layer;
+        NavigationGraph::GetNodeLocation(currNode.mNodeIndex, coordx, coordy, layer);
+
+        for (int idirection = 0; idirection < NAVIGATION_DIRECTIONS_COUNT; ++idirection)
+        {
+            int offsetx;
+            int offsety;
+            NavigationGraph::GetDirectionOffset(idirection, offsetx, offsety);
+
+            // neighbour may be located on adjacent layer if connected with slope
+            const int sourceDirection = NavigationGraph::GetOppositeDirection(idirection);
+            for (int sourceLayer = layer - 1; sourceLayer <= layer + 1; ++sourceLayer)
+            {
+                int sourceNode = mNavigationGraph.FindNode(coordx + offsetx, coordy + offsety, sourceLayer);
+                if (sourceNode == -1)
+                    continue;
+
+                float linkCost;
+                if (mNavigationGraph.GetLinkedNode(sourceNode, sourceDirection, linkCost) != currNode.mNodeIndex)
+                    continue;
+
+                float sourceCost = currNode.mCost + linkCost;
+                if (sourceCost >= flowField.mIntegrationField[sourceNode])
+                    continue;
+
+                flowField.mIntegrationField[sourceNode] = sourceCost;
+                flowField.mDirectionField[sourceNode] = (unsigned char) sourceDirection;
+                mOpenList.push_back({sourceCost, sourceNode});
+                std::push_heap(mOpenList.begin(), mOpenList.end(), compare_open_nodes);
+            }
+        }
+    }
+}
+
+bool NavigationFlowFields::GetFlowDirection(const NavigationFlowField* flowField, const glm::vec3& position, glm::vec2& outputDirection) const
+{
+    debug_assert(flowField);
+
+    int nodeIndex = mNavigationGraph.FindNode(position);
+    if (nodeIndex == -1)
+        return false;
+
+    int direction = flowField->mDirectionField[nodeIndex];
+    if (direction == NAVIGATION_FLOW_DIRECTION_NONE)
+        return false;
+
+    // steer toward center of next block rather than along grid direction to not slide along walls
+    int coordx;
+    int coordy;
+    int layer;
+    NavigationGraph::GetNodeLocation(nodeIndex, coordx, coordy, layer);
+
+    int offsetx;
+    int offsety;
+    NavigationGraph::GetDirectionOffset(direction, offsetx, offsety);
+
+    glm::vec2 targetPosition (
+        (coordx + offsetx + 0.5f) * MAP_BLOCK_LENGTH,
+        (coordy + offsety + 0.5f) * MAP_BLOCK_LENGTH);
+
+    glm::vec2 toTarget = targetPosition - glm::vec2(position.x, position.z);
+    float distance = glm::length(toTarget);
+    if (distance < 0.001f)
+    {
+        toTarget = glm::vec2(offsetx * 1.0f, offsety * 1.0f);
+        distance = glm::length(toTarget);
+    }
+    outputDirection = toTarget / distance;
+    return true;
+}
+
+float NavigationFlowFields::GetFlowCost(const NavigationFlowField* flowField, const glm::vec3& position) const
+{
+    debug_assert(flowField);
+
+    int nodeIndex = mNavigationGraph.FindNode(position);
+    if (nodeIndex == -1)
+        return std::numeric_limits<float>::max();
+
+    return flowField->mIntegrationField[nodeIndex];
+}
\ No newline at end of file
@@ -0,0 +1,72 @@
+#pragma once
+
+#include "NavigationGraph.h"
+
+#define NAVIGATION_FLOW_FIELDS_COUNT 4 // max number of cached flow fields kept when they are not used anymore
+#define NAVIGATION_FLOW_DIRECTION_NONE 0xFF
+
+// defines paths from all navigation graph nodes toward single goal node
+struct NavigationFlowField
+{
+public:
+    int mGoalNode = -1;
+    unsigned int mGraphVersion = 0; // navigation graph version at the moment of computation
+    unsigned int mLastUseFrame = 0; // fields used during current frame are never evicted
+    std::vector<float> mIntegrationField; // path cost to goal for each node, FLT_MAX if goal is unreachable
+    std::vector<unsigned char> mDirectionField; // direction index to next node for each node
+};
+
+// defines flow fields cache for mass pedestrians movement toward common goals,
+// field is computed once per goal so that each pedestrian reads single direction per update instead of searching path
+class NavigationFlowFields final: public cxx::noncopyable
+{
+public:
+    NavigationFlowFields(NavigationGraph& navigationGraph);
+
+    // free all cached flow fields
+    void Cleanup();
+
+    // start new frame, evicts fields which were not used during previous frame if there are too many of them
+    void UpdateFrame();
+
+    // get flow field toward goal, computes field if it is not cached or navigation graph was modified,
+    // returned field stays valid until next frame so each goal is computed at most once per frame,
+    // not thread safe, fields must be requested before parallel pedestrians update which only reads them
+    // @param goal: Goal world position
+    // @returns null if goal is not walkable
+    const NavigationFlowField* GetFlowField(const glm::vec3& goal);
+    const NavigationFlowField* GetFlowField(int goalNode);
+
+    // get movement direction at specific world position, may be used concurrently while fields are not requested
+    // @param flowField: Flow field
+    // @param position: World position
+    // @param outputDirection: Normalized direction toward next block in world x and z
+    // @returns false if position is not walkable, is goal or goal is unreachable
+    bool GetFlowDirection(const NavigationFlowField* flowField, const glm::vec3& position, glm::vec2& outputDirection) const;
+
+    // get path cost to goal at specific world position, FLT_MAX if goal is unreachable
+    // @param flowField: Flow field
+    // @param position: World position
+    float GetFlowCost(const NavigationFlowField* flowField, const glm::vec3& position) const;
+
+    // get index of current frame, increased on each update
+    inline unsigned int GetFrameIndex() const { return mFrameIndex; }
+
+private:
+    void ComputeFlowField(NavigationFlowField& flowField, int goalNode);
+
+private:
+    // open list entry
+    struct OpenNode
+    {
+    public:
+        float mCost;
+        int mNodeIndex;
+    };
+
+    NavigationGraph& mNavigationGraph;
+    std::vector<std::unique_ptr<NavigationFlowField>> mFlowFields; // may exceed max count while distinct goals are in use
+    unsigned int mFrameIndex;
+
+    std::vector<OpenNode> mOpenList; // binary heap
+};
\ No newline at end of file
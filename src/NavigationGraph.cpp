@@ -0,0 +1,541 @@
+#include "stdafx.h"
+#include "NavigationGraph.h"
+#include "GameMapManager.h"
+
+// get cost multiplier for pedestrian walking on specific ground, pedestrians prefer pavements
+inline float get_ground_walk_cost(eGroundType groundType)
+{
+    switch (groundType)
+    {
+        case eGroundType_Road: return 2.0f;
+        case eGroundType_Field: return 1.2f;
+        default: break;
+    }
+    return 1.0f;
+}
+
+inline int get_block_linear_index(int coordx, int coordy, int layer)
+{
+    return (layer * MAP_DIMENSIONS + coordy) * MAP_DIMENSIONS + coordx;
+}
+
+inline bool is_inside_area(int coordx, int coordy, const Rect2D& area)
+{
+    return coordx >= area.x && coordy >= area.y && coordx < area.x + area.w && coordy < area.y + area.h;
+}
+
+static const int NeighbourOffsets[NAVIGATION_DIRECTIONS_COUNT][2] = {
+    {-1, 0}, {1, 0}, {0, -1}, {0, 1}, // straight
+    {-1, -1}, {1, -1}, {-1, 1}, {1, 1}, // diagonals
+};
+
+static const float NeighbourDistances[NAVIGATION_DIRECTIONS_COUNT] = {
+    1.0f, 1.0f, 1.0f, 1.0f,
+    1.41421356f, 1.41421356f, 1.41421356f, 1.41421356f,
+};
+
+//////////////////////////////////////////////////////////////////////////
+
+NavigationGraph::NavigationGraph()
+    : mNodesCount()
+    , mLinksCount()
+    , mVersion()
+    , mQueryID()
+{
+    memset(mChunksVersions, 0, sizeof(mChunksVersions));
+}
+
+bool NavigationGraph::Build()
+{
+    Cleanup();
+
+    NavigationNode initialNode;
+    initialNode.mLinks = 0;
+    initialNode.mGroundType = eGroundType_Air;
+    initialNode.mWalkable = false;
+    mNodes.resize(NAVIGATION_NODES_COUNT, initialNode);
+
+    UpdateNodes(0, 0, MAP_DIMENSIONS - 1, MAP_DIMENSIONS - 1);
+    UpdateNodesLinks(0, 0, MAP_DIMENSIONS - 1, MAP_DIMENSIONS - 1);
+
+    for (int chunky = 0; chunky < MAP_CHUNKS_COUNT; ++chunky)
+    for (int chunkx = 0; chunkx < MAP_CHUNKS_COUNT; ++chunkx)
+    {
+        mChunksVersions[chunky][chunkx] = gGameMap.GetChunkVersion(chunkx, chunky);
+    }
+
+    // warm up query buffers
+    NodeQueryState initialState;
+    initialState.mQueryID = 0;
+    initialState.mParentNode = -1;
+    initialState.mCostFromStart = 0.0f;
+    initialState.mClosed = false;
+    mQueryStates.resize(NAVIGATION_NODES_COUNT, initialState);
+    mQueryOpenList.reserve(mNodesCount);
+    mQueryID = 0;
+
+    ++mVersion;
+
+    gConsole.LogMessage(eLogMessage_Debug, "Navigation graph built: %d nodes, %d links", GetNodesCount(), GetLinksCount());
+    return true;
+}
+
+void NavigationGraph::Cleanup()
+{
+    mNodes.clear();
+    mQueryStates.clear();
+    mQueryOpenList.clear();
+    mNodesCount = 0;
+    mLinksCount = 0;
+    ++mVersion;
+}
+
+bool NavigationGraph::IsBuilt() const
+{
+    return !mNodes.empty();
+}
+
+int NavigationGraph::UpdateModifiedChunks()
+{
+    if (!IsBuilt())
+        return 0;
+
+    // walkability of all modified blocks must be known before links are computed
+    int numModifiedChunks = 0;
+    bool modifiedChunks[MAP_CHUNKS_COUNT][MAP_CHUNKS_COUNT] = {};
+    for (int chunky = 0; chunky < MAP_CHUNKS_COUNT; ++chunky)
+    for (int chunkx = 0; chunkx < MAP_CHUNKS_COUNT; ++chunkx)
+    {
+        unsigned int chunkVersion = gGameMap.GetChunkVersion(chunkx, chunky);
+        if (mChunksVersions[chunky][chunkx] == chunkVersion)
+            continue;
+
+        mChunksVersions[chunky][chunkx] = chunkVersion;
+        modifiedChunks[chunky][chunkx] = true;
+        ++numModifiedChunks;
+
+        const int minx = chunkx * MAP_CHUNK_DIMENSIONS;
+        const int miny = chunky * MAP_CHUNK_DIMENSIONS;
+        UpdateNodes(minx, miny, minx + MAP_CHUNK_DIMENSIONS - 1, miny + MAP_CHUNK_DIMENSIONS - 1);
+    }
+
+    if (numModifiedChunks == 0)
+        return 0;
+
+    // links of neighbour blocks along chunk borders are also affected
+    for (int chunky = 0; chunky < MAP_CHUNKS_COUNT; ++chunky)
+    for (int chunkx = 0; chunkx < MAP_CHUNKS_COUNT; ++chunkx)
+    {
+        if (!modifiedChunks[chunky][chunkx])
+            continue;
+
+        const int minx = chunkx * MAP_CHUNK_DIMENSIONS;
+        const int miny = chunky * MAP_CHUNK_DIMENSIONS;
+        UpdateNodesLinks(
+            glm::max(minx - 1, 0),
+            glm::max(miny - 1, 0),
+            glm::min(minx + MAP_CHUNK_DIMENSIONS, MAP_DIMENSIONS - 1),
+            glm::min(miny + MAP_CHUNK_DIMENSIONS, MAP_DIMENSIONS - 1));
+    }
+    ++mVersion;
+    return numModifiedChunks;
+}
+
+void NavigationGraph::UpdateNodes(int minx, int miny, int maxx, int maxy)
+{
+    for (int layer = 0; layer < MAP_LAYERS_COUNT; ++layer)
+    for (int coordy = miny; coordy <= maxy; ++coordy)
+    for (int coordx = minx; coordx <= maxx; ++coordx)
+    {
+        NavigationNode& node = mNodes[get_block_linear_index(coordx, coordy, layer)];
+        const bool isWalkable = IsWalkableBlock(coordx, coordy, layer);
+        if (node.mWalkable != isWalkable)
+        {
+            mNodesCount += isWalkable ? 1 : -1;
+        }
+        node.mWalkable = isWalkable;
+        node.mGroundType = gGameMap.GetBlock(coordx, coordy, layer)->mGroundType;
+    }
+}
+
+void NavigationGraph::UpdateNodesLinks(int minx, int miny, int maxx, int maxy)
+{
+    for (int layer = 0; layer < MAP_LAYERS_COUNT; ++layer)
+    for (int coordy = miny; coordy <= maxy; ++coordy)
+    for (int coordx = minx; coordx <= maxx; ++coordx)
+    {
+        NavigationNode& node = mNodes[get_block_linear_index(coordx, coordy, layer)];
+        unsigned short nodeLinks = node.mWalkable ? ComputeNodeLinks(coordx, coordy, layer) : 0;
+        for (int idirection = 0; idirection < NAVIGATION_DIRECTIONS_COUNT; ++idirection)
+        {
+            if ((node.mLinks >> (idirection * 2)) & 3) --mLinksCount;
+            if ((nodeLinks >> (idirection * 2)) & 3) ++mLinksCount;
+        }
+        node.mLinks = nodeLinks;
+    }
+}
+
+bool NavigationGraph::IsWalkableBlock(int coordx, int coordy, int layer) const
+{
+    BlockStyle* blockData = gGameMap.GetBlock(coordx, coordy, layer);
+    if (blockData->mSlopeType == 0)
+    {
+        if (blockData->mGroundType != eGroundType_Road && blockData->mGroundType != eGroundType_Pawement &&
+            blockData->mGroundType != eGroundType_Field)
+        {
+            return false;
+        }
+    }
+    else if (blockData->mGroundType == eGroundType_Building)
+    {
+        return false;
+    }
+
+    // need some free space above
+    if (layer + 1 < MAP_LAYERS_COUNT)
+    {
+        BlockStyle* aboveBlockData = gGameMap.GetBlock(coordx, coordy, layer + 1);
+        if (aboveBlockData->mGroundType == eGroundType_Building && aboveBlockData->mSlopeType == 0)
+            return false;
+    }
+    return true;
+}
+
+unsigned short NavigationGraph::ComputeNodeLinks(int coordx, int coordy, int layer) const
+{
+    const bool isSlope = gGameMap.GetBlock(coordx, coordy, layer)->mSlopeType > 0;
+
+    unsigned short nodeLinks = 0;
+    for (int idirection = 0; idirection < NAVIGATION_DIRECTIONS_COUNT; ++idirection)
+    {
+        const int offsetx = NeighbourOffsets[idirection][0];
+        const int offsety = NeighbourOffsets[idirection][1];
+        const int targetx = coordx + offsetx;
+        const int targety = coordy + offsety;
+        if (targetx < 0 || targetx >= MAP_DIMENSIONS || targety < 0 || targety >= MAP_DIMENSIONS)
+            continue;
+
+        int targetLayer = -1;
+        const bool isDiagonal = (offsetx != 0 && offsety != 0);
+        if (isDiagonal)
+        {
+            // diagonal moves are allowed on same layer only and cannot cut corners
+            if (FindNode(coordx + offsetx, coordy, layer) == -1 ||
+                FindNode(coordx, coordy + offsety, layer) == -1)
+            {
+                continue;
+            }
+            if (FindNode(targetx, targety, layer) != -1)
+            {
+                targetLayer = layer;
+            }
+        }
+        else
+        {
+            if (FindNode(targetx, targety, layer) != -1)
+            {
+                targetLayer = layer;
+            }
+            // slopes connect adjacent layers
+            for (int layerOffset = -1; layerOffset < 2 && targetLayer == -1; layerOffset += 2)
+            {
+                int candidateLayer = layer + layerOffset;
+                if (FindNode(targetx, targety, candidateLayer) == -1)
+                    continue;
+
+                if (isSlope || gGameMap.GetBlock(targetx, targety, candidateLayer)->mSlopeType > 0)
+                {
+                    targetLayer = candidateLayer;
+                }
+            }
+        }
+
+        if (targetLayer == -1)
+            continue;
+
+        nodeLinks |= (targetLayer - layer + 2) << (idirection * 2);
+    }
+    return nodeLinks;
+}
+
+int NavigationGraph::GetLinkedNode(int nodeIndex, int direction, float& linkCost) const
+{
+    debug_assert(nodeIndex > -1 && nodeIndex < NAVIGATION_NODES_COUNT);
+    debug_assert(direction > -1 && direction < NAVIGATION_DIRECTIONS_COUNT);
+
+    const NavigationNode& node = mNodes[nodeIndex];
+    const int layerOffset = (node.mLinks >> (direction * 2)) & 3;
+    if (layerOffset == 0)
+        return -1;
+
+    const int targetNode = nodeIndex +
+        (layerOffset - 2) * MAP_DIMENSIONS * MAP_DIMENSIONS +
+        NeighbourOffsets[direction][1] * MAP_DIMENSIONS +
+        NeighbourOffsets[direction][0];
+
+    // cost is symmetric so that paths found in both directions are same
+    linkCost = NeighbourDistances[direction] * MAP_BLOCK_LENGTH * 0.5f *
+        (get_ground_walk_cost(node.mGroundType) + get_ground_walk_cost(mNodes[targetNode].mGroundType));
+    return targetNode;
+}
+
+void NavigationGraph::GetDirectionOffset(int direction, int& offsetx, int& offsety)
+{
+    debug_assert(direction > -1 && direction < NAVIGATION_DIRECTIONS_COUNT);
+
+    offsetx = NeighbourOffsets[direction][0];
+    offsety = NeighbourOffsets[direction][1];
+}
+
+int NavigationGraph::GetOppositeDirection(int direction)
+{
+    debug_assert(direction > -1 && direction < NAVIGATION_DIRECTIONS_COUNT);
+
+    static const int OppositeDirections[NAVIGATION_DIRECTIONS_COUNT] = { 1, 0, 3, 2, 7, 6, 5, 4 };
+    return OppositeDirections[direction];
+}
+
+int NavigationGraph::FindNode(int coordx, int coordy, int layer) const
+{
+    if (coordx < 0 || coordx >= MAP_DIMENSIONS || coordy < 0 || coordy >= MAP_DIMENSIONS ||
+        layer < 0 || layer >= MAP_LAYERS_COUNT || mNodes.empty())
+    {
+        return -1;
+    }
+    int nodeIndex = get_block_linear_index(coordx, coordy, layer);
+    return mNodes[nodeIndex].mWalkable ? nodeIndex : -1;
+}
+
+int NavigationGraph::FindNode(const glm::vec3& position) const
+{
+    int coordx = (int) position.x;
+    int coordy = (int) position.z;
+    int layer = (int) (position.y + 0.5f);
+
+    // objects standing on slopes may be slightly above or below its layer
+    int nodeIndex = FindNode(coordx, coordy, layer);
+    if (nodeIndex == -1)
+    {
+        nodeIndex = FindNode(coordx, coordy, layer - 1);
+    }
+    if (nodeIndex == -1)
+    {
+        nodeIndex = FindNode(coordx, coordy, layer + 1);
+    }
+    return nodeIndex;
+}
+
+void NavigationGraph::GetNodeLocation(int nodeIndex, int& coordx, int& coordy, int& layer)
+{
+    debug_assert(nodeIndex > -1 && nodeIndex < NAVIGATION_NODES_COUNT);
+
+    coordx = nodeIndex % MAP_DIMENSIONS;
+    coordy = (nodeIndex / MAP_DIMENSIONS) % MAP_DIMENSIONS;
+    layer = nodeIndex / (MAP_DIMENSIONS * MAP_DIMENSIONS);
+}
+
+glm::vec3 NavigationGraph::GetNodePosition(int nodeIndex) const
+{
+    int coordx;
+    int coordy;
+    int layer;
+    GetNodeLocation(nodeIndex, coordx, coordy, layer);
+
+    glm::vec3 position (
+        (coordx + 0.5f) * MAP_BLOCK_LENGTH,
+        layer * MAP_BLOCK_LENGTH,
+        (coordy + 0.5f) * MAP_BLOCK_LENGTH);
+
+    position.y = gGameMap.GetHeightAtPosition(position);
+    return position;
+}
+
+bool NavigationGraph::FindPath(const glm::vec3& start, const glm::vec3& goal, std::vector<glm::vec3>& outputPath)
+{
+    int startNode = FindNode(start);
+    int goalNode = FindNode(goal);
+    if (startNode == -1 || goalNode == -1)
+        return false;
+
+    return FindPath(startNode, goalNode, outputPath);
+}
+
+bool NavigationGraph::FindPath(int startNode, int goalNode, std::vector<glm::vec3>& outputPath)
+{
+    const Rect2D wholeMapArea (0, 0, MAP_DIMENSIONS, MAP_DIMENSIONS);
+    return FindPathInArea(startNode, goalNode, wholeMapArea, outputPath);
+}
+
+bool NavigationGraph::FindPathInArea(int startNode, int goalNode, const Rect2D& searchArea, std::vector<glm::vec3>& outputPath)
+{
+    debug_assert(startNode > -1 && startNode < NAVIGATION_NODES_COUNT);
+    debug_assert(goalNode > -1 && goalNode < NAVIGATION_NODES_COUNT);
+
+    if (startNode == goalNode)
+        return true;
+
+    if (!SearchPaths(startNode, goalNode, searchArea, nullptr, 0))
+        return false;
+
+    CollectPath(startNode, goalNode, outputPath);
+    return true;
+}
+
+int NavigationGraph::ComputePathCosts(int startNode, const Rect2D& searchArea, const int* targetNodes, int numTargets, float* outputCosts)
+{
+    debug_assert(startNode > -1 && startNode < NAVIGATION_NODES_COUNT);
+    debug_assert(targetNodes && outputCosts);
+
+    SearchPaths(startNode, -1, searchArea, targetNodes, numTargets);
+
+    int numReachable = 0;
+    for (int itarget = 0; itarget < numTargets; ++itarget)
+    {
+        const NodeQueryState& targetState = mQueryStates[targetNodes[itarget]];
+        if (targetState.mQueryID == mQueryID && targetState.mClosed)
+        {
+            outputCosts[itarget] = targetState.mCostFromStart;
+            ++numReachable;
+        }
+        else
+        {
+            outputCosts[itarget] = std::numeric_limits<float>::max();
+        }
+    }
+    return numReachable;
+}
+
+bool NavigationGraph::SearchPaths(int startNode, int goalNode, const Rect2D& searchArea, const int* targetNodes, int numTargets)
+{
+    // start new query, previous query states become invalid
+    if (++mQueryID == 0)
+    {
+        for (NodeQueryState& currState: mQueryStates)
+        {
+            currState.mQueryID = 0;
+        }
+        mQueryID = 1;
+    }
+
+    auto compare_open_nodes = [](const OpenNode& lhs, const OpenNode& rhs)
+    {
+        return lhs.mEstimatedCost > rhs.mEstimatedCost;
+    };
+
+    // without goal node search degrades to dijkstra
+    int goalx = 0;
+    int goaly = 0;
+    int goalLayer = 0;
+    if (goalNode != -1)
+    {
+        GetNodeLocation(goalNode, goalx, goaly, goalLayer);
+    }
+    auto estimate_cost = [goalNode, goalx, goaly](int coordx, int coordy)
+    {
+        if (goalNode == -1)
+            return 0.0f;
+
+        float dx = (1.0f * coordx - goalx);
+        float dy = (1.0f * coordy - goaly);
+        return sqrtf(dx * dx + dy * dy) * MAP_BLOCK_LENGTH;
+    };
+
+    // targets of multiple paths query are marked in advance
+    int numTargetsRemaining = 0;
+    for (int itarget = 0; itarget < numTargets; ++itarget)
+    {
+        NodeQueryState& targetState = mQueryStates[targetNodes[itarget]];
+        if (targetState.mQueryID == mQueryID) // duplicate
+            continue;
+
+        targetState.mQueryID = mQueryID;
+        targetState.mParentNode = -1;
+        targetState.mCostFromStart = std::numeric_limits<float>::max();
+        targetState.mClosed = false;
+        ++numTargetsRemaining;
+    }
+
+    mQueryOpenList.clear();
+
+    NodeQueryState& startState = mQueryStates[startNode];
+    startState.mQueryID = mQueryID;
+    startState.mParentNode = -1;
+    startState.mCostFromStart = 0.0f;
+    startState.mClosed = false;
+
+    int startx;
+    int starty;
+    int startLayer;
+    GetNodeLocation(startNode, startx, starty, startLayer);
+    mQueryOpenList.push_back({estimate_cost(startx, starty), startNode});
+
+    while (!mQueryOpenList.empty())
+    {
+        std::pop_heap(mQueryOpenList.begin(), mQueryOpenList.end(), compare_open_nodes);
+        int currNode = mQueryOpenList.back().mNodeIndex;
+        mQueryOpenList.pop_back();
+
+        NodeQueryState& currState = mQueryStates[currNode];
+        if (currState.mClosed) // outdated open list entry
+            continue;
+
+        currState.mClosed = true;
+        if (currNode == goalNode)
+            return true;
+
+        if (goalNode == -1 && numTargets > 0)
+        {
+            bool isTarget = std::find(targetNodes, targetNodes + numTargets, currNode) != targetNodes + numTargets;
+            if (isTarget && --numTargetsRemaining == 0)
+                return true;
+        }
+
+        for (int idirection = 0; idirection < NAVIGATION_DIRECTIONS_COUNT; ++idirection)
+        {
+            float linkCost;
+            int targetNode = GetLinkedNode(currNode, idirection, linkCost);
+            if (targetNode == -1)
+                continue;
+
+            int targetx;
+            int targety;
+            int targetLayer;
+            GetNodeLocation(targetNode, targetx, targety, targetLayer);
+            if (!is_inside_area(targetx, targety, searchArea))
+                continue;
+
+            NodeQueryState& targetState = mQueryStates[targetNode];
+            if (targetState.mQueryID != mQueryID)
+            {
+                targetState.mQueryID = mQueryID;
+                targetState.mParentNode = -1;
+                targetState.mCostFromStart = std::numeric_limits<float>::max();
+                targetState.mClosed = false;
+            }
+
+            if (targetState.mClosed)
+                continue;
+
+            float costFromStart = currState.mCostFromStart + linkCost;
+            if (costFromStart >= targetState.mCostFromStart)
+                continue;
+
+            targetState.mCostFromStart = costFromStart;
+            targetState.mParentNode = currNode;
+            mQueryOpenList.push_back({costFromStart + estimate_cost(targetx, targety), targetNode});
+            std::push_heap(mQueryOpenList.begin(), mQueryOpenList.end(), compare_open_nodes);
+        }
+    }
+    return (goalNode == -1);
+}
+
+void NavigationGraph::CollectPath(int startNode, int goalNode, std::vector<glm::vec3>& outputPath) const
+{
+    // collect waypoints from goal to start
+    size_t pathStart = outputPath.size();
+    for (int pathNode = goalNode; pathNode != startNode; pathNode = mQueryStates[pathNode].mParentNode)
+    {
+        outputPath.push_back(GetNodePosition(pathNode));
+    }
+    std::reverse(outputPath.begin() + pathStart, outputPath.end());
+}
@@ -0,0 +1,155 @@
+#pragma once
+
+#include "GameDefs.h"
+
+#define NAVIGATION_NODES_COUNT (MAP_DIMENSIONS * MAP_DIMENSIONS * MAP_LAYERS_COUNT)
+#define NAVIGATION_DIRECTIONS_COUNT 8 // 4 straight directions followed by 4 diagonals
+
+// navigation data of map block, node index is linear block index: (layer * MAP_DIMENSIONS + y) * MAP_DIMENSIONS + x
+struct NavigationNode
+{
+public:
+    unsigned short mLinks; // 2 bits per direction: 0 = no link, otherwise target layer offset + 2
+    eGroundType mGroundType;
+    bool mWalkable;
+};
+
+// defines pedestrians navigation graph compiled from map blocks data
+// nodes are walkable blocks (roads, pavements and fields), links connect neighbour blocks including diagonals,
+// slopes connect adjacent layers
+class NavigationGraph final: public cxx::noncopyable
+{
+public:
+    NavigationGraph();
+
+    // compile graph from currently loaded map data
+    bool Build();
+
+    // free graph data
+    void Cleanup();
+
+    // recompile graph for map chunks which were modified since last update
+    // @returns number of updated chunks
+    int UpdateModifiedChunks();
+
+    // find node at specific map location, returns -1 if there is no walkable node
+    // @param position: World position
+    int FindNode(const glm::vec3& position) const;
+    int FindNode(int coordx, int coordy, int layer) const;
+
+    // get neighbour node in specified direction
+    // @param nodeIndex: Source node index
+    // @param direction: Direction index, see NAVIGATION_DIRECTIONS_COUNT
+    // @param linkCost: Output cost of moving to neighbour node
+    // @returns -1 if there is no link in that direction
+    int GetLinkedNode(int nodeIndex, int direction, float& linkCost) const;
+
+    // get map offset to neighbour block in specified direction
+    // @param direction: Direction index, see NAVIGATION_DIRECTIONS_COUNT
+    // @param offsetx, offsety: Output offset
+    static void GetDirectionOffset(int direction, int& offsetx, int& offsety);
+
+    // get direction index pointing backwards
+    // @param direction: Direction index, see NAVIGATION_DIRECTIONS_COUNT
+    static int GetOppositeDirection(int direction);
+
+    // find path between two world points using A*, waypoints are appended to output list,
+    // does not allocate memory per query once internal buffers and output list are warmed up
+    // note that it is not thread safe since query buffers are shared
+    // @param start: Start world position
+    // @param goal: Destination world position
+    // @param outputPath: Path waypoints excluding start node
+    // @returns false if there is no path
+    bool FindPath(const glm::vec3& start, const glm::vec3& goal, std::vector<glm::vec3>& outputPath);
+    bool FindPath(int startNode, int goalNode, std::vector<glm::vec3>& outputPath);
+
+    // find path between two nodes which does not leave specified map area
+    // @param startNode, goalNode: Path end points, should be within search area
+    // @param searchArea: Map area in blocks
+    // @param outputPath: Path waypoints excluding start node
+    // @returns false if there is no path
+    bool FindPathInArea(int startNode, int goalNode, const Rect2D& searchArea, std::vector<glm::vec3>& outputPath);
+
+    // compute costs of shortest paths from start node to multiple target nodes within specified map area
+    // @param startNode: Start node, should be within search area
+    // @param searchArea: Map area in blocks
+    // @param targetNodes: Target nodes
+    // @param numTargets: Number of target nodes
+    // @param outputCosts: Output path costs, FLT_MAX for unreachable targets
+    // @returns number of reachable targets
+    int ComputePathCosts(int startNode, const Rect2D& searchArea, const int* targetNodes, int numTargets, float* outputCosts);
+
+    // get node data
+    // @param nodeIndex: Node index
+    inline const NavigationNode& GetNode(int nodeIndex) const
+    {
+        debug_assert(nodeIndex > -1 && nodeIndex < (int) mNodes.size());
+        return mNodes[nodeIndex];
+    }
+
+    // get world position of node center
+    // @param nodeIndex: Node index
+    glm::vec3 GetNodePosition(int nodeIndex) const;
+
+    // get map location of node
+    // @param nodeIndex: Node index
+    // @param coordx, coordy, layer: Output location
+    static void GetNodeLocation(int nodeIndex, int& coordx, int& coordy, int& layer);
+
+    // get graph stats
+    inline int GetNodesCount() const { return mNodesCount; }
+    inline int GetLinksCount() const { return mLinksCount; }
+
+    // get graph version, incremented each time graph is rebuilt or modified
+    inline unsigned int GetVersion() const { return mVersion; }
+
+    // get map chunk version which graph was last updated for
+    // @param chunkx, chunky: Map chunk coordinate
+    inline unsigned int GetChunkVersion(int chunkx, int chunky) const { return mChunksVersions[chunky][chunkx]; }
+
+    // test whether graph is built
+    bool IsBuilt() const;
+
+private:
+    bool IsWalkableBlock(int coordx, int coordy, int layer) const;
+
+    // recompute nodes walkability and links in map area
+    void UpdateNodes(int minx, int miny, int maxx, int maxy);
+    void UpdateNodesLinks(int minx, int miny, int maxx, int maxy);
+    unsigned short ComputeNodeLinks(int coordx, int coordy, int layer) const;
+
+    // shared search implementation
+    // @param goalNode: Goal node or -1 to search for all targets
+    bool SearchPaths(int startNode, int goalNode, const Rect2D& searchArea, const int* targetNodes, int numTargets);
+    void CollectPath(int startNode, int goalNode, std::vector<glm::vec3>& outputPath) const;
+
+private:
+    // open list entry
+    struct OpenNode
+    {
+    public:
+        float mEstimatedCost;
+        int mNodeIndex;
+    };
+
+    // per node query state, reused between queries
+    struct NodeQueryState
+    {
+    public:
+        unsigned int mQueryID; // state is valid only if matches current query
+        int mParentNode;
+        float mCostFromStart;
+        bool mClosed;
+    };
+
+    std::vector<NavigationNode> mNodes; // all map blocks
+    int mNodesCount;
+    int mLinksCount;
+    unsigned int mVersion;
+    unsigned int mChunksVersions[MAP_CHUNKS_COUNT][MAP_CHUNKS_COUNT]; // y, x
+
+    // query buffers
+    std::vector<NodeQueryState> mQueryStates;
+    std::vector<OpenNode> mQueryOpenList; // binary heap
+    unsigned int mQueryID;
+};
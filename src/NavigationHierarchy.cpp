@@ -0,0 +1,565 @@
+#include "stdafx.h"
+#include "NavigationHierarchy.h"
+#include "GameMapManager.h"
+
+#define NAVIGATION_CLUSTER_DIMENSIONS MAP_CHUNK_DIMENSIONS
+#define NAVIGATION_ABSTRACT_STATES_COUNT (NAVIGATION_CLUSTERS_COUNT * NAVIGATION_CLUSTERS_COUNT * NAVIGATION_CLUSTER_MAX_ENTRANCES)
+
+// special abstract search states
+enum
+{
+    AbstractState_Goal = NAVIGATION_ABSTRACT_STATES_COUNT,
+    AbstractState_Start,
+    AbstractState_COUNT,
+};
+
+// graph direction indices of straight links crossing cluster borders
+enum
+{
+    NavigationDirection_East = 1,
+    NavigationDirection_South = 3,
+};
+
+inline int get_cached_path_index(int startNode, int goalNode)
+{
+    unsigned int hash = (unsigned int) startNode * 2654435761u ^ (unsigned int) goalNode * 40503u;
+    return (int) ((hash >> 8) % NAVIGATION_CACHED_PATHS_COUNT);
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+NavigationHierarchy::NavigationHierarchy(NavigationGraph& navigationGraph)
+    : mNavigationGraph(navigationGraph)
+    , mGraphVersion()
+    , mVersion()
+    , mEntrancesCount()
+    , mIsBuilt()
+    , mCachedPathsHits()
+    , mQueryID()
+{
+    memset(mChunksVersions, 0, sizeof(mChunksVersions));
+}
+
+bool NavigationHierarchy::Build()
+{
+    Cleanup();
+
+    if (!mNavigationGraph.IsBuilt())
+        return false;
+
+    bool dirtyClusters[NAVIGATION_CLUSTERS_COUNT][NAVIGATION_CLUSTERS_COUNT];
+    for (int clustery = 0; clustery < NAVIGATION_CLUSTERS_COUNT; ++clustery)
+    for (int clusterx = 0; clusterx < NAVIGATION_CLUSTERS_COUNT; ++clusterx)
+    {
+        dirtyClusters[clustery][clusterx] = true;
+        mChunksVersions[clustery][clusterx] = mNavigationGraph.GetChunkVersion(clusterx, clustery);
+    }
+    mGraphVersion = mNavigationGraph.GetVersion();
+    BuildClusters(dirtyClusters);
+
+    // warm up query buffers
+    EntranceQueryState initialState;
+    initialState.mQueryID = 0;
+    initialState.mParentState = -1;
+    initialState.mCostFromStart = 0.0f;
+    initialState.mClosed = false;
+    mQueryStates.resize(AbstractState_COUNT, initialState);
+    mQueryOpenList.reserve(mEntrancesCount + 1);
+    mQueryTargetNodes.reserve(NAVIGATION_CLUSTER_MAX_ENTRANCES);
+    mQueryStartCosts.resize(NAVIGATION_CLUSTER_MAX_ENTRANCES);
+    mQueryGoalCosts.resize(NAVIGATION_CLUSTER_MAX_ENTRANCES);
+    mQueryID = 0;
+    mIsBuilt = true;
+
+    gConsole.LogMessage(eLogMessage_Debug, "Navigation hierarchy built: %d clusters, %d entrances",
+        NAVIGATION_CLUSTERS_COUNT * NAVIGATION_CLUSTERS_COUNT, mEntrancesCount);
+    return true;
+}
+
+void NavigationHierarchy::Cleanup()
+{
+    for (NavigationCluster& currCluster: mClusters)
+    {
+        currCluster.mEntrances.clear();
+        currCluster.mEntrancesCosts.clear();
+    }
+    for (CachedPath& currPath: mCachedPaths)
+    {
+        currPath.mStartNode = -1;
+        currPath.mGoalNode = -1;
+        currPath.mNodes.clear();
+    }
+    mQueryStates.clear();
+    mQueryOpenList.clear();
+    mEntrancesCount = 0;
+    mCachedPathsHits = 0;
+    mIsBuilt = false;
+    ++mVersion;
+}
+
+bool NavigationHierarchy::IsBuilt() const
+{
+    return mIsBuilt;
+}
+
+int NavigationHierarchy::UpdateModifiedClusters()
+{
+    if (!IsBuilt())
+        return 0;
+
+    if (mGraphVersion == mNavigationGraph.GetVersion())
+        return 0;
+
+    mGraphVersion = mNavigationGraph.GetVersion();
+
+    // entrances on borders of modified cluster are shared with its neighbours
+    bool dirtyClusters[NAVIGATION_CLUSTERS_COUNT][NAVIGATION_CLUSTERS_COUNT] = {};
+    int numDirtyClusters = 0;
+    for (int clustery = 0; clustery < NAVIGATION_CLUSTERS_COUNT; ++clustery)
+    for (int clusterx = 0; clusterx < NAVIGATION_CLUSTERS_COUNT; ++clusterx)
+    {
+        unsigned int chunkVersion = mNavigationGraph.GetChunkVersion(clusterx, clustery);
+        if (mChunksVersions[clustery][clusterx] == chunkVersion)
+            continue;
+
+        mChunksVersions[clustery][clusterx] = chunkVersion;
+
+        static const int DirtyOffsets[5][2] = { {0, 0}, {-1, 0}, {1, 0}, {0, -1}, {0, 1} };
+        for (const auto& currOffset: DirtyOffsets)
+        {
+            int dirtyx = clusterx + currOffset[0];
+            int dirtyy = clustery + currOffset[1];
+            if (dirtyx < 0 || dirtyx >= NAVIGATION_CLUSTERS_COUNT || dirtyy < 0 || dirtyy >= NAVIGATION_CLUSTERS_COUNT)
+                continue;
+
+            if (!dirtyClusters[dirtyy][dirtyx])
+            {
+                dirtyClusters[dirtyy][dirtyx] = true;
+                ++numDirtyClusters;
+            }
+        }
+    }
+
+    if (numDirtyClusters > 0)
+    {
+        BuildClusters(dirtyClusters);
+    }
+    return numDirtyClusters;
+}
+
+void NavigationHierarchy::BuildClusters(const bool dirtyClusters[NAVIGATION_CLUSTERS_COUNT][NAVIGATION_CLUSTERS_COUNT])
+{
+    for (int clustery = 0; clustery < NAVIGATION_CLUSTERS_COUNT; ++clustery)
+    for (int clusterx = 0; clusterx < NAVIGATION_CLUSTERS_COUNT; ++clusterx)
+    {
+        if (dirtyClusters[clustery][clusterx])
+        {
+            BuildClusterEntrances(clusterx, clustery);
+            BuildClusterCosts(clusterx, clustery);
+        }
+    }
+
+    // entrance indices of rebuilt clusters are changed so neighbours links must be updated as well
+    for (int clustery = 0; clustery < NAVIGATION_CLUSTERS_COUNT; ++clustery)
+    for (int clusterx = 0; clusterx < NAVIGATION_CLUSTERS_COUNT; ++clusterx)
+    {
+        if (dirtyClusters[clustery][clusterx] ||
+            (clusterx > 0 && dirtyClusters[clustery][clusterx - 1]) ||
+            (clustery > 0 && dirtyClusters[clustery - 1][clusterx]) ||
+            (clusterx < NAVIGATION_CLUSTERS_COUNT - 1 && dirtyClusters[clustery][clusterx + 1]) ||
+            (clustery < NAVIGATION_CLUSTERS_COUNT - 1 && dirtyClusters[clustery + 1][clusterx]))
+        {
+            LinkClusterEntrances(clusterx, clustery);
+        }
+    }
+
+    mEntrancesCount = 0;
+    for (const NavigationCluster& currCluster: mClusters)
+    {
+        mEntrancesCount += (int) currCluster.mEntrances.size();
+    }
+    // cached paths become invalid
+    ++mVersion;
+}
+
+void NavigationHierarchy::CollectBorderLinks(int clusterx, int clustery, bool southBorder, std::vector<NavigationEntrance>& outputLinks) const
+{
+    const int direction = southBorder ? NavigationDirection_South : NavigationDirection_East;
+    const int borderx = southBorder ? (clusterx * NAVIGATION_CLUSTER_DIMENSIONS) : ((clusterx + 1) * NAVIGATION_CLUSTER_DIMENSIONS - 1);
+    const int bordery = southBorder ? ((clustery + 1) * NAVIGATION_CLUSTER_DIMENSIONS - 1) : (clustery * NAVIGATION_CLUSTER_DIMENSIONS);
+    if (borderx >= MAP_DIMENSIONS - 1 && !southBorder)
+        return;
+    if (bordery >= MAP_DIMENSIONS - 1 && southBorder)
+        return;
+
+    // single entrance is placed in the middle of each run of border crossing links
+    for (int layer = 0; layer < MAP_LAYERS_COUNT; ++layer)
+    {
+        int runStart = -1;
+        int runTargetOffset = 0;
+        for (int iblock = 0; iblock <= NAVIGATION_CLUSTER_DIMENSIONS; ++iblock)
+        {
+            int targetOffset = 0;
+            if (iblock < NAVIGATION_CLUSTER_DIMENSIONS)
+            {
+                int coordx = southBorder ? (borderx + iblock) : borderx;
+                int coordy = southBorder ? bordery : (bordery + iblock);
+                int nodeIndex = mNavigationGraph.FindNode(coordx, coordy, layer);
+                float linkCost;
+                int targetNode = (nodeIndex == -1) ? -1 : mNavigationGraph.GetLinkedNode(nodeIndex, direction, linkCost);
+                if (targetNode != -1)
+                {
+                    targetOffset = targetNode - nodeIndex;
+                }
+            }
+
+            if (runStart != -1 && targetOffset != runTargetOffset)
+            {
+                int middleBlock = (runStart + iblock - 1) / 2;
+                int coordx = southBorder ? (borderx + middleBlock) : borderx;
+                int coordy = southBorder ? bordery : (bordery + middleBlock);
+                NavigationEntrance borderLink;
+                borderLink.mNodeIndex = mNavigationGraph.FindNode(coordx, coordy, layer);
+                borderLink.mLinkedNode = mNavigationGraph.GetLinkedNode(borderLink.mNodeIndex, direction, borderLink.mLinkCost);
+                borderLink.mLinkedEntrance = -1;
+                outputLinks.push_back(borderLink);
+                runStart = -1;
+            }
+
+            if (runStart == -1 && targetOffset != 0)
+            {
+                runStart = iblock;
+                runTargetOffset = targetOffset;
+            }
+        }
+    }
+}
+
+void NavigationHierarchy::BuildClusterEntrances(int clusterx, int clustery)
+{
+    NavigationCluster& cluster = mClusters[clustery * NAVIGATION_CLUSTERS_COUNT + clusterx];
+    cluster.mEntrances.clear();
+
+    // borders are always scanned from west or north cluster so both sides get same entrances
+    std::vector<NavigationEntrance> borderLinks;
+    CollectBorderLinks(clusterx, clustery, false, borderLinks);
+    CollectBorderLinks(clusterx, clustery, true, borderLinks);
+    size_t numOwnBorderLinks = borderLinks.size();
+    if (clusterx > 0)
+    {
+        CollectBorderLinks(clusterx - 1, clustery, false, borderLinks);
+    }
+    if (clustery > 0)
+    {
+        CollectBorderLinks(clusterx, clustery - 1, true, borderLinks);
+    }
+
+    for (size_t ilink = 0; ilink < borderLinks.size(); ++ilink)
+    {
+        if (cluster.mEntrances.size() == NAVIGATION_CLUSTER_MAX_ENTRANCES)
+        {
+            gConsole.LogMessage(eLogMessage_Warning, "Navigation cluster (%d, %d) entrances limit reached", clusterx, clustery);
+            break;
+        }
+
+        NavigationEntrance entrance = borderLinks[ilink];
+        if (ilink >= numOwnBorderLinks) // link found from neighbour side
+        {
+            std::swap(entrance.mNodeIndex, entrance.mLinkedNode);
+        }
+        cluster.mEntrances.push_back(entrance);
+    }
+}
+
+void NavigationHierarchy::BuildClusterCosts(int clusterx, int clustery)
+{
+    const int clusterIndex = clustery * NAVIGATION_CLUSTERS_COUNT + clusterx;
+    const Rect2D clusterArea = GetClusterArea(clusterIndex);
+
+    NavigationCluster& cluster = mClusters[clusterIndex];
+    const int numEntrances = (int) cluster.mEntrances.size();
+
+    std::vector<int> entrancesNodes;
+    entrancesNodes.reserve(numEntrances);
+    for (const NavigationEntrance& currEntrance: cluster.mEntrances)
+    {
+        entrancesNodes.push_back(currEntrance.mNodeIndex);
+    }
+
+    cluster.mEntrancesCosts.resize(numEntrances * numEntrances);
+    for (int ientrance = 0; ientrance < numEntrances; ++ientrance)
+    {
+        mNavigationGraph.ComputePathCosts(entrancesNodes[ientrance], clusterArea, entrancesNodes.data(), numEntrances,
+            cluster.mEntrancesCosts.data() + ientrance * numEntrances);
+    }
+}
+
+void NavigationHierarchy::LinkClusterEntrances(int clusterx, int clustery)
+{
+    NavigationCluster& cluster = mClusters[clustery * NAVIGATION_CLUSTERS_COUNT + clusterx];
+    for (NavigationEntrance& currEntrance: cluster.mEntrances)
+    {
+        int linkedCluster = GetNodeCluster(currEntrance.mLinkedNode);
+        int linkedEntrance = FindClusterEntrance(linkedCluster, currEntrance.mLinkedNode);
+        // neighbour entrance may be missing if its cluster is out of entrances
+        currEntrance.mLinkedEntrance = (linkedEntrance == -1) ? -1 :
+            (linkedCluster * NAVIGATION_CLUSTER_MAX_ENTRANCES + linkedEntrance);
+    }
+}
+
+int NavigationHierarchy::GetNodeCluster(int nodeIndex) const
+{
+    int coordx;
+    int coordy;
+    int layer;
+    NavigationGraph::GetNodeLocation(nodeIndex, coordx, coordy, layer);
+    return (coordy / NAVIGATION_CLUSTER_DIMENSIONS) * NAVIGATION_CLUSTERS_COUNT + (coordx / NAVIGATION_CLUSTER_DIMENSIONS);
+}
+
+Rect2D NavigationHierarchy::GetClusterArea(int clusterIndex) const
+{
+    return Rect2D(
+        (clusterIndex % NAVIGATION_CLUSTERS_COUNT) * NAVIGATION_CLUSTER_DIMENSIONS,
+        (clusterIndex / NAVIGATION_CLUSTERS_COUNT) * NAVIGATION_CLUSTER_DIMENSIONS,
+        NAVIGATION_CLUSTER_DIMENSIONS,
+        NAVIGATION_CLUSTER_DIMENSIONS);
+}
+
+int NavigationHierarchy::FindClusterEntrance(int clusterIndex, int nodeIndex) const
+{
+    const NavigationCluster& cluster = mClusters[clusterIndex];
+    for (int ientrance = 0, numEntrances = (int) cluster.mEntrances.size(); ientrance < numEntrances; ++ientrance)
+    {
+        if (cluster.mEntrances[ientrance].mNodeIndex == nodeIndex)
+            return ientrance;
+    }
+    return -1;
+}
+
+bool NavigationHierarchy::FindPath(const glm::vec3& start, const glm::vec3& goal, std::vector<glm::vec3>& outputPath)
+{
+    int startNode = mNavigationGraph.FindNode(start);
+    int goalNode = mNavigationGraph.FindNode(goal);
+    if (startNode == -1 || goalNode == -1)
+        return false;
+
+    return FindPath(startNode, goalNode, outputPath);
+}
+
+bool NavigationHierarchy::FindPath(int startNode, int goalNode, std::vector<glm::vec3>& outputPath)
+{
+    debug_assert(IsBuilt());
+
+    if (startNode == goalNode)
+        return true;
+
+    // nodes within same cluster are usually connected locally
+    const int startCluster = GetNodeCluster(startNode);
+    if (startCluster == GetNodeCluster(goalNode))
+    {
+        if (mNavigationGraph.FindPathInArea(startNode, goalNode, GetClusterArea(startCluster), outputPath))
+            return true;
+    }
+
+    CachedPath& cachedPath = mCachedPaths[get_cached_path_index(startNode, goalNode)];
+    if (cachedPath.mStartNode == startNode && cachedPath.mGoalNode == goalNode && cachedPath.mVersion == mVersion)
+    {
+        ++mCachedPathsHits;
+    }
+    else
+    {
+        if (!SearchAbstractPath(startNode, goalNode, mQueryAbstractNodes))
+            return false;
+
+        cachedPath.mStartNode = startNode;
+        cachedPath.mGoalNode = goalNode;
+        cachedPath.mVersion = mVersion;
+        cachedPath.mNodes.assign(mQueryAbstractNodes.begin(), mQueryAbstractNodes.end());
+    }
+
+    size_t pathStart = outputPath.size();
+    if (RefineAbstractPath(cachedPath.mNodes, outputPath))
+        return true;
+
+    // links of navigation graph are not guaranteed to be symmetric around slopes,
+    // fallback to plain search if abstract path cannot be refined
+    outputPath.resize(pathStart);
+    return mNavigationGraph.FindPath(startNode, goalNode, outputPath);
+}
+
+bool NavigationHierarchy::SearchAbstractPath(int startNode, int goalNode, std::vector<int>& outputNodes)
+{
+    outputNodes.clear();
+
+    const int startCluster = GetNodeCluster(startNode);
+    const int goalCluster = GetNodeCluster(goalNode);
+    const NavigationCluster& startClusterData = mClusters[startCluster];
+    const NavigationCluster& goalClusterData = mClusters[goalCluster];
+
+    // connect start and goal nodes to entrances of their clusters
+    mQueryTargetNodes.clear();
+    for (const NavigationEntrance& currEntrance: startClusterData.mEntrances)
+    {
+        mQueryTargetNodes.push_back(currEntrance.mNodeIndex);
+    }
+    if (mNavigationGraph.ComputePathCosts(startNode, GetClusterArea(startCluster),
+        mQueryTargetNodes.data(), (int) mQueryTargetNodes.size(), mQueryStartCosts.data()) == 0)
+    {
+        return false;
+    }
+
+    mQueryTargetNodes.clear();
+    for (const NavigationEntrance& currEntrance: goalClusterData.mEntrances)
+    {
+        mQueryTargetNodes.push_back(currEntrance.mNodeIndex);
+    }
+    if (mNavigationGraph.ComputePathCosts(goalNode, GetClusterArea(goalCluster),
+        mQueryTargetNodes.data(), (int) mQueryTargetNodes.size(), mQueryGoalCosts.data()) == 0)
+    {
+        return false;
+    }
+
+    // start new query, previous query states become invalid
+    if (++mQueryID == 0)
+    {
+        for (EntranceQueryState& currState: mQueryStates)
+        {
+            currState.mQueryID = 0;
+        }
+        mQueryID = 1;
+    }
+
+    auto compare_open_entrances = [](const OpenEntrance& lhs, const OpenEntrance& rhs)
+    {
+        return lhs.mEstimatedCost > rhs.mEstimatedCost;
+    };
+
+    int goalx;
+    int goaly;
+    int goalLayer;
+    NavigationGraph::GetNodeLocation(goalNode, goalx, goaly, goalLayer);
+    auto estimate_cost = [goalx, goaly](int nodeIndex)
+    {
+        int coordx;
+        int coordy;
+        int layer;
+        NavigationGraph::GetNodeLocation(nodeIndex, coordx, coordy, layer);
+        float dx = (1.0f * coordx - goalx);
+        float dy = (1.0f * coordy - goaly);
+        return sqrtf(dx * dx + dy * dy) * MAP_BLOCK_LENGTH;
+    };
+
+    auto open_state = [this, &compare_open_entrances](int stateIndex, int parentState, float costFromStart, float estimatedCost)
+    {
+        EntranceQueryState& state = mQueryStates[stateIndex];
+        if (state.mQueryID != mQueryID)
+        {
+            state.mQueryID = mQueryID;
+            state.mParentState = -1;
+            state.mCostFromStart = std::numeric_limits<float>::max();
+            state.mClosed = false;
+        }
+
+        if (state.mClosed || costFromStart >= state.mCostFromStart)
+            return;
+
+        state.mCostFromStart = costFromStart;
+        state.mParentState = parentState;
+        mQueryOpenList.push_back({costFromStart + estimatedCost, stateIndex});
+        std::push_heap(mQueryOpenList.begin(), mQueryOpenList.end(), compare_open_entrances);
+    };
+
+    mQueryOpenList.clear();
+    for (int ientrance = 0, numEntrances = (int) startClusterData.mEntrances.size(); ientrance < numEntrances; ++ientrance)
+    {
+        if (mQueryStartCosts[ientrance] == std::numeric_limits<float>::max())
+            continue;
+
+        open_state(startCluster * NAVIGATION_CLUSTER_MAX_ENTRANCES + ientrance, AbstractState_Start,
+            mQueryStartCosts[ientrance], estimate_cost(startClusterData.mEntrances[ientrance].mNodeIndex));
+    }
+
+    bool goalReached = false;
+    while (!mQueryOpenList.empty())
+    {
+        std::pop_heap(mQueryOpenList.begin(), mQueryOpenList.end(), compare_open_entrances);
+        int currStateIndex = mQueryOpenList.back().mStateIndex;
+        mQueryOpenList.pop_back();
+
+        EntranceQueryState& currState = mQueryStates[currStateIndex];
+        if (currState.mClosed) // outdated open list entry
+            continue;
+
+        currState.mClosed = true;
+        if (currStateIndex == AbstractState_Goal)
+        {
+            goalReached = true;
+            break;
+        }
+
+        const int clusterIndex = currStateIndex / NAVIGATION_CLUSTER_MAX_ENTRANCES;
+        const int entranceIndex = currStateIndex % NAVIGATION_CLUSTER_MAX_ENTRANCES;
+        const NavigationCluster& cluster = mClusters[clusterIndex];
+        const NavigationEntrance& entrance = cluster.mEntrances[entranceIndex];
+        const float costFromStart = currState.mCostFromStart;
+
+        if (clusterIndex == goalCluster && mQueryGoalCosts[entranceIndex] != std::numeric_limits<float>::max())
+        {
+            open_state(AbstractState_Goal, currStateIndex, costFromStart + mQueryGoalCosts[entranceIndex], 0.0f);
+        }
+
+        if (entrance.mLinkedEntrance != -1)
+        {
+            const int linkedCluster = entrance.mLinkedEntrance / NAVIGATION_CLUSTER_MAX_ENTRANCES;
+            const int linkedEntrance = entrance.mLinkedEntrance % NAVIGATION_CLUSTER_MAX_ENTRANCES;
+            open_state(entrance.mLinkedEntrance, currStateIndex, costFromStart + entrance.mLinkCost,
+                estimate_cost(mClusters[linkedCluster].mEntrances[linkedEntrance].mNodeIndex));
+        }
+
+        const int numEntrances = (int) cluster.mEntrances.size();
+        const float* entranceCosts = cluster.mEntrancesCosts.data() + entranceIndex * numEntrances;
+        for (int itarget = 0; itarget < numEntrances; ++itarget)
+        {
+            if (itarget == entranceIndex || entranceCosts[itarget] == std::numeric_limits<float>::max())
+                continue;
+
+            open_state(clusterIndex * NAVIGATION_CLUSTER_MAX_ENTRANCES + itarget, currStateIndex,
+                costFromStart + entranceCosts[itarget], estimate_cost(cluster.mEntrances[itarget].mNodeIndex));
+        }
+    }
+
+    if (!goalReached)
+        return false;
+
+    // collect abstract nodes from goal to start
+    outputNodes.push_back(goalNode);
+    for (int stateIndex = mQueryStates[AbstractState_Goal].mParentState; stateIndex != AbstractState_Start;
+        stateIndex = mQueryStates[stateIndex].mParentState)
+    {
+        const int clusterIndex = stateIndex / NAVIGATION_CLUSTER_MAX_ENTRANCES;
+        const int entranceIndex = stateIndex % NAVIGATION_CLUSTER_MAX_ENTRANCES;
+        outputNodes.push_back(mClusters[clusterIndex].mEntrances[entranceIndex].mNodeIndex);
+    }
+    outputNodes.push_back(startNode);
+    std::reverse(outputNodes.begin(), outputNodes.end());
+    return true;
+}
+
+bool NavigationHierarchy::RefineAbstractPath(const std::vector<int>& abstractNodes, std::vector<glm::vec3>& outputPath)
+{
+    for (size_t inode = 1; inode < abstractNodes.size(); ++inode)
+    {
+        const int segmentStart = abstractNodes[inode - 1];
+        const int segmentEnd = abstractNodes[inode];
+        const int segmentCluster = GetNodeCluster(segmentStart);
+        if (segmentCluster != GetNodeCluster(segmentEnd)) // border crossing link
+        {
+            outputPath.push_back(mNavigationGraph.GetNodePosition(segmentEnd));
+            continue;
+        }
+
+        if (!mNavigationGraph.FindPathInArea(segmentStart, segmentEnd, GetClusterArea(segmentCluster), outputPath))
+            return false;
+    }
+    return true;
+}
\ No newline at end of file
@@ -0,0 +1,134 @@
+#pragma once
+
+#include "NavigationGraph.h"
+
+#define NAVIGATION_CLUSTERS_COUNT MAP_CHUNKS_COUNT // clusters are aligned to map chunks
+#define NAVIGATION_CLUSTER_MAX_ENTRANCES 64
+#define NAVIGATION_CACHED_PATHS_COUNT 256
+
+// cluster border crossing point
+struct NavigationEntrance
+{
+public:
+    int mNodeIndex; // navigation graph node within cluster
+    int mLinkedNode; // navigation graph node across cluster border
+    int mLinkedEntrance; // entrance in neighbour cluster, cluster index * NAVIGATION_CLUSTER_MAX_ENTRANCES + entrance index
+    float mLinkCost;
+};
+
+// defines cluster of navigation graph nodes
+struct NavigationCluster
+{
+public:
+    std::vector<NavigationEntrance> mEntrances;
+    std::vector<float> mEntrancesCosts; // path costs between each pair of entrances within cluster, FLT_MAX if unreachable
+};
+
+// defines hierarchical pathfinding on top of pedestrians navigation graph
+// map is split into clusters connected with entrances, long paths are searched on abstract graph of entrances
+// and then refined with local searches restricted to single cluster
+class NavigationHierarchy final: public cxx::noncopyable
+{
+public:
+    NavigationHierarchy(NavigationGraph& navigationGraph);
+
+    // compile clusters from navigation graph, graph should be built
+    bool Build();
+
+    // free hierarchy data
+    void Cleanup();
+
+    // rebuild clusters for chunks which were updated in navigation graph since last update,
+    // graph itself must be updated before
+    // @returns number of rebuilt clusters
+    int UpdateModifiedClusters();
+
+    // find path between two world points, waypoints are appended to output list
+    // abstract paths are cached so repeated queries between same nodes skip abstract search
+    // note that it is not thread safe since query buffers are shared
+    // @param start: Start world position
+    // @param goal: Destination world position
+    // @param outputPath: Path waypoints excluding start node
+    // @returns false if there is no path
+    bool FindPath(const glm::vec3& start, const glm::vec3& goal, std::vector<glm::vec3>& outputPath);
+    bool FindPath(int startNode, int goalNode, std::vector<glm::vec3>& outputPath);
+
+    // get hierarchy stats
+    inline int GetEntrancesCount() const { return mEntrancesCount; }
+    inline int GetCachedPathsHits() const { return mCachedPathsHits; }
+
+    // test whether hierarchy is built
+    bool IsBuilt() const;
+
+private:
+    // rebuild entrances and costs of specified clusters
+    void BuildClusters(const bool dirtyClusters[NAVIGATION_CLUSTERS_COUNT][NAVIGATION_CLUSTERS_COUNT]);
+    void BuildClusterEntrances(int clusterx, int clustery);
+    void BuildClusterCosts(int clusterx, int clustery);
+    void LinkClusterEntrances(int clusterx, int clustery);
+
+    // collect border crossing nodes between cluster and its neighbour on east or south side
+    // @param clusterx, clustery: Cluster
+    // @param southBorder: Neighbour is on south side, otherwise on east side
+    // @param outputLinks: Border crossing links
+    void CollectBorderLinks(int clusterx, int clustery, bool southBorder, std::vector<NavigationEntrance>& outputLinks) const;
+
+    // search path on abstract graph, abstract path nodes including start and goal are written to output list
+    bool SearchAbstractPath(int startNode, int goalNode, std::vector<int>& outputNodes);
+
+    // compute path waypoints from abstract path nodes
+    bool RefineAbstractPath(const std::vector<int>& abstractNodes, std::vector<glm::vec3>& outputPath);
+
+    int GetNodeCluster(int nodeIndex) const;
+    Rect2D GetClusterArea(int clusterIndex) const;
+    int FindClusterEntrance(int clusterIndex, int nodeIndex) const;
+
+private:
+    // open list entry of abstract search
+    struct OpenEntrance
+    {
+    public:
+        float mEstimatedCost;
+        int mStateIndex;
+    };
+
+    // per entrance query state, reused between queries
+    struct EntranceQueryState
+    {
+    public:
+        unsigned int mQueryID; // state is valid only if matches current query
+        int mParentState;
+        float mCostFromStart;
+        bool mClosed;
+    };
+
+    // abstract path between two nodes
+    struct CachedPath
+    {
+    public:
+        int mStartNode = -1;
+        int mGoalNode = -1;
+        unsigned int mVersion = 0; // hierarchy version at the moment of caching
+        std::vector<int> mNodes;
+    };
+
+    NavigationGraph& mNavigationGraph;
+    NavigationCluster mClusters[NAVIGATION_CLUSTERS_COUNT * NAVIGATION_CLUSTERS_COUNT];
+    unsigned int mChunksVersions[NAVIGATION_CLUSTERS_COUNT][NAVIGATION_CLUSTERS_COUNT]; // y, x
+    unsigned int mGraphVersion; // navigation graph version at the moment of last update
+    unsigned int mVersion; // incremented each time clusters are rebuilt
+    int mEntrancesCount;
+    bool mIsBuilt;
+
+    CachedPath mCachedPaths[NAVIGATION_CACHED_PATHS_COUNT];
+    int mCachedPathsHits;
+
+    // query buffers
+    std::vector<EntranceQueryState> mQueryStates;
+    std::vector<OpenEntrance> mQueryOpenList; // binary heap
+    std::vector<int> mQueryAbstractNodes;
+    std::vector<int> mQueryTargetNodes;
+    std::vector<float> mQueryStartCosts;
+    std::vector<float> mQueryGoalCosts;
+    unsigned int mQueryID;
+};
\ No newline at end of file
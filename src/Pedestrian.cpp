@@ -2,9 +2,8 @@
 #include "Pedestrian.h"
 #include "PhysicsManager.h"
 #include "GameMapManager.h"
-#include "SpriteBatch.h"
-#include "SpriteManager.h"
 #include "RenderingManager.h"
+#include "RenderSnapshot.h"
 #include "PedestrianStates.h"
 
 Pedestrian::Pedestrian(GameObjectID_t id)
@@ -14,6 +13,7 @@ Pedestrian::Pedestrian(GameObjectID_t id)
     , mController()
     , mActivePedsNode(this)
     , mDeletePedsNode(this)
+    , mGridNode(this)
 {
 }
 
@@ -72,20 +72,18 @@ void Pedestrian::UpdateFrame(Timespan deltaTime)
     SetCurrentState(nextState, false);
 }
 
-void Pedestrian::DrawFrame(SpriteBatch& spriteBatch)
+void Pedestrian::CaptureDrawState(SpriteDrawState& drawState)
 {
-    cxx::angle_t rotationAngle = mPhysicsComponent->GetRotationAngle() - cxx::angle_t::from_degrees(SPRITE_ZERO_ANGLE);
-    glm::vec3 position = mPhysicsComponent->GetPosition();
-
-    int spriteLinearIndex = gGameMap.mStyleData.GetSpriteIndex(eSpriteType_Ped, mCurrentAnimState.GetCurrentFrame());
-    gSpriteManager.GetSpriteTexture(mObjectID, spriteLinearIndex, mDrawSprite);
-
-    mDrawSprite.mPosition = glm::vec2(position.x, position.z);
-    mDrawSprite.mScale = SPRITE_SCALE;
-    mDrawSprite.mRotateAngle = rotationAngle;
-    mDrawSprite.mHeight = ComputeDrawHeight(position, rotationAngle);
-    mDrawSprite.SetOriginToCenter();
-    spriteBatch.DrawSprite(mDrawSprite);
+    const float interpolationFactor = gPhysics.GetInterpolationFactor();
+
+    cxx::angle_t rotationAngle = mPhysicsComponent->GetInterpolatedRotationAngle(interpolationFactor) - cxx::angle_t::from_degrees(SPRITE_ZERO_ANGLE);
+    glm::vec3 position = mPhysicsComponent->GetInterpolatedPosition(interpolationFactor);
+
+    drawState.mObjectID = mObjectID;
+    drawState.mSpriteIndex = gGameMap.mStyleData.GetSpriteIndex(eSpriteType_Ped, mCurrentAnimState.GetCurrentFrame());
+    drawState.mSpriteDeltaBits = 0;
+    drawState.mPosition = glm::vec3(position.x, ComputeDrawHeight(position, rotationAngle), position.z);
+    drawState.mRotateAngle = rotationAngle;
 }
 
 void Pedestrian::SetHeading(cxx::angle_t rotationAngle)
@@ -119,18 +117,23 @@ float Pedestrian::ComputeDrawHeight(const glm::vec3& position, cxx::angle_t rota
         { -halfBox, position.y + 0.01f, halfBox },
     };
 
-    float maxHeight = position.y;
     for (glm::vec3& currPoint: points)
     {
         //currPoint = glm::rotate(currPoint, angleRadians, glm::vec3(0.0f, -1.0f, 0.0f)); // dont rotate for peds
         currPoint.x += position.x;
         currPoint.z += position.z;
+    }
 
-        // get height
-        float height = gGameMap.GetHeightAtPosition(currPoint);
-        if (height > maxHeight)
+    // get heights
+    float heights[4];
+    gGameMap.GetHeightAtPositions(points, 4, heights);
+
+    float maxHeight = position.y;
+    for (float currHeight: heights)
+    {
+        if (currHeight > maxHeight)
         {
-            maxHeight = height;
+            maxHeight = currHeight;
         }
     }
 #if 1
@@ -4,13 +4,15 @@
 #include "PhysicsDefs.h"
 #include "CharacterController.h"
 #include "GameObject.h"
+#include "GameObjectsGrid.h"
 
-class SpriteBatch;
+struct SpriteDrawState;
 
 // defines generic city pedestrian
 class Pedestrian final: public GameObject
 {
     friend class GameObjectsManager;
+    friend class GameObjectsGrid<Pedestrian>;
 
     // all base states should have access to private data
     friend class PedestrianBaseState;
@@ -43,7 +45,10 @@ public:
     void EnterTheGame();
 
     void UpdateFrame(Timespan deltaTime);
-    void DrawFrame(SpriteBatch& spriteBatch);
+
+    // get current sprite state for render snapshot
+    // @param drawState: Output state
+    void CaptureDrawState(SpriteDrawState& drawState);
 
     // set position for pedestrian, does nothing if sitting in car
     // @param position: World position
@@ -65,9 +70,8 @@ private:
     eSpriteAnimationID mCurrentAnimID;
     SpriteAnimation mCurrentAnimState;
 
-    Sprite mDrawSprite;
-
     // internal stuff that can be touched only by PedestrianManager
     cxx::intrusive_node<Pedestrian> mActivePedsNode;
     cxx::intrusive_node<Pedestrian> mDeletePedsNode;
+    GameObjectsGridNode<Pedestrian> mGridNode;
 };
@@ -0,0 +1,155 @@
+#include "stdafx.h"
+#include "PedestrianDensityManager.h"
+#include "CarnageGame.h"
+#include "PhysicsComponents.h"
+#include "GameCamera.h"
+
+#define PEDESTRIANS_SPAWN_ATTEMPTS_PER_FRAME 8
+#define PEDESTRIANS_SPAWN_CLEARANCE 1.0f // min distance to other pedestrians when spawning, in blocks
+
+PedestrianDensityManager::PedestrianDensityManager()
+    : mRandom(1)
+    , mStatsSpawnsCount()
+    , mStatsDespawnsCount()
+{
+}
+
+void PedestrianDensityManager::Cleanup()
+{
+    GameObjectsManager& objectsManager = gCarnageGame.mObjectsManager;
+    for (GameObjectID_t currentID: mAmbientPedestrians)
+    {
+        Pedestrian* pedestrian = objectsManager.GetPedestrianByID(currentID);
+        if (pedestrian)
+        {
+            objectsManager.DestroyGameObject(pedestrian);
+        }
+    }
+    mAmbientPedestrians.clear();
+
+    mStats = PedestrianDensityStats();
+    mStatsTime = 0;
+    mStatsSpawnsCount = 0;
+    mStatsDespawnsCount = 0;
+}
+
+void PedestrianDensityManager::UpdateFrame(Timespan deltaTime)
+{
+    if (gCarnageGame.mNavigationGraph.IsBuilt())
+    {
+        const glm::vec2 centerPosition (gCamera.mPosition.x, gCamera.mPosition.z);
+
+        DespawnPedestrians(centerPosition);
+        SpawnPedestrians(centerPosition);
+    }
+    UpdateStats(deltaTime);
+}
+
+void PedestrianDensityManager::DespawnPedestrians(const glm::vec2& centerPosition)
+{
+    GameObjectsManager& objectsManager = gCarnageGame.mObjectsManager;
+
+    const float despawnRadius2 = gGameRules.mPedestriansDespawnRadius * gGameRules.mPedestriansDespawnRadius;
+
+    int numDespawns = 0;
+    for (size_t ipedestrian = 0; ipedestrian < mAmbientPedestrians.size(); )
+    {
+        // pedestrian could be destroyed by someone else
+        Pedestrian* pedestrian = objectsManager.GetPedestrianByID(mAmbientPedestrians[ipedestrian]);
+        bool keepPedestrian = (pedestrian && !pedestrian->mMarkForDeletion);
+        if (keepPedestrian && numDespawns < gGameRules.mPedestriansMaxDespawnsPerFrame)
+        {
+            glm::vec3 position = pedestrian->mPhysicsComponent->GetPosition();
+            if (glm::length2(glm::vec2(position.x, position.z) - centerPosition) > despawnRadius2)
+            {
+                // release pool slot immediately so that it can be reused by spawns within same frame
+                objectsManager.DestroyGameObject(pedestrian);
+                keepPedestrian = false;
+
+                ++numDespawns;
+                ++mStatsDespawnsCount;
+            }
+        }
+
+        if (!keepPedestrian)
+        {
+            // order is not important
+            mAmbientPedestrians[ipedestrian] = mAmbientPedestrians.back();
+            mAmbientPedestrians.pop_back();
+            continue;
+        }
+        ++ipedestrian;
+    }
+}
+
+void PedestrianDensityManager::SpawnPedestrians(const glm::vec2& centerPosition)
+{
+    GameObjectsManager& objectsManager = gCarnageGame.mObjectsManager;
+    const NavigationGraph& navigationGraph = gCarnageGame.mNavigationGraph;
+
+    const float spawnMinDistance = gGameRules.mPedestriansSpawnMinDistance;
+    const float spawnMaxDistance = glm::max(gGameRules.mPedestriansSpawnRadius, spawnMinDistance);
+
+    // target count is derived from density and ring area
+    const float spawnArea = glm::pi<float>() * (spawnMaxDistance * spawnMaxDistance - spawnMinDistance * spawnMinDistance);
+    mStats.mTargetCount = glm::min((int) (spawnArea * gGameRules.mPedestriansDensity), gGameRules.mPedestriansMaxCount);
+
+    int numSpawns = 0;
+    for (int iattempt = 0; iattempt < PEDESTRIANS_SPAWN_ATTEMPTS_PER_FRAME; ++iattempt)
+    {
+        if ((int) mAmbientPedestrians.size() >= mStats.mTargetCount || numSpawns >= gGameRules.mPedestriansMaxSpawnsPerFrame)
+            break;
+
+        // pick random block within spawn ring
+        cxx::angle_t spawnAngle = cxx::angle_t::from_degrees(mRandom.generate_float() * 360.0f);
+        float spawnDistance = spawnMinDistance + mRandom.generate_float() * (spawnMaxDistance - spawnMinDistance);
+        int coordx = (int) floorf((centerPosition.x + cosf(spawnAngle.to_radians()) * spawnDistance) / MAP_BLOCK_LENGTH);
+        int coordy = (int) floorf((centerPosition.y + sinf(spawnAngle.to_radians()) * spawnDistance) / MAP_BLOCK_LENGTH);
+
+        // pedestrians are spawned on topmost pavement
+        int nodeIndex = -1;
+        for (int layer = MAP_LAYERS_COUNT - 1; layer > -1 && nodeIndex == -1; --layer)
+        {
+            nodeIndex = navigationGraph.FindNode(coordx, coordy, layer);
+        }
+
+        if (nodeIndex == -1 || navigationGraph.GetNode(nodeIndex).mGroundType != eGroundType_Pawement)
+            continue;
+
+        glm::vec3 spawnPosition = navigationGraph.GetNodePosition(nodeIndex);
+
+        mQueryPedestrians.clear();
+        if (objectsManager.mPedestriansGrid.QueryRadius(glm::vec2(spawnPosition.x, spawnPosition.z), PEDESTRIANS_SPAWN_CLEARANCE, mQueryPedestrians) > 0)
+            continue;
+
+        Pedestrian* pedestrian = objectsManager.CreatePedestrian(spawnPosition);
+        debug_assert(pedestrian);
+
+        pedestrian->SetHeading(cxx::angle_t::from_degrees(mRandom.generate_float() * 360.0f));
+        mAmbientPedestrians.push_back(pedestrian->mObjectID);
+
+        ++numSpawns;
+        ++mStatsSpawnsCount;
+    }
+}
+
+void PedestrianDensityManager::UpdateStats(Timespan deltaTime)
+{
+    const GameObjectsManager& objectsManager = gCarnageGame.mObjectsManager;
+
+    mStats.mLiveCount = (int) mAmbientPedestrians.size();
+    mStats.mPoolAllocatedCount = objectsManager.GetPedestriansPoolAllocatedCount();
+    mStats.mPoolHighWaterMark = objectsManager.GetPedestriansPoolHighWaterMark();
+
+    mStatsTime += deltaTime;
+    if (mStatsTime >= Timespan::FromSeconds(1.0f))
+    {
+        float statsSeconds = mStatsTime.ToSeconds();
+        mStats.mSpawnsPerSecond = mStatsSpawnsCount / statsSeconds;
+        mStats.mDespawnsPerSecond = mStatsDespawnsCount / statsSeconds;
+
+        mStatsTime = 0;
+        mStatsSpawnsCount = 0;
+        mStatsDespawnsCount = 0;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,49 @@
+#pragma once
+
+#include "GameDefs.h"
+
+// ambient pedestrians population stats
+struct PedestrianDensityStats
+{
+public:
+    int mLiveCount = 0; // ambient pedestrians currently in game
+    int mTargetCount = 0;
+    float mSpawnsPerSecond = 0.0f;
+    float mDespawnsPerSecond = 0.0f;
+    int mPoolAllocatedCount = 0; // all pedestrians including non ambient
+    int mPoolHighWaterMark = 0;
+};
+
+// defines ambient pedestrians population, keeps target density of pedestrians in ring around camera,
+// pedestrians which leave the ring are destroyed and their pool slots are reused by new spawns,
+// both spawns and despawns are limited per frame to avoid hitches
+class PedestrianDensityManager final: public cxx::noncopyable
+{
+public:
+    PedestrianDensityManager();
+
+    // destroy all ambient pedestrians
+    void Cleanup();
+
+    // spawn and despawn ambient pedestrians
+    // @param deltaTime: Time since last frame
+    void UpdateFrame(Timespan deltaTime);
+
+    // get population stats, rates are averaged over last second
+    inline const PedestrianDensityStats& GetStats() const { return mStats; }
+
+private:
+    void DespawnPedestrians(const glm::vec2& centerPosition);
+    void SpawnPedestrians(const glm::vec2& centerPosition);
+    void UpdateStats(Timespan deltaTime);
+
+private:
+    std::vector<GameObjectID_t> mAmbientPedestrians;
+    std::vector<Pedestrian*> mQueryPedestrians;
+    cxx::randomizer mRandom;
+
+    PedestrianDensityStats mStats;
+    Timespan mStatsTime; // time since stats rates were updated
+    int mStatsSpawnsCount;
+    int mStatsDespawnsCount;
+};
\ No newline at end of file
@@ -2,35 +2,92 @@
 #include "PhysicsComponents.h"
 #include "PhysicsDefs.h"
 #include "Pedestrian.h"
+#include "GameObjectsCommandBuffer.h"
 
 PhysicsComponent::PhysicsComponent(b2World* physicsWorld)
     : mHeight()
     , mOnTheGround()
+    , mMapLayer(-1)
     , mPhysicsWorld(physicsWorld)
     , mPhysicsBody()
+    , mPreviousPosition()
+    , mPreviousRotationAngle()
 {
     debug_assert(physicsWorld);
 }
 
 void PhysicsComponent::SetPosition(const glm::vec3& position)
 {
+    // record command during parallel update
+    if (GameObjectsCommandBuffer* commandBuffer = GameObjectsCommandBuffer::GetCurrent())
+    {
+        commandBuffer->SetPosition(this, position);
+        return;
+    }
+
     mHeight = position.y;
 
     b2Vec2 b2position { position.x * PHYSICS_SCALE, position.z * PHYSICS_SCALE };
     mPhysicsBody->SetTransform(b2position, mPhysicsBody->GetAngle());
+    UpdateMapLayer();
+
+    // teleport, don't blend
+    mPreviousPosition = position;
 }
 
 void PhysicsComponent::SetPosition(const glm::vec3& position, cxx::angle_t rotationAngle)
 {
+    // record command during parallel update
+    if (GameObjectsCommandBuffer* commandBuffer = GameObjectsCommandBuffer::GetCurrent())
+    {
+        commandBuffer->SetPosition(this, position, rotationAngle);
+        return;
+    }
+
     mHeight = position.y;
 
     b2Vec2 b2position { position.x * PHYSICS_SCALE, position.z * PHYSICS_SCALE };
     mPhysicsBody->SetTransform(b2position, rotationAngle.to_radians());
+    UpdateMapLayer();
+
+    // teleport, don't blend
+    mPreviousPosition = position;
+    mPreviousRotationAngle = GetRotationAngle();
+}
+
+void PhysicsComponent::UpdateMapLayer()
+{
+    int mapLayer = glm::clamp((int) (mHeight + 0.5f), 0, MAP_LAYERS_COUNT - 1);
+    if (mMapLayer == mapLayer)
+        return;
+
+    mMapLayer = mapLayer;
+
+    // solid blocks of other layers are excluded from mask, so such contacts are never created
+    for (b2Fixture* currFixture = mPhysicsBody->GetFixtureList(); currFixture; currFixture = currFixture->GetNext())
+    {
+        if (currFixture->IsSensor())
+            continue;
+
+        b2Filter filterData = currFixture->GetFilterData();
+        filterData.maskBits &= ~(PHYSICS_OBJCAT_MAP_SOLID_BLOCK | PHYSICS_OBJCAT_MAP_LAYERS);
+        filterData.maskBits |= PHYSICS_OBJCAT_MAP_LAYER(mapLayer);
+        currFixture->SetFilterData(filterData);
+    }
 }
 
 void PhysicsComponent::SetRotationAngle(cxx::angle_t rotationAngle)
 {
+    // record command during parallel update
+    if (GameObjectsCommandBuffer* commandBuffer = GameObjectsCommandBuffer::GetCurrent())
+    {
+        commandBuffer->SetRotationAngle(this, rotationAngle);
+        return;
+    }
+
     mPhysicsBody->SetTransform(mPhysicsBody->GetPosition(), rotationAngle.to_radians());
+
+    mPreviousRotationAngle = GetRotationAngle();
 }
 
 cxx::angle_t PhysicsComponent::GetRotationAngle() const
@@ -42,12 +99,24 @@ cxx::angle_t PhysicsComponent::GetRotationAngle() const
 
 void PhysicsComponent::AddForce(const glm::vec2& force)
 {
+    // record command during parallel update
+    if (GameObjectsCommandBuffer* commandBuffer = GameObjectsCommandBuffer::GetCurrent())
+    {
+        commandBuffer->AddForce(this, force);
+        return;
+    }
     b2Vec2 b2Force { force.x * PHYSICS_SCALE, force.y * PHYSICS_SCALE };
     mPhysicsBody->ApplyForceToCenter(b2Force, true);
 }
 
 void PhysicsComponent::AddLinearImpulse(const glm::vec2& impulse)
 {
+    // record command during parallel update
+    if (GameObjectsCommandBuffer* commandBuffer = GameObjectsCommandBuffer::GetCurrent())
+    {
+        commandBuffer->AddLinearImpulse(this, impulse);
+        return;
+    }
     b2Vec2 b2Impulse { impulse.x * PHYSICS_SCALE, impulse.y * PHYSICS_SCALE };
     mPhysicsBody->ApplyLinearImpulseToCenter(b2Impulse, true);
 }
@@ -72,27 +141,91 @@ float PhysicsComponent::GetAngularVelocity() const
 
 void PhysicsComponent::AddAngularImpulse(float impulse)
 {
+    // record command during parallel update
+    if (GameObjectsCommandBuffer* commandBuffer = GameObjectsCommandBuffer::GetCurrent())
+    {
+        commandBuffer->AddAngularImpulse(this, impulse);
+        return;
+    }
     mPhysicsBody->ApplyAngularImpulse(impulse, true);
 }
 
 void PhysicsComponent::SetAngularVelocity(float angularVelocity)
 {
+    // record command during parallel update
+    if (GameObjectsCommandBuffer* commandBuffer = GameObjectsCommandBuffer::GetCurrent())
+    {
+        commandBuffer->SetAngularVelocity(this, angularVelocity);
+        return;
+    }
     mPhysicsBody->SetAngularVelocity(glm::radians(angularVelocity));
 }
 
 void PhysicsComponent::SetLinearVelocity(const glm::vec2& velocity)
 {
+    // record command during parallel update
+    if (GameObjectsCommandBuffer* commandBuffer = GameObjectsCommandBuffer::GetCurrent())
+    {
+        commandBuffer->SetLinearVelocity(this, velocity);
+        return;
+    }
     b2Vec2 b2vec { velocity.x * PHYSICS_SCALE, velocity.y * PHYSICS_SCALE };
     mPhysicsBody->SetLinearVelocity(b2vec);
 }
 
 void PhysicsComponent::ClearForces()
 {
+    // record command during parallel update
+    if (GameObjectsCommandBuffer* commandBuffer = GameObjectsCommandBuffer::GetCurrent())
+    {
+        commandBuffer->ClearForces(this);
+        return;
+    }
     b2Vec2 nullVector { 0.0f, 0.0f };
     mPhysicsBody->SetLinearVelocity(nullVector);
     mPhysicsBody->SetAngularVelocity(0.0f);
 }
 
+void PhysicsComponent::SetActive(bool isActive)
+{
+    debug_assert(GameObjectsCommandBuffer::GetCurrent() == nullptr);
+
+    mPhysicsBody->SetActive(isActive);
+}
+
+bool PhysicsComponent::IsActive() const
+{
+    return mPhysicsBody->IsActive();
+}
+
+void PhysicsComponent::SetAwake(bool isAwake)
+{
+    debug_assert(GameObjectsCommandBuffer::GetCurrent() == nullptr);
+
+    mPhysicsBody->SetAwake(isAwake);
+}
+
+bool PhysicsComponent::IsAwake() const
+{
+    return mPhysicsBody->IsAwake();
+}
+
+glm::vec3 PhysicsComponent::GetInterpolatedPosition(float interpolationFactor) const
+{
+    return glm::mix(mPreviousPosition, GetPosition(), interpolationFactor);
+}
+
+cxx::angle_t PhysicsComponent::GetInterpolatedRotationAngle(float interpolationFactor) const
+{
+    // blend along shortest arc
+    cxx::angle_t deltaAngle = GetRotationAngle() - mPreviousRotationAngle;
+    deltaAngle.normalize_angle_180();
+
+    cxx::angle_t rotationAngle = cxx::angle_t::from_degrees(mPreviousRotationAngle.mDegrees + deltaAngle.mDegrees * interpolationFactor);
+    rotationAngle.normalize_angle_180();
+    return rotationAngle;
+}
+
 glm::vec2 PhysicsComponent::GetSignVector() const
 {
     float angleRadians = mPhysicsBody->GetAngle();
@@ -124,6 +257,7 @@ PedPhysicsComponent::PedPhysicsComponent(b2World* physicsWorld)
     fixtureDef.shape = &shapeDef;
     fixtureDef.density = 0.3f;
     fixtureDef.filter.categoryBits = PHYSICS_OBJCAT_PED;
+    fixtureDef.userData = this;
 
     b2Fixture* b2fixture = mPhysicsBody->CreateFixture(&fixtureDef);
     debug_assert(b2fixture);
@@ -150,6 +284,8 @@ void PedPhysicsComponent::UpdateFrame(Timespan deltaTime)
 
 void PedPhysicsComponent::SetFalling(bool isFalling)
 {
+    debug_assert(GameObjectsCommandBuffer::GetCurrent() == nullptr);
+
     if (isFalling == mFalling)
         return;
 
@@ -235,6 +371,7 @@ CarPhysicsComponent::CarPhysicsComponent(b2World* physicsWorld, CarStyle* desc)
     fixtureDef.friction = 0.1f;
     fixtureDef.restitution = 0.0f;
     fixtureDef.filter.categoryBits = PHYSICS_OBJCAT_CAR;
+    fixtureDef.userData = this;
 
     b2Fixture* b2fixture = mPhysicsBody->CreateFixture(&fixtureDef);
     debug_assert(b2fixture);
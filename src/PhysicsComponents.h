@@ -17,8 +17,11 @@ public:
     // current state flags
     bool mOnTheGround;
 
+    int mMapLayer; // map layer which solid blocks body collides with, depends on height
+
 public:
-    // set/get object's world position and rotation angle
+    // set/get object's world position and rotation angle, all setters and forces are deferred while
+    // command buffer is bound to current thread, so getters return previous state until sync point
     // @param position: Coordinate
     // @param rotationAngle: Rotation, optional
     void SetPosition(const glm::vec3& position);
@@ -48,8 +51,26 @@ public:
     void AddAngularImpulse(float impulse);
     // cancel currently active forces
     void ClearForces();
+    // enable or disable body simulation, inactive body does not collide and does not move by itself
+    // but its position still can be set manually, must not be called while command buffer is bound
+    // @param isActive: New state
+    void SetActive(bool isActive);
+    bool IsActive() const;
+    // put body to sleep or wake it up, sleeping body is not simulated until something touches it,
+    // must not be called while command buffer is bound
+    // @param isAwake: New state
+    void SetAwake(bool isAwake);
+    bool IsAwake() const;
+    // get object's world position and rotation angle blended between two last simulation steps,
+    // manually set transform is not blended
+    // @param interpolationFactor: Blend factor in range [0, 1]
+    glm::vec3 GetInterpolatedPosition(float interpolationFactor) const;
+    cxx::angle_t GetInterpolatedRotationAngle(float interpolationFactor) const;
 
 protected:
+    // refresh map collision filter if body has moved to another layer
+    void UpdateMapLayer();
+
     // only derived classes could be instantiated
     PhysicsComponent(b2World* physicsWorld);
     virtual ~PhysicsComponent()
@@ -60,6 +81,10 @@ protected:
     // box2d specific objects is could be accessed only by derived classes and physics manager himself
     b2World* mPhysicsWorld;
     b2Body* mPhysicsBody;
+
+    // transform before last simulation step
+    glm::vec3 mPreviousPosition;
+    cxx::angle_t mPreviousRotationAngle;
 };
 
 // pedestrian physics component
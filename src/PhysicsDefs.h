@@ -1,6 +1,7 @@
 #pragma once
 
 // forwards
+class PhysicsComponent;
 class PedPhysicsComponent;
 class CarPhysicsComponent;
 class WheelPhysicsComponent;
@@ -8,8 +9,12 @@ class WheelPhysicsComponent;
 #define PHYSICS_PED_BOUNDING_SPHERE_RADIUS 0.10f
 #define PHYSICS_PED_SENSOR_SPHERE_RADIUS (PHYSICS_PED_BOUNDING_SPHERE_RADIUS)
 #define PHYSICS_SIMULATION_STEP (1.0f / 60.0f)
+#define PHYSICS_MAX_STEPS_PER_FRAME 5 // limits catch-up work done within single frame
+#define PHYSICS_MAX_PENDING_STEPS 15 // simulation time beyond that is dropped, game slows down instead of stalling
 #define PHYSICS_GRAVITY (9.8f)
 #define PHYSICS_SCALE 10.0f
+#define PHYSICS_MAP_STREAMING_DISTANCE 4.0f // map collision is built within that distance in blocks around moving bodies
+#define PHYSICS_MAP_STREAMING_RELEASE_FRAMES 120 // unused map collision chunk is kept for that number of frames
 
 // physics objects categories
 enum
@@ -22,4 +27,26 @@ enum
 
     // sensors
     PHYSICS_OBJCAT_PED_SENSOR = (1 << 5),
+
+    // map solid block layers, combined with PHYSICS_OBJCAT_MAP_SOLID_BLOCK
+    PHYSICS_OBJCAT_MAP_LAYER_0 = (1 << 6),
+};
+
+// all object categories bits except for map layers
+#define PHYSICS_OBJCAT_TYPES (PHYSICS_OBJCAT_MAP_LAYER_0 - 1)
+
+// map solid blocks are filtered by body current layer, see PhysicsComponent::UpdateMapLayer
+#define PHYSICS_OBJCAT_MAP_LAYER(layer) (PHYSICS_OBJCAT_MAP_LAYER_0 << (layer))
+#define PHYSICS_OBJCAT_MAP_LAYERS (PHYSICS_OBJCAT_MAP_LAYER(MAP_LAYERS_COUNT) - PHYSICS_OBJCAT_MAP_LAYER_0)
+
+// physics objects types, type index matches PHYSICS_OBJCAT_* bit index
+enum ePhysicsObjectType
+{
+    ePhysicsObjectType_MapSolidBlock,
+    ePhysicsObjectType_Wall,
+    ePhysicsObjectType_Ped,
+    ePhysicsObjectType_Car,
+    ePhysicsObjectType_MapObject,
+    ePhysicsObjectType_PedSensor,
+    ePhysicsObjectType_COUNT // also used for fixtures without category
 };
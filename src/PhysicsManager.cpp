@@ -16,7 +16,9 @@ union b2FixtureData_map
 
     struct
     {
-        unsigned char mX, mZ;
+        unsigned char mX, mZ; // first block of rectangle
+        unsigned char mSizeX, mSizeZ;
+        unsigned char mLayer;
     };
 
     void* mAsPointer;
@@ -24,6 +26,59 @@ union b2FixtureData_map
 
 static_assert(sizeof(b2FixtureData_map) <= sizeof(void*), "Cannot pack data into pointer");
 
+// order in which map collision rectangles are produced for chunk: by layer, then by first block row and column
+inline bool map_collision_rect_less(const MapCollisionRect& lhs, const MapCollisionRect& rhs)
+{
+    if (lhs.mLayer != rhs.mLayer)
+        return lhs.mLayer < rhs.mLayer;
+
+    if (lhs.mZ != rhs.mZ)
+        return lhs.mZ < rhs.mZ;
+
+    return lhs.mX < rhs.mX;
+}
+
+inline bool map_collision_rect_equal(const MapCollisionRect& lhs, const MapCollisionRect& rhs)
+{
+    return lhs.mLayer == rhs.mLayer && lhs.mX == rhs.mX && lhs.mZ == rhs.mZ &&
+        lhs.mSizeX == rhs.mSizeX && lhs.mSizeZ == rhs.mSizeZ;
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+enum
+{
+    PHYSICS_SNAPSHOT_MAGIC = 0x53503343, // 'C3PS'
+    PHYSICS_SNAPSHOT_VERSION = 1,
+};
+
+// physics snapshot blob header, followed by pedestrians and then cars bodies states
+struct PhysicsSnapshotHeader
+{
+    unsigned int mMagic;
+    unsigned int mVersion;
+    unsigned int mPedestriansCount;
+    unsigned int mCarsCount;
+    float mSimulationTimeAccumulator;
+};
+
+// physics component state within snapshot blob
+struct PhysicsSnapshotBody
+{
+    GameObjectID_t mObjectID;
+    b2Vec2 mPosition;
+    float mAngle; // radians
+    b2Vec2 mLinearVelocity;
+    float mAngularVelocity;
+    float mHeight;
+    glm::vec3 mPreviousPosition;
+    float mPreviousRotationAngle; // degrees
+    bool mIsActive;
+    bool mIsAwake;
+    bool mOnTheGround;
+    bool mFalling; // pedestrians only
+};
+
 //////////////////////////////////////////////////////////////////////////
 
 PhysicsManager gPhysics;
@@ -31,7 +86,10 @@ PhysicsManager gPhysics;
 PhysicsManager::PhysicsManager()
     : mMapCollisionShape()
     , mPhysicsWorld()
+    , mSimulationTimeAccumulator()
+    , mMapCollisionFrame()
 {
+    InitContactHandlers();
 }
 
 bool PhysicsManager::Initialize()
@@ -41,6 +99,9 @@ bool PhysicsManager::Initialize()
     mPhysicsWorld->SetContactListener(this);
     //mPhysicsWorld->SetAutoClearForces(true);
 
+    mSimulationTimeAccumulator = 0.0f;
+    mSimulationStats = PhysicsSimulationStats();
+
     CreateMapCollisionShape();
     return true;
 }
@@ -52,32 +113,213 @@ void PhysicsManager::Deinit()
         mPhysicsWorld->DestroyBody(mMapCollisionShape);
         mMapCollisionShape = nullptr;
     }
+    // cached rectangles are not valid for next map
+    for (int chunky = 0; chunky < MAP_CHUNKS_COUNT; ++chunky)
+    for (int chunkx = 0; chunkx < MAP_CHUNKS_COUNT; ++chunkx)
+    {
+        mMapChunks[chunky][chunkx] = MapCollisionChunk();
+    }
+    mMapCollisionFrame = 0;
     SafeDelete(mPhysicsWorld);
 }
 
 void PhysicsManager::UpdateFrame(Timespan deltaTime)
 {
-    int maxSimulationStepsPerFrame = 5;
-    int numSimulations = 0;
-
     const int velocityIterations = 3;
     const int positionIterations = 2;
 
+    UpdateMapCollisionShape();
+
     mSimulationTimeAccumulator += deltaTime.ToSeconds();
 
-    while (mSimulationTimeAccumulator >= PHYSICS_SIMULATION_STEP)
+    // time that could not be caught up within few frames is dropped, so heavy frames only slow the game down
+    const float maxPendingTime = PHYSICS_MAX_PENDING_STEPS * PHYSICS_SIMULATION_STEP;
+    if (mSimulationTimeAccumulator > maxPendingTime)
     {
-        mSimulationTimeAccumulator -= PHYSICS_SIMULATION_STEP;
-        mPhysicsWorld->Step(PHYSICS_SIMULATION_STEP, velocityIterations, positionIterations);
-        if (++numSimulations == maxSimulationStepsPerFrame)
+        mSimulationStats.mDroppedTime += (mSimulationTimeAccumulator - maxPendingTime);
+        ++mSimulationStats.mDropFramesCount;
+        mSimulationTimeAccumulator = maxPendingTime;
+    }
+
+    // leftover time stays in accumulator and gets simulated on next frames
+    const int numSteps = glm::min((int) (mSimulationTimeAccumulator / PHYSICS_SIMULATION_STEP), PHYSICS_MAX_STEPS_PER_FRAME);
+    for (int istep = 0; istep < numSteps; ++istep)
+    {
+        // objects are interpolated between two last steps
+        if (istep == numSteps - 1)
         {
-            break;
+            StorePreviousTransforms();
         }
+        mSimulationTimeAccumulator -= PHYSICS_SIMULATION_STEP;
+        mPhysicsWorld->Step(PHYSICS_SIMULATION_STEP, velocityIterations, positionIterations);
         FixedStepPedsGravity();
     }
+
+    mSimulationStats.mFrameSteps = numSteps;
+    mSimulationStats.mPendingSteps = (int) (mSimulationTimeAccumulator / PHYSICS_SIMULATION_STEP);
+    if (mSimulationStats.mPendingSteps > 0)
+    {
+        ++mSimulationStats.mCatchUpFramesCount;
+    }
+    mSimulationStats.mContactsCount = mPhysicsWorld->GetContactCount();
     mPhysicsWorld->DrawDebugData();
 }
 
+float PhysicsManager::GetInterpolationFactor() const
+{
+    if (!gSystem.mConfig.mEnableRenderInterpolation)
+        return 1.0f;
+
+    return glm::clamp(mSimulationTimeAccumulator / PHYSICS_SIMULATION_STEP, 0.0f, 1.0f);
+}
+
+void PhysicsManager::StorePreviousTransforms()
+{
+    for (Pedestrian* currPedestrian: gCarnageGame.mObjectsManager.mActivePedestriansList)
+    {
+        PhysicsComponent* physicsComponent = currPedestrian->mPhysicsComponent;
+        physicsComponent->mPreviousPosition = physicsComponent->GetPosition();
+        physicsComponent->mPreviousRotationAngle = physicsComponent->GetRotationAngle();
+    }
+
+    for (Vehicle* currCar: gCarnageGame.mObjectsManager.mActiveCarsList)
+    {
+        PhysicsComponent* physicsComponent = currCar->mPhysicsComponent;
+        physicsComponent->mPreviousPosition = physicsComponent->GetPosition();
+        physicsComponent->mPreviousRotationAngle = physicsComponent->GetRotationAngle();
+    }
+}
+
+void PhysicsManager::SaveSnapshot(std::vector<unsigned char>& outputData) const
+{
+    GameObjectsManager& objectsManager = gCarnageGame.mObjectsManager;
+
+    std::vector<PhysicsSnapshotBody> pedestriansStates;
+    std::vector<PhysicsSnapshotBody> carsStates;
+
+    auto save_body = [](const PhysicsComponent* physicsComponent, GameObjectID_t objectID, std::vector<PhysicsSnapshotBody>& states)
+    {
+        const b2Body* physicsBody = physicsComponent->mPhysicsBody;
+
+        PhysicsSnapshotBody bodyState;
+        bodyState.mObjectID = objectID;
+        bodyState.mPosition = physicsBody->GetPosition();
+        bodyState.mAngle = physicsBody->GetAngle();
+        bodyState.mLinearVelocity = physicsBody->GetLinearVelocity();
+        bodyState.mAngularVelocity = physicsBody->GetAngularVelocity();
+        bodyState.mHeight = physicsComponent->mHeight;
+        bodyState.mPreviousPosition = physicsComponent->mPreviousPosition;
+        bodyState.mPreviousRotationAngle = physicsComponent->mPreviousRotationAngle.mDegrees;
+        bodyState.mIsActive = physicsBody->IsActive();
+        bodyState.mIsAwake = physicsBody->IsAwake();
+        bodyState.mOnTheGround = physicsComponent->mOnTheGround;
+        bodyState.mFalling = false;
+        states.push_back(bodyState);
+        return &states.back();
+    };
+
+    for (Pedestrian* currPedestrian: objectsManager.mActivePedestriansList)
+    {
+        PhysicsSnapshotBody* bodyState = save_body(currPedestrian->mPhysicsComponent, currPedestrian->mObjectID, pedestriansStates);
+        bodyState->mFalling = currPedestrian->mPhysicsComponent->mFalling;
+    }
+
+    for (Vehicle* currCar: objectsManager.mActiveCarsList)
+    {
+        save_body(currCar->mPhysicsComponent, currCar->mObjectID, carsStates);
+    }
+
+    PhysicsSnapshotHeader header;
+    header.mMagic = PHYSICS_SNAPSHOT_MAGIC;
+    header.mVersion = PHYSICS_SNAPSHOT_VERSION;
+    header.mPedestriansCount = (unsigned int) pedestriansStates.size();
+    header.mCarsCount = (unsigned int) carsStates.size();
+    header.mSimulationTimeAccumulator = mSimulationTimeAccumulator;
+
+    const size_t pedestriansLength = pedestriansStates.size() * sizeof(PhysicsSnapshotBody);
+    const size_t carsLength = carsStates.size() * sizeof(PhysicsSnapshotBody);
+
+    outputData.resize(sizeof(header) + pedestriansLength + carsLength);
+    memcpy(outputData.data(), &header, sizeof(header));
+    if (pedestriansLength)
+    {
+        memcpy(outputData.data() + sizeof(header), pedestriansStates.data(), pedestriansLength);
+    }
+    if (carsLength)
+    {
+        memcpy(outputData.data() + sizeof(header) + pedestriansLength, carsStates.data(), carsLength);
+    }
+}
+
+bool PhysicsManager::RestoreSnapshot(const std::vector<unsigned char>& snapshotData)
+{
+    debug_assert(!mPhysicsWorld->IsLocked());
+
+    GameObjectsManager& objectsManager = gCarnageGame.mObjectsManager;
+
+    PhysicsSnapshotHeader header;
+    if (snapshotData.size() < sizeof(header))
+        return false;
+
+    memcpy(&header, snapshotData.data(), sizeof(header));
+    if (header.mMagic != PHYSICS_SNAPSHOT_MAGIC || header.mVersion != PHYSICS_SNAPSHOT_VERSION ||
+        snapshotData.size() != sizeof(header) + (header.mPedestriansCount + header.mCarsCount) * sizeof(PhysicsSnapshotBody))
+    {
+        return false;
+    }
+
+    auto restore_body = [](PhysicsComponent* physicsComponent, const PhysicsSnapshotBody& bodyState)
+    {
+        b2Body* physicsBody = physicsComponent->mPhysicsBody;
+
+        // deactivation destroys all body contacts and fires EndContact for touching ones,
+        // so contacts are created again from restored transform along with sensor events
+        physicsBody->SetActive(false);
+        physicsBody->SetTransform(bodyState.mPosition, bodyState.mAngle);
+        physicsBody->SetLinearVelocity(bodyState.mLinearVelocity);
+        physicsBody->SetAngularVelocity(bodyState.mAngularVelocity);
+        physicsBody->SetActive(bodyState.mIsActive);
+        physicsBody->SetAwake(bodyState.mIsAwake);
+
+        physicsComponent->mHeight = bodyState.mHeight;
+        physicsComponent->mOnTheGround = bodyState.mOnTheGround;
+        physicsComponent->mPreviousPosition = bodyState.mPreviousPosition;
+        physicsComponent->mPreviousRotationAngle = cxx::angle_t::from_degrees(bodyState.mPreviousRotationAngle);
+        physicsComponent->UpdateMapLayer();
+    };
+
+    const unsigned char* cursor = snapshotData.data() + sizeof(header);
+    for (unsigned int ipedestrian = 0; ipedestrian < header.mPedestriansCount; ++ipedestrian)
+    {
+        PhysicsSnapshotBody bodyState;
+        memcpy(&bodyState, cursor, sizeof(bodyState));
+        cursor += sizeof(bodyState);
+
+        Pedestrian* pedestrian = objectsManager.GetPedestrianByID(bodyState.mObjectID);
+        if (pedestrian == nullptr)
+            continue;
+
+        restore_body(pedestrian->mPhysicsComponent, bodyState);
+        pedestrian->mPhysicsComponent->mFalling = bodyState.mFalling;
+    }
+
+    for (unsigned int icar = 0; icar < header.mCarsCount; ++icar)
+    {
+        PhysicsSnapshotBody bodyState;
+        memcpy(&bodyState, cursor, sizeof(bodyState));
+        cursor += sizeof(bodyState);
+
+        Vehicle* car = objectsManager.GetCarByID(bodyState.mObjectID);
+        if (car == nullptr)
+            continue;
+
+        restore_body(car->mPhysicsComponent, bodyState);
+    }
+
+    mSimulationTimeAccumulator = header.mSimulationTimeAccumulator;
+    return true;
+}
+
 PedPhysicsComponent* PhysicsManager::CreatePedPhysicsComponent(Pedestrian* pedestrian, const glm::vec3& position, cxx::angle_t rotationAngle)
 {
     debug_assert(pedestrian);
@@ -110,62 +352,291 @@ void PhysicsManager::CreateMapCollisionShape()
     b2BodyDef bodyDef;
     bodyDef.type = b2_staticBody;
 
+    // fixtures are created on demand around moving bodies
     mMapCollisionShape = mPhysicsWorld->CreateBody(&bodyDef);
+}
 
-    int numFixtures = 0;
-    // for each block create fixture
-    for (int x = 0; x < MAP_DIMENSIONS; ++x)
-    for (int y = 0; y < MAP_DIMENSIONS; ++y)
-    for (int layer = 0; layer < MAP_LAYERS_COUNT; ++layer)
+void PhysicsManager::UpdateMapCollisionShape()
+{
+    debug_assert(mMapCollisionShape);
+    debug_assert(!mPhysicsWorld->IsLocked());
+
+    ++mMapCollisionFrame;
+
+    // dormant pedestrians and parked cars are not moving, so they cannot hit map
+    for (Pedestrian* currPedestrian: gCarnageGame.mObjectsManager.mActivePedestriansList)
+    {
+        if (currPedestrian->mSimulationLOD == eSimulationLOD_Dormant)
+            continue;
+
+        UseMapCollisionArea(currPedestrian->mPhysicsComponent->GetPosition());
+    }
+
+    for (Vehicle* currCar: gCarnageGame.mObjectsManager.mActiveCarsList)
+    {
+        if (!currCar->mPhysicsComponent->IsActive())
+            continue;
+
+        UseMapCollisionArea(currCar->mPhysicsComponent->GetPosition());
+    }
+
+    for (int chunky = 0; chunky < MAP_CHUNKS_COUNT; ++chunky)
+    for (int chunkx = 0; chunkx < MAP_CHUNKS_COUNT; ++chunkx)
     {
-        BlockStyle* blockData = gGameMap.GetBlock(x, y, layer);
-        debug_assert(blockData);
+        MapCollisionChunk& collisionChunk = mMapChunks[chunky][chunkx];
+        if (!collisionChunk.mIsStreamed)
+        {
+            if (collisionChunk.mLastUseFrame == mMapCollisionFrame)
+            {
+                CreateMapChunkFixtures(chunkx, chunky);
+            }
+            continue;
+        }
 
-        if (blockData->mGroundType != eGroundType_Building)
+        if (mMapCollisionFrame - collisionChunk.mLastUseFrame > PHYSICS_MAP_STREAMING_RELEASE_FRAMES)
+        {
+            DestroyMapChunkFixtures(chunkx, chunky);
             continue;
+        }
+
+        if (collisionChunk.mRectsVersion != gGameMap.GetChunkVersion(chunkx, chunky))
+        {
+            UpdateMapChunkFixtures(chunkx, chunky);
+        }
+    }
+}
+
+void PhysicsManager::UseMapCollisionArea(const glm::vec3& position)
+{
+    const float distance = PHYSICS_MAP_STREAMING_DISTANCE * MAP_BLOCK_LENGTH;
+    const float chunkLength = MAP_CHUNK_DIMENSIONS * MAP_BLOCK_LENGTH;
+
+    int minChunkx = glm::clamp((int) floor((position.x - distance) / chunkLength), 0, MAP_CHUNKS_COUNT - 1);
+    int maxChunkx = glm::clamp((int) floor((position.x + distance) / chunkLength), 0, MAP_CHUNKS_COUNT - 1);
+    int minChunky = glm::clamp((int) floor((position.z - distance) / chunkLength), 0, MAP_CHUNKS_COUNT - 1);
+    int maxChunky = glm::clamp((int) floor((position.z + distance) / chunkLength), 0, MAP_CHUNKS_COUNT - 1);
+
+    for (int chunky = minChunky; chunky <= maxChunky; ++chunky)
+    for (int chunkx = minChunkx; chunkx <= maxChunkx; ++chunkx)
+    {
+        mMapChunks[chunky][chunkx].mLastUseFrame = mMapCollisionFrame;
+    }
+}
+
+bool PhysicsManager::IsMapCollisionBlock(int mapx, int mapz, int layer) const
+{
+    auto is_walkable = [](eGroundType gtype)
+    {
+        return gtype == eGroundType_Field || gtype == eGroundType_Pawement || gtype == eGroundType_Road;
+    };
+
+    BlockStyle* blockData = gGameMap.GetBlock(mapx, mapz, layer);
+    debug_assert(blockData);
+
+    if (blockData->mGroundType != eGroundType_Building)
+        return false;
+
+    // inner blocks are unreachable so they are ignored
+    BlockStyle* neighbourE = gGameMap.GetBlockClamp(mapx + 1, mapz, layer); 
+    BlockStyle* neighbourW = gGameMap.GetBlockClamp(mapx - 1, mapz, layer); 
+    BlockStyle* neighbourN = gGameMap.GetBlockClamp(mapx, mapz - 1, layer); 
+    BlockStyle* neighbourS = gGameMap.GetBlockClamp(mapx, mapz + 1, layer);
+
+    return is_walkable(neighbourE->mGroundType) || is_walkable(neighbourW->mGroundType) ||
+        is_walkable(neighbourN->mGroundType) || is_walkable(neighbourS->mGroundType);
+}
 
-        // checek blox is inner
+void PhysicsManager::GetMapChunkCollisionRects(int chunkx, int chunky, bool mergeBlocks, std::vector<MapCollisionRect>& outputRects) const
+{
+    const int chunkStartX = chunkx * MAP_CHUNK_DIMENSIONS;
+    const int chunkStartY = chunky * MAP_CHUNK_DIMENSIONS;
+
+    for (int layer = 0; layer < MAP_LAYERS_COUNT; ++layer)
+    {
+        // blocks which are solid and not yet covered by any rectangle
+        bool solidBlocks[MAP_CHUNK_DIMENSIONS][MAP_CHUNK_DIMENSIONS]; // y, x
+        for (int y = 0; y < MAP_CHUNK_DIMENSIONS; ++y)
+        for (int x = 0; x < MAP_CHUNK_DIMENSIONS; ++x)
         {
-            BlockStyle* neighbourE = gGameMap.GetBlockClamp(x + 1, y, layer); 
-            BlockStyle* neighbourW = gGameMap.GetBlockClamp(x - 1, y, layer); 
-            BlockStyle* neighbourN = gGameMap.GetBlockClamp(x, y - 1, layer); 
-            BlockStyle* neighbourS = gGameMap.GetBlockClamp(x, y + 1, layer);
+            solidBlocks[y][x] = IsMapCollisionBlock(chunkStartX + x, chunkStartY + y, layer);
+        }
+
+        for (int y = 0; y < MAP_CHUNK_DIMENSIONS; ++y)
+        for (int x = 0; x < MAP_CHUNK_DIMENSIONS; ++x)
+        {
+            if (!solidBlocks[y][x])
+                continue;
 
-            auto is_walkable = [](eGroundType gtype)
+            int sizex = 1;
+            int sizey = 1;
+            if (mergeBlocks)
             {
-                return gtype == eGroundType_Field || gtype == eGroundType_Pawement || gtype == eGroundType_Road;
-            };
+                // grow along x first, then grow whole row span along y
+                while (x + sizex < MAP_CHUNK_DIMENSIONS && solidBlocks[y][x + sizex])
+                {
+                    ++sizex;
+                }
+                for (; y + sizey < MAP_CHUNK_DIMENSIONS; ++sizey)
+                {
+                    bool isSolidRow = true;
+                    for (int ix = x; ix < x + sizex && isSolidRow; ++ix)
+                    {
+                        isSolidRow = solidBlocks[y + sizey][ix];
+                    }
+                    if (!isSolidRow)
+                        break;
+                }
+            }
 
-            if (!is_walkable(neighbourE->mGroundType) && !is_walkable(neighbourW->mGroundType) &&
-                !is_walkable(neighbourN->mGroundType) && !is_walkable(neighbourS->mGroundType))
+            for (int iy = y; iy < y + sizey; ++iy)
+            for (int ix = x; ix < x + sizex; ++ix)
             {
-                continue; // just ignore this block 
+                solidBlocks[iy][ix] = false;
             }
+
+            MapCollisionRect rect;
+            rect.mX = chunkStartX + x;
+            rect.mZ = chunkStartY + y;
+            rect.mSizeX = sizex;
+            rect.mSizeZ = sizey;
+            rect.mLayer = layer;
+            outputRects.push_back(rect);
         }
+    }
+}
 
-        b2PolygonShape b2shapeDef;
-        b2Vec2 center { 
-            ((x * MAP_BLOCK_LENGTH) + (MAP_BLOCK_LENGTH * 0.5f)) * PHYSICS_SCALE, 
-            ((y * MAP_BLOCK_LENGTH) + (MAP_BLOCK_LENGTH * 0.5f)) * PHYSICS_SCALE
-        };
-        b2shapeDef.SetAsBox(MAP_BLOCK_LENGTH * 0.5f * PHYSICS_SCALE, MAP_BLOCK_LENGTH * 0.5f * PHYSICS_SCALE, center, 0.0f);
+int PhysicsManager::GetMapCollisionFixturesCount() const
+{
+    int fixturesCount = 0;
+    for (int chunky = 0; chunky < MAP_CHUNKS_COUNT; ++chunky)
+    for (int chunkx = 0; chunkx < MAP_CHUNKS_COUNT; ++chunkx)
+    {
+        fixturesCount += (int) mMapChunks[chunky][chunkx].mFixtures.size();
+    }
+    return fixturesCount;
+}
 
-        b2FixtureData_map fixtureData;
-        fixtureData.mX = x;
-        fixtureData.mZ = y;
+int PhysicsManager::GetMapCollisionStreamedChunksCount() const
+{
+    int chunksCount = 0;
+    for (int chunky = 0; chunky < MAP_CHUNKS_COUNT; ++chunky)
+    for (int chunkx = 0; chunkx < MAP_CHUNKS_COUNT; ++chunkx)
+    {
+        if (mMapChunks[chunky][chunkx].mIsStreamed)
+        {
+            ++chunksCount;
+        }
+    }
+    return chunksCount;
+}
 
-        b2FixtureDef b2fixtureDef;
-        b2fixtureDef.density = 0.0f;
-        b2fixtureDef.shape = &b2shapeDef;
-        b2fixtureDef.userData = fixtureData.mAsPointer;
-        b2fixtureDef.filter.categoryBits = PHYSICS_OBJCAT_MAP_SOLID_BLOCK;
+void PhysicsManager::CreateMapChunkFixtures(int chunkx, int chunky)
+{
+    MapCollisionChunk& collisionChunk = mMapChunks[chunky][chunkx];
+    debug_assert(!collisionChunk.mIsStreamed);
+    debug_assert(collisionChunk.mFixtures.empty());
+
+    // adjacent blocks share single box fixture, this greatly reduces broadphase proxies count,
+    // rectangles are rebuilt only if map chunk was modified since chunk was streamed out
+    unsigned int chunkVersion = gGameMap.GetChunkVersion(chunkx, chunky);
+    if (!collisionChunk.mHasRects || collisionChunk.mRectsVersion != chunkVersion)
+    {
+        collisionChunk.mRects.clear();
+        GetMapChunkCollisionRects(chunkx, chunky, true, collisionChunk.mRects);
+        collisionChunk.mRectsVersion = chunkVersion;
+        collisionChunk.mHasRects = true;
+    }
 
-        b2Fixture* b2fixture = mMapCollisionShape->CreateFixture(&b2fixtureDef);
-        debug_assert(b2fixture);
+    collisionChunk.mIsStreamed = true;
+    for (const MapCollisionRect& currRect: collisionChunk.mRects)
+    {
+        b2Fixture* b2fixture = CreateMapCollisionFixture(currRect);
+        collisionChunk.mFixtures.push_back(b2fixture);
+    }
+}
+
+void PhysicsManager::UpdateMapChunkFixtures(int chunkx, int chunky)
+{
+    MapCollisionChunk& collisionChunk = mMapChunks[chunky][chunkx];
+    debug_assert(collisionChunk.mIsStreamed);
+    debug_assert(collisionChunk.mFixtures.size() == collisionChunk.mRects.size());
+
+    std::vector<MapCollisionRect> chunkRects;
+    GetMapChunkCollisionRects(chunkx, chunky, true, chunkRects);
+
+    // both lists are ordered by layer, then by first block row and column, so they are matched in single pass,
+    // fixtures of rectangles which were not affected by modification are kept as is
+    std::vector<b2Fixture*> chunkFixtures;
+    chunkFixtures.reserve(chunkRects.size());
+
+    size_t iprevious = 0;
+    for (const MapCollisionRect& currRect: chunkRects)
+    {
+        while (iprevious < collisionChunk.mRects.size() && map_collision_rect_less(collisionChunk.mRects[iprevious], currRect))
+        {
+            mMapCollisionShape->DestroyFixture(collisionChunk.mFixtures[iprevious]);
+            ++iprevious;
+        }
+
+        if (iprevious < collisionChunk.mRects.size() && map_collision_rect_equal(collisionChunk.mRects[iprevious], currRect))
+        {
+            chunkFixtures.push_back(collisionChunk.mFixtures[iprevious]);
+            ++iprevious;
+            continue;
+        }
+        chunkFixtures.push_back(CreateMapCollisionFixture(currRect));
+    }
 
-        ++numFixtures;
-        break; // single fixture per block column
+    for (; iprevious < collisionChunk.mRects.size(); ++iprevious)
+    {
+        mMapCollisionShape->DestroyFixture(collisionChunk.mFixtures[iprevious]);
+    }
+
+    collisionChunk.mRects.swap(chunkRects);
+    collisionChunk.mFixtures.swap(chunkFixtures);
+    collisionChunk.mRectsVersion = gGameMap.GetChunkVersion(chunkx, chunky);
+    collisionChunk.mHasRects = true;
+}
+
+b2Fixture* PhysicsManager::CreateMapCollisionFixture(const MapCollisionRect& rect)
+{
+    b2PolygonShape b2shapeDef;
+    b2Vec2 center { 
+        ((rect.mX + rect.mSizeX * 0.5f) * MAP_BLOCK_LENGTH) * PHYSICS_SCALE, 
+        ((rect.mZ + rect.mSizeZ * 0.5f) * MAP_BLOCK_LENGTH) * PHYSICS_SCALE
+    };
+    b2shapeDef.SetAsBox(rect.mSizeX * MAP_BLOCK_LENGTH * 0.5f * PHYSICS_SCALE, 
+        rect.mSizeZ * MAP_BLOCK_LENGTH * 0.5f * PHYSICS_SCALE, center, 0.0f);
+
+    b2FixtureData_map fixtureData;
+    fixtureData.mX = rect.mX;
+    fixtureData.mZ = rect.mZ;
+    fixtureData.mSizeX = rect.mSizeX;
+    fixtureData.mSizeZ = rect.mSizeZ;
+    fixtureData.mLayer = rect.mLayer;
+
+    b2FixtureDef b2fixtureDef;
+    b2fixtureDef.density = 0.0f;
+    b2fixtureDef.shape = &b2shapeDef;
+    b2fixtureDef.userData = fixtureData.mAsPointer;
+    // bodies on other layers are rejected in broadphase
+    b2fixtureDef.filter.categoryBits = PHYSICS_OBJCAT_MAP_SOLID_BLOCK | PHYSICS_OBJCAT_MAP_LAYER(rect.mLayer);
+
+    b2Fixture* b2fixture = mMapCollisionShape->CreateFixture(&b2fixtureDef);
+    debug_assert(b2fixture);
+    return b2fixture;
+}
+
+void PhysicsManager::DestroyMapChunkFixtures(int chunkx, int chunky)
+{
+    // fixtures memory is recycled by box2d block allocator, vector keeps its capacity for next time
+    MapCollisionChunk& collisionChunk = mMapChunks[chunky][chunkx];
+    for (b2Fixture* currFixture: collisionChunk.mFixtures)
+    {
+        mMapCollisionShape->DestroyFixture(currFixture);
     }
+    collisionChunk.mFixtures.clear();
+    collisionChunk.mIsStreamed = false;
 }
 
 void PhysicsManager::DestroyPhysicsComponent(PedPhysicsComponent* object)
@@ -186,16 +657,60 @@ void PhysicsManager::DestroyPhysicsComponent(WheelPhysicsComponent* object)
     mWheelsBodiesPool.destroy(object);
 }
 
+void PhysicsManager::InitContactHandlers()
+{
+    // object type is defined by lowest category bit, map layers bits are ignored
+    for (int icategory = 0; icategory <= PHYSICS_OBJCAT_TYPES; ++icategory)
+    {
+        mObjectTypes[icategory] = ePhysicsObjectType_COUNT;
+        for (int itype = 0; itype < ePhysicsObjectType_COUNT; ++itype)
+        {
+            if (icategory & (1 << itype))
+            {
+                mObjectTypes[icategory] = (ePhysicsObjectType) itype;
+                break;
+            }
+        }
+    }
+
+    for (int itypeA = 0; itypeA <= ePhysicsObjectType_COUNT; ++itypeA)
+    for (int itypeB = 0; itypeB <= ePhysicsObjectType_COUNT; ++itypeB)
+    {
+        mContactHandlers[itypeA][itypeB] = ContactHandlers();
+    }
+
+    RegisterContactHandlers(ePhysicsObjectType_Ped, ePhysicsObjectType_MapSolidBlock, &PhysicsManager::PreSolvePedestrian, nullptr);
+    RegisterContactHandlers(ePhysicsObjectType_Ped, ePhysicsObjectType_Wall, &PhysicsManager::PreSolvePedestrian, nullptr);
+    RegisterContactHandlers(ePhysicsObjectType_Ped, ePhysicsObjectType_MapObject, &PhysicsManager::PreSolvePedestrian, nullptr);
+    RegisterContactHandlers(ePhysicsObjectType_Ped, ePhysicsObjectType_Ped, &PhysicsManager::PreSolvePedestrian, nullptr);
+    RegisterContactHandlers(ePhysicsObjectType_Ped, ePhysicsObjectType_Car, &PhysicsManager::PreSolvePedestrianVsCar, nullptr);
+    RegisterContactHandlers(ePhysicsObjectType_PedSensor, ePhysicsObjectType_Car, nullptr, &PhysicsManager::HandlePedestrianSensorVsCar);
+}
+
+void PhysicsManager::RegisterContactHandlers(ePhysicsObjectType firstType, ePhysicsObjectType secondType, PreSolveHandler_t preSolve, SensorHandler_t sensor)
+{
+    ContactHandlers& handlers = mContactHandlers[firstType][secondType];
+    handlers.mPreSolve = preSolve;
+    handlers.mSensor = sensor;
+    handlers.mSwapFixtures = false;
+
+    if (firstType == secondType)
+        return;
+
+    ContactHandlers& swappedHandlers = mContactHandlers[secondType][firstType];
+    swappedHandlers.mPreSolve = preSolve;
+    swappedHandlers.mSensor = sensor;
+    swappedHandlers.mSwapFixtures = true;
+}
+
 void PhysicsManager::BeginContact(b2Contact* contact)
 {
-    if (ProcessSensorContact(contact, true))
-        return;
+    ProcessSensorContact(contact, true);
 }
 
 void PhysicsManager::EndContact(b2Contact* contact)
 {
-    if (ProcessSensorContact(contact, false))
-        return;
+    ProcessSensorContact(contact, false);
 }
 
 void PhysicsManager::PreSolve(b2Contact* contact, const b2Manifold* oldManifold)
@@ -203,64 +718,16 @@ void PhysicsManager::PreSolve(b2Contact* contact, const b2Manifold* oldManifold)
     b2Fixture* fixtureA = contact->GetFixtureA();
     b2Fixture* fixtureB = contact->GetFixtureB();
 
-    b2Fixture* fixtureMapSolidBlock = nullptr;
-    b2Fixture* fixturePed = nullptr;
-    b2Fixture* fixtureCar = nullptr;
-    if (fixtureA->GetFilterData().categoryBits == PHYSICS_OBJCAT_MAP_SOLID_BLOCK)
-    {
-        fixtureMapSolidBlock = fixtureA;
-    }
-    if (fixtureB->GetFilterData().categoryBits == PHYSICS_OBJCAT_MAP_SOLID_BLOCK)
-    {
-        fixtureMapSolidBlock = fixtureB;
-    }
+    ePhysicsObjectType typeA = GetObjectType(fixtureA);
+    ePhysicsObjectType typeB = GetObjectType(fixtureB);
 
-    if (fixtureA->GetFilterData().categoryBits == PHYSICS_OBJCAT_PED)
-    {
-        fixturePed = fixtureA;
-    }
-    if (fixtureB->GetFilterData().categoryBits == PHYSICS_OBJCAT_PED)
-    {
-        fixturePed = fixtureB;
-    }
-
-    if (fixtureA->GetFilterData().categoryBits == PHYSICS_OBJCAT_CAR)
-    {
-        fixtureCar = fixtureA;
-    }
-    if (fixtureB->GetFilterData().categoryBits == PHYSICS_OBJCAT_CAR)
-    {
-        fixtureCar = fixtureB;
-    }
-
-    bool hasCollision = true;
-    for (;;)
-    {
-        if (hasCollision && fixturePed)
-        {
-            PedPhysicsComponent* physicsComponent = (PedPhysicsComponent*) fixturePed->GetBody()->GetUserData();
-            debug_assert(physicsComponent);
-
-            hasCollision = physicsComponent->ShouldCollideWith((fixtureA != fixturePed ? fixtureA : fixtureB)->GetFilterData().categoryBits);
-        }
- 
-        if (hasCollision && fixtureMapSolidBlock && fixturePed)
-        {
-            b2FixtureData_map fxdata = fixtureMapSolidBlock->GetUserData();
-            PhysicsComponent* physicsObject = (PhysicsComponent*) fixturePed->GetBody()->GetUserData();
-            debug_assert(physicsObject);
-            // detect height
-            float height = gGameMap.GetHeightAtPosition(physicsObject->GetPosition());
-            hasCollision = HasCollisionPedestrianVsMap(fxdata.mX, fxdata.mZ, height);
-        }
+    const ContactHandlers& handlers = mContactHandlers[typeA][typeB];
+    if (handlers.mPreSolve == nullptr)
+        return;
 
-        if (hasCollision && fixtureCar && fixturePed)
-        {
-            hasCollision = HasCollisionPedestrianVsCar(contact, fixturePed, fixtureCar);
-        }
-
-        break;
-    }
+    bool hasCollision = handlers.mSwapFixtures ? 
+        (this->*handlers.mPreSolve)(contact, fixtureB, fixtureA, typeA) : 
+        (this->*handlers.mPreSolve)(contact, fixtureA, fixtureB, typeB);
 
     contact->SetEnabled(hasCollision);
 }
@@ -271,13 +738,31 @@ void PhysicsManager::PostSolve(b2Contact* contact, const b2ContactImpulse* impul
 
 void PhysicsManager::FixedStepPedsGravity()
 {
+    // query ground heights for all pedestrians at once
+    mPedsPositions.clear();
     for (Pedestrian* currPedestrian: gCarnageGame.mObjectsManager.mActivePedestriansList)
     {
+        if (currPedestrian->mSimulationLOD == eSimulationLOD_Dormant)
+            continue;
+
+        mPedsPositions.push_back(currPedestrian->mPhysicsComponent->GetPosition());
+    }
+
+    mPedsHeights.resize(mPedsPositions.size());
+    gGameMap.GetHeightAtPositions(mPedsPositions.data(), (int) mPedsPositions.size(), mPedsHeights.data());
+
+    int ipedestrian = 0;
+    for (Pedestrian* currPedestrian: gCarnageGame.mObjectsManager.mActivePedestriansList)
+    {
+        // dormant pedestrians are frozen in place
+        if (currPedestrian->mSimulationLOD == eSimulationLOD_Dormant)
+            continue;
+
         PedPhysicsComponent* pedestrianBody = currPedestrian->mPhysicsComponent;
-        glm::vec3 pedestrianPos = pedestrianBody->GetPosition();
+        glm::vec3 pedestrianPos = mPedsPositions[ipedestrian];
 
         // process falling
-        float newHeight = gGameMap.GetHeightAtPosition(pedestrianPos);
+        float newHeight = mPedsHeights[ipedestrian++];
 
         pedestrianBody->mOnTheGround = newHeight > pedestrianPos.y - 0.1f;
         if (pedestrianBody->mFalling)
@@ -295,98 +780,72 @@ void PhysicsManager::FixedStepPedsGravity()
             }
         }
 
+        // only height is changed, so there is no need to reset body transform
         if (!pedestrianBody->mOnTheGround)
         {
-            pedestrianPos.y -= (PHYSICS_SIMULATION_STEP / 2.0f);
+            pedestrianBody->mHeight -= (PHYSICS_SIMULATION_STEP / 2.0f);
         }
         else
         {
-            pedestrianPos.y = newHeight;
+            pedestrianBody->mHeight = newHeight;
         }
-
-        currPedestrian->SetPosition(pedestrianPos);
+        pedestrianBody->UpdateMapLayer();
     }
 }
 
-bool PhysicsManager::HasCollisionPedestrianVsMap(int mapx, int mapz, float height) const
+bool PhysicsManager::PreSolvePedestrian(b2Contact* contact, b2Fixture* fixturePed, b2Fixture* fixtureOther, ePhysicsObjectType otherType)
+{
+    PedPhysicsComponent* pedPhysicsObject = (PedPhysicsComponent*) fixturePed->GetUserData();
+    debug_assert(pedPhysicsObject);
+
+    return pedPhysicsObject->ShouldCollideWith(1 << otherType);
+}
+
+bool PhysicsManager::PreSolvePedestrianVsCar(b2Contact* contact, b2Fixture* fixturePed, b2Fixture* fixtureCar, ePhysicsObjectType carType)
 {
-    int map_layer = (int) (height + 0.5f);
+    if (!PreSolvePedestrian(contact, fixturePed, fixtureCar, carType))
+        return false;
 
-    // todo:
-    BlockStyle* blockData = gGameMap.GetBlockClamp(mapx, mapz, map_layer);
-    return (blockData->mGroundType == eGroundType_Building);
+    return HasCollisionPedestrianVsCar(contact, fixturePed, fixtureCar);
 }
 
 bool PhysicsManager::HasCollisionPedestrianVsCar(b2Contact* contact, b2Fixture* fixturePed, b2Fixture* fixtureCar)
 {
-    CarPhysicsComponent* carPhysicsObject = (CarPhysicsComponent*) fixtureCar->GetBody()->GetUserData();
-    PedPhysicsComponent* pedPhysicsObject = (PedPhysicsComponent*) fixturePed->GetBody()->GetUserData();
+    CarPhysicsComponent* carPhysicsObject = (CarPhysicsComponent*) fixtureCar->GetUserData();
+    PedPhysicsComponent* pedPhysicsObject = (PedPhysicsComponent*) fixturePed->GetUserData();
     return true;
 }
 
-bool PhysicsManager::ProcessSensorContact(b2Contact* contact, bool onBegin)
+void PhysicsManager::HandlePedestrianSensorVsCar(b2Contact* contact, b2Fixture* fixtureSensor, b2Fixture* fixtureCar, bool onBegin)
 {
-    b2Fixture* fixtureA = contact->GetFixtureA();
-    b2Fixture* fixtureB = contact->GetFixtureB();
-  
-    // make sure only one of the fixtures was a sensor
-    bool sensorA = fixtureA->IsSensor();
-    bool sensorB = fixtureB->IsSensor();
-    if (!(sensorA ^ sensorB))
-        return false;
+    PedPhysicsComponent* pedPhysicsObject = (PedPhysicsComponent*) fixtureSensor->GetUserData();
+    debug_assert(pedPhysicsObject);
 
-    PedPhysicsComponent* pedPhysicsComponent = nullptr;
-    CarPhysicsComponent* carPhysicsComponent = nullptr;
-    if (GetContactComponents(contact, pedPhysicsComponent, carPhysicsComponent))
+    if (onBegin)
     {
-        if (onBegin)
-        {
-            pedPhysicsComponent->HandleCarContactBegin();
-        }
-        else
-        {
-            pedPhysicsComponent->HandleCarContactEnd();
-        }
-        return true;
+        pedPhysicsObject->HandleCarContactBegin();
+    }
+    else
+    {
+        pedPhysicsObject->HandleCarContactEnd();
     }
-
-    return false;
 }
 
-bool PhysicsManager::GetContactComponents(b2Contact* contact, PedPhysicsComponent*& pedPhysicsObject, CarPhysicsComponent*& carPhysicsObject) const
+void PhysicsManager::ProcessSensorContact(b2Contact* contact, bool onBegin)
 {
     b2Fixture* fixtureA = contact->GetFixtureA();
     b2Fixture* fixtureB = contact->GetFixtureB();
 
-    b2Fixture* fixturePed = nullptr;
-    b2Fixture* fixtureCar = nullptr;
+    const ContactHandlers& handlers = mContactHandlers[GetObjectType(fixtureA)][GetObjectType(fixtureB)];
+    if (handlers.mSensor == nullptr)
+        return;
 
-    const b2Filter& filterA = fixtureA->GetFilterData();
-    if ((filterA.categoryBits == PHYSICS_OBJCAT_PED) || (filterA.categoryBits == PHYSICS_OBJCAT_PED_SENSOR))
-    {
-        fixturePed = fixtureA;
-    }
-    else if (filterA.categoryBits == PHYSICS_OBJCAT_CAR)
+    if (handlers.mSwapFixtures)
     {
-        fixtureCar = fixtureA;
+        (this->*handlers.mSensor)(contact, fixtureB, fixtureA, onBegin);
     }
-
-    const b2Filter& filterB = fixtureB->GetFilterData();
-    if ((filterB.categoryBits == PHYSICS_OBJCAT_PED) || (filterB.categoryBits == PHYSICS_OBJCAT_PED_SENSOR))
+    else
     {
-        fixturePed = fixtureB;
+        (this->*handlers.mSensor)(contact, fixtureA, fixtureB, onBegin);
     }
-    else if (filterB.categoryBits == PHYSICS_OBJCAT_CAR)
-    {
-        fixtureCar = fixtureB;
-    }
-
-    if (fixturePed == nullptr || fixtureCar == nullptr)
-        return false;
-
-    carPhysicsObject = (CarPhysicsComponent*) fixtureCar->GetBody()->GetUserData();
-    pedPhysicsObject = (PedPhysicsComponent*) fixturePed->GetBody()->GetUserData();
-
-    debug_assert(carPhysicsObject && pedPhysicsObject);
-    return true;
 }
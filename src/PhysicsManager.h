@@ -5,6 +5,41 @@
 #include "PhysicsDebugDraw.h"
 #include "PhysicsComponents.h"
 
+// fixed step simulation stats
+struct PhysicsSimulationStats
+{
+public:
+    int mFrameSteps = 0; // steps simulated during last frame
+    int mPendingSteps = 0; // steps left in accumulator after last frame
+    int mCatchUpFramesCount = 0; // frames which could not simulate all accumulated time
+    int mDropFramesCount = 0; // frames which dropped simulation time
+    float mDroppedTime = 0.0f; // total simulation time dropped, in seconds
+    int mContactsCount = 0; // contacts in world after last frame
+};
+
+// defines rectangular area of solid map blocks on same layer which share single collision fixture
+struct MapCollisionRect
+{
+public:
+    int mX = 0; // first block
+    int mZ = 0;
+    int mSizeX = 0; // number of blocks
+    int mSizeZ = 0;
+    int mLayer = 0;
+};
+
+// defines map collision state for map chunk, fixtures exist only while there are moving bodies nearby
+struct MapCollisionChunk
+{
+public:
+    std::vector<b2Fixture*> mFixtures;
+    std::vector<MapCollisionRect> mRects; // cached rectangles, reused when chunk gets streamed in again
+    unsigned int mRectsVersion = 0; // map chunk version rectangles were built for
+    unsigned int mLastUseFrame = 0;
+    bool mHasRects = false;
+    bool mIsStreamed = false; // fixtures are created
+};
+
 // this class manages physics and collision detections for map and objects
 class PhysicsManager final: private b2ContactListener
 {
@@ -13,8 +48,17 @@ public:
 
     bool Initialize();
     void Deinit();
+
+    // advance simulation by fixed steps, time which is not enough for whole step is kept for next frames
+    // @param deltaTime: Time since last frame
     void UpdateFrame(Timespan deltaTime);
 
+    // get blend factor between two last simulation steps for current frame, in range [0, 1],
+    // it is always 1 if render interpolation is disabled
+    float GetInterpolationFactor() const;
+
+    inline const PhysicsSimulationStats& GetSimulationStats() const { return mSimulationStats; }
+
     // create pedestrian specific physical body
     // @param pedestrian: Reference ped
     // @param position: Coord in world
@@ -37,31 +81,113 @@ public:
     void DestroyPhysicsComponent(CarPhysicsComponent* object);
     void DestroyPhysicsComponent(WheelPhysicsComponent* object);
 
+    // stream map collision fixtures in and out around moving bodies and rebuild fixtures for map chunks
+    // which were modified since last update, gets called automatically on each frame before simulation step
+    void UpdateMapCollisionShape();
+
+    // get collision rectangles for all layers of map chunk
+    // @param chunkx, chunky: Chunk location
+    // @param mergeBlocks: Merge adjacent solid blocks into larger rectangles, otherwise each block gets own rectangle
+    // @param outputRects: Output rectangles, existing contents is kept
+    void GetMapChunkCollisionRects(int chunkx, int chunky, bool mergeBlocks, std::vector<MapCollisionRect>& outputRects) const;
+
+    // write state of pedestrians and cars bodies and physics components into compact binary blob
+    // @param outputData: Output blob, existing contents is discarded
+    void SaveSnapshot(std::vector<unsigned char>& outputData) const;
+
+    // restore state of pedestrians and cars bodies from binary blob, objects which no longer exist are ignored,
+    // contacts are not stored and get regenerated from restored transforms on next simulation step
+    // @param snapshotData: Blob previously written by SaveSnapshot
+    // @returns false if blob is not valid
+    bool RestoreSnapshot(const std::vector<unsigned char>& snapshotData);
+
+    // get total number of map collision fixtures and number of map chunks which have fixtures created
+    int GetMapCollisionFixturesCount() const;
+    int GetMapCollisionStreamedChunksCount() const;
+
 private:
     // create level map body, used internally
     void CreateMapCollisionShape();
 
+    // check whether map block should have collision fixture
+    // @param mapx, mapz, layer: Block location
+    bool IsMapCollisionBlock(int mapx, int mapz, int layer) const;
+
+    // keep map collision chunks around position for current frame
+    // @param position: Body position
+    void UseMapCollisionArea(const glm::vec3& position);
+
+    // create or destroy collision fixtures for all blocks within map chunk
+    // @param chunkx, chunky: Chunk location
+    void CreateMapChunkFixtures(int chunkx, int chunky);
+    void DestroyMapChunkFixtures(int chunkx, int chunky);
+
+    // rebuild rectangles of modified map chunk and recreate only fixtures whose rectangles were changed
+    // @param chunkx, chunky: Chunk location
+    void UpdateMapChunkFixtures(int chunkx, int chunky);
+    b2Fixture* CreateMapCollisionFixture(const MapCollisionRect& rect);
+
     // apply gravity forces and correct y coord for objects
     void FixedStepPedsGravity();
 
+    // save objects transforms before simulation step, used for interpolation
+    void StorePreviousTransforms();
+
     // override b2ContactFilter
 	void BeginContact(b2Contact* contact) override;
 	void EndContact(b2Contact* contact) override;
 	void PreSolve(b2Contact* contact, const b2Manifold* oldManifold) override;
 	void PostSolve(b2Contact* contact, const b2ContactImpulse* impulse) override;
 
-    bool HasCollisionPedestrianVsMap(int mapx, int mapz, float height) const;
-    bool HasCollisionPedestrianVsCar(b2Contact* contact, b2Fixture* fixturePed, b2Fixture* fixtureCar);
+    // contact handlers, fixtures are passed in same order as object types were registered
+    // @param fixtureFirst, fixtureSecond: Contacting fixtures
+    // @param secondType: Object type of second fixture
+    // @returns false if contact should be disabled
+    using PreSolveHandler_t = bool (PhysicsManager::*)(b2Contact* contact, b2Fixture* fixtureFirst, b2Fixture* fixtureSecond, ePhysicsObjectType secondType);
+    using SensorHandler_t = void (PhysicsManager::*)(b2Contact* contact, b2Fixture* fixtureFirst, b2Fixture* fixtureSecond, bool onBegin);
+
+    struct ContactHandlers
+    {
+    public:
+        PreSolveHandler_t mPreSolve = nullptr;
+        SensorHandler_t mSensor = nullptr;
+        bool mSwapFixtures = false; // fixture B of contact should be passed first
+    };
+
+    // setup contact handlers dispatch table
+    void InitContactHandlers();
+    void RegisterContactHandlers(ePhysicsObjectType firstType, ePhysicsObjectType secondType, PreSolveHandler_t preSolve, SensorHandler_t sensor);
+
+    // get object type of fixture
+    inline ePhysicsObjectType GetObjectType(const b2Fixture* fixture) const
+    {
+        return mObjectTypes[fixture->GetFilterData().categoryBits & PHYSICS_OBJCAT_TYPES];
+    }
+
+    bool PreSolvePedestrian(b2Contact* contact, b2Fixture* fixturePed, b2Fixture* fixtureOther, ePhysicsObjectType otherType);
+    bool PreSolvePedestrianVsCar(b2Contact* contact, b2Fixture* fixturePed, b2Fixture* fixtureCar, ePhysicsObjectType carType);
+    void HandlePedestrianSensorVsCar(b2Contact* contact, b2Fixture* fixtureSensor, b2Fixture* fixtureCar, bool onBegin);
 
-    bool ProcessSensorContact(b2Contact* contact, bool onBegin);
+    bool HasCollisionPedestrianVsCar(b2Contact* contact, b2Fixture* fixturePed, b2Fixture* fixtureCar);
 
-    bool GetContactComponents(b2Contact* contact, PedPhysicsComponent*& pedPhysicsObject, CarPhysicsComponent*& carPhysicsObject) const;
+    void ProcessSensorContact(b2Contact* contact, bool onBegin);
 
 private:
     PhysicsDebugDraw mDebugDraw;
     b2Body* mMapCollisionShape;
+    MapCollisionChunk mMapChunks[MAP_CHUNKS_COUNT][MAP_CHUNKS_COUNT]; // y, x
+    unsigned int mMapCollisionFrame; // incremented on each map collision update
     b2World* mPhysicsWorld;
     float mSimulationTimeAccumulator;
+    PhysicsSimulationStats mSimulationStats;
+
+    // contact handlers indexed by object types of fixtures A and B
+    ContactHandlers mContactHandlers[ePhysicsObjectType_COUNT + 1][ePhysicsObjectType_COUNT + 1];
+    ePhysicsObjectType mObjectTypes[PHYSICS_OBJCAT_TYPES + 1]; // object type for category bits
+
+    // reusable buffers for batched ground height queries
+    std::vector<glm::vec3> mPedsPositions;
+    std::vector<float> mPedsHeights;
 
     // physics components pools
     cxx::object_pool<PedPhysicsComponent> mPedsBodiesPool;
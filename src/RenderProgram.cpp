@@ -105,10 +105,10 @@ void RenderProgram::UploadCameraTransformMatrices()
                 mGpuProgram->SetUniform(uniform_id, matrix_reference); \
             }
 
-        SET_UNIFORM(eRenderUniform_ViewMatrix, gCamera.mViewMatrix);
-        SET_UNIFORM(eRenderUniform_ProjectionMatrix, gCamera.mProjectionMatrix);
-        SET_UNIFORM(eRenderUniform_ViewProjectionMatrix, gCamera.mViewProjectionMatrix);
-        SET_UNIFORM(eRenderUniform_CameraPosition, gCamera.mPosition);
+        SET_UNIFORM(eRenderUniform_ViewMatrix, gRenderCamera.mViewMatrix);
+        SET_UNIFORM(eRenderUniform_ProjectionMatrix, gRenderCamera.mProjectionMatrix);
+        SET_UNIFORM(eRenderUniform_ViewProjectionMatrix, gRenderCamera.mViewProjectionMatrix);
+        SET_UNIFORM(eRenderUniform_CameraPosition, gRenderCamera.mPosition);
 
         #undef SET_UNIFORM
     }
@@ -0,0 +1,44 @@
+#include "stdafx.h"
+#include "RenderSnapshot.h"
+
+void RenderSnapshot::Clear()
+{
+    mPedestrians.clear();
+    mCars.clear();
+    mDestroyedObjects.clear();
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+RenderSnapshotsQueue::RenderSnapshotsQueue()
+    : mCaptureIndex()
+    , mLatestIndex(-1)
+{
+}
+
+void RenderSnapshotsQueue::Clear()
+{
+    for (RenderSnapshot& currSnapshot: mSnapshots)
+    {
+        currSnapshot.Clear();
+    }
+    mCaptureIndex = 0;
+    mLatestIndex = -1;
+}
+
+RenderSnapshot& RenderSnapshotsQueue::GetCaptureSnapshot()
+{
+    return mSnapshots[mCaptureIndex];
+}
+
+void RenderSnapshotsQueue::CommitCaptureSnapshot()
+{
+    // snapshot which was rendered last time gets reused for next capture
+    mLatestIndex = mCaptureIndex;
+    mCaptureIndex = (mCaptureIndex + 1) % RENDER_SNAPSHOTS_COUNT;
+}
+
+const RenderSnapshot* RenderSnapshotsQueue::GetLatestSnapshot() const
+{
+    return (mLatestIndex > -1) ? &mSnapshots[mLatestIndex] : nullptr;
+}
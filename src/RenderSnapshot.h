@@ -0,0 +1,59 @@
+#pragma once
+
+#include "GameDefs.h"
+#include "GameCamera.h"
+
+#define RENDER_SNAPSHOTS_COUNT 2 // one is captured by simulation while other is read by renderer
+
+// defines game object sprite state at the end of simulation frame
+struct SpriteDrawState
+{
+public:
+    GameObjectID_t mObjectID;
+    int mSpriteIndex;
+    SpriteDeltaBits_t mSpriteDeltaBits;
+    glm::vec3 mPosition; // y is draw height, interpolated between two last physics steps
+    cxx::angle_t mRotateAngle;
+};
+
+// defines immutable copy of game state required to render frame,
+// it is captured at the end of simulation frame and then read by renderer while next frame is simulated
+class RenderSnapshot final: public cxx::noncopyable
+{
+public:
+    GameCamera mCamera;
+
+    std::vector<SpriteDrawState> mPedestrians;
+    std::vector<SpriteDrawState> mCars;
+
+    // objects destroyed since previous snapshot, renderer must release their cached sprites
+    std::vector<GameObjectID_t> mDestroyedObjects;
+
+public:
+    // discard captured data
+    void Clear();
+};
+
+// defines ring of render snapshots shared between simulation and renderer
+class RenderSnapshotsQueue final: public cxx::noncopyable
+{
+public:
+    RenderSnapshotsQueue();
+
+    // discard all snapshots
+    void Clear();
+
+    // get snapshot which is filled by simulation, it is never read by renderer until committed
+    RenderSnapshot& GetCaptureSnapshot();
+
+    // make captured snapshot latest one, must be called when both simulation and rendering are idle
+    void CommitCaptureSnapshot();
+
+    // get snapshot available for rendering, returns null if there is no such snapshot yet
+    const RenderSnapshot* GetLatestSnapshot() const;
+
+private:
+    RenderSnapshot mSnapshots[RENDER_SNAPSHOTS_COUNT];
+    int mCaptureIndex;
+    int mLatestIndex;
+};
\ No newline at end of file
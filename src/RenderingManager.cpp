@@ -43,20 +43,35 @@ void RenderingManager::Deinit()
 {
     mDebugRenderer.Deinit();
     mMapRenderer.Deinit();
+    mSnapshots.Clear();
     gSpriteManager.Cleanup();
     FreeRenderPrograms();
 }
 
 void RenderingManager::RenderFrame()
 {
+    const RenderSnapshot* latestSnapshot = mSnapshots.GetLatestSnapshot();
+    if (latestSnapshot)
+    {
+        gRenderCamera.SetFromCamera(latestSnapshot->mCamera);
+
+        // sprites of destroyed objects are not referenced by snapshot anymore
+        for (GameObjectID_t currObjectID: latestSnapshot->mDestroyedObjects)
+        {
+            gSpriteManager.FlushSpritesCache(currObjectID);
+        }
+    }
+
     gGraphicsDevice.ClearScreen();
-    gCamera.ComputeMatricesAndFrustum();
+    gRenderCamera.ComputeMatricesAndFrustum();
     gSpriteManager.RenderFrameBegin();
-    mMapRenderer.RenderFrame();
+    if (latestSnapshot)
+    {
+        mMapRenderer.RenderFrame(*latestSnapshot);
+    }
     mDebugRenderer.RenderFrame();
     gGuiSystem.RenderFrame();
     gSpriteManager.RenderFrameEnd();
-    gGraphicsDevice.Present();
 }
 
 void RenderingManager::FreeRenderPrograms()
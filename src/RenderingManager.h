@@ -5,6 +5,7 @@
 #include "StreamingVertexCache.h"
 #include "MapRenderer.h"
 #include "DebugRenderer.h"
+#include "RenderSnapshot.h"
 
 // master render system, it is intended to manage rendering pipeline of the game
 class RenderingManager final: public cxx::noncopyable
@@ -19,6 +20,9 @@ public:
     MapRenderer mMapRenderer;
     DebugRenderer mDebugRenderer;
 
+    // game state captured by simulation, renderer never reads game objects directly
+    RenderSnapshotsQueue mSnapshots;
+
 public:
     RenderingManager();
 
@@ -31,7 +35,8 @@ public:
     // All loaded graphics resources must be destroyed here
     void Deinit();
 
-    // Render game frame routine
+    // Render game frame routine, does not present back buffer
+    // Draws latest committed snapshot, so it can run while next simulation frame is processed
     void RenderFrame();
 
     // Force reload all render programs
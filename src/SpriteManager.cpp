@@ -454,9 +454,12 @@ void SpriteManager::DumpSpriteDeltas(const char* outputLocation, int spriteIndex
 void SpriteManager::FlushSpritesCache()
 {
     // move all textures to pool
-    for (SpriteCacheElement& currElement: mSpritesCache)
+    for (std::vector<SpriteCacheElement>& objectSprites: mSpritesCache)
     {
-        mFreeSpriteTextures.push_back(currElement.mTexture);
+        for (SpriteCacheElement& currElement: objectSprites)
+        {
+            mFreeSpriteTextures.push_back(currElement.mTexture);
+        }
     }
 
     mSpritesCache.clear();
@@ -464,17 +467,22 @@ void SpriteManager::FlushSpritesCache()
 
 void SpriteManager::FlushSpritesCache(GameObjectID_t objectID)
 {
-    for (auto icurrent = mSpritesCache.begin(); icurrent != mSpritesCache.end(); )
+    int slotIndex = GetGameObjectSlotIndex(objectID);
+    if (slotIndex >= (int) mSpritesCache.size())
+        return;
+
+    std::vector<SpriteCacheElement>& objectSprites = mSpritesCache[slotIndex];
+    for (auto icurr = objectSprites.begin(); icurr != objectSprites.end(); )
     {
-        if (icurrent->mObjectID == objectID)
+        // slot could be already reused by another object at the moment when cache is flushed
+        if (icurr->mObjectID != objectID)
         {
-            // move texture to pool
-            mFreeSpriteTextures.push_back(icurrent->mTexture);
-
-            icurrent = mSpritesCache.erase(icurrent);
+            ++icurr;
             continue;
         }
-        ++icurrent;
+        // move texture to pool
+        mFreeSpriteTextures.push_back(icurr->mTexture);
+        icurr = objectSprites.erase(icurr);
     }
 }
 
@@ -508,7 +516,14 @@ void SpriteManager::GetSpriteTexture(GameObjectID_t objectID, int spriteIndex, S
     }
 
     // find sprite with deltas within cache
-    for (SpriteCacheElement& currElement: mSpritesCache)
+    int slotIndex = GetGameObjectSlotIndex(objectID);
+    if (slotIndex >= (int) mSpritesCache.size())
+    {
+        mSpritesCache.resize(slotIndex + 1);
+    }
+
+    std::vector<SpriteCacheElement>& objectSprites = mSpritesCache[slotIndex];
+    for (SpriteCacheElement& currElement: objectSprites)
     {
         if (currElement.mObjectID == objectID && currElement.mSpriteIndex == spriteIndex)
         {
@@ -583,7 +598,7 @@ void SpriteManager::GetSpriteTexture(GameObjectID_t objectID, int spriteIndex, S
     spriteCacheElement.mTexture = sourceSprite.mTexture;
     spriteCacheElement.mTextureRegion = sourceSprite.mTextureRegion;
 
-    mSpritesCache.push_back(spriteCacheElement);
+    objectSprites.push_back(spriteCacheElement);
 }
 
 void SpriteManager::GetSpriteTexture(GameObjectID_t objectID, int spriteIndex, Sprite& sourceSprite)
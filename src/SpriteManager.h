@@ -75,7 +75,7 @@ private:
     // usused sprite textures
     std::vector<GpuTexture2D*> mFreeSpriteTextures;
 
-    // cached sprite textures with deltas
+    // cached sprite textures with deltas, grouped by object slot index
     struct SpriteCacheElement
     {
     public:
@@ -85,7 +85,7 @@ private:
         GpuTexture2D* mTexture;
         TextureRegion mTextureRegion;
     };
-    std::vector<SpriteCacheElement> mSpritesCache;
+    std::vector<std::vector<SpriteCacheElement>> mSpritesCache;
 };
 
 extern SpriteManager gSpriteManager;
\ No newline at end of file
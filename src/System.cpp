@@ -4,6 +4,9 @@
 #include "RenderingManager.h"
 #include "MemoryManager.h"
 #include "CarnageGame.h"
+#include "TaskScheduler.h"
+#include "SpriteManager.h"
+#include "InputsRecorder.h"
 
 //////////////////////////////////////////////////////////////////////////
 
@@ -42,6 +45,9 @@ void SysConfig::SetParams(int screenSizex, int screenSizey, bool fullscreen, boo
 void SysStartupParameters::SetNull()
 {
     mDebugMapName.clear();
+    mRecordInputsPath.clear();
+    mReplayInputsPath.clear();
+    mHeadless = false;
 }
 
 //////////////////////////////////////////////////////////////////////////
@@ -61,7 +67,7 @@ void System::Execute(const SysStartupParameters& sysStartupParams)
         long mCurrentTimestamp = GetSysMilliseconds();
 
         Timespan deltaTime ( mCurrentTimestamp - mPreviousFrameTimestamp );
-        if (deltaTime < 1)
+        if (deltaTime < 1 && !gInputsRecorder.IsReplaying())
         {
             // small delay
             std::this_thread::sleep_for(std::chrono::milliseconds(1));
@@ -70,12 +76,52 @@ void System::Execute(const SysStartupParameters& sysStartupParams)
             deltaTime = 1;
         }
 
+        // recorded events are dispatched and delta time is replaced before any subsystem gets updated
+        if (!gInputsRecorder.BeginFrame(deltaTime))
+        {
+            QuitRequest(); // replay finished
+            continue;
+        }
+
         gMemoryManager.FlushFrameHeapMemory();
+        gTaskScheduler.ProcessMainThreadTasks();
+
+        if (mStartupParams.mHeadless)
+        {
+            gCarnageGame.UpdateFrame(deltaTime);
+        }
+        else
+        {
+            // order in which subsystems gets updated is significant
+            gGuiSystem.UpdateFrame(deltaTime);
+            gSpriteManager.UpdateBlocksAnimations(deltaTime);
+
+            const bool pipelinedFrames = (mConfig.mSimulationFrameLatency > 0 && gTaskScheduler.GetWorkersCount() > 1);
+            if (pipelinedFrames)
+            {
+                // simulate frame while previous one is rendered, renderer reads only committed snapshots
+                TaskCounter simulationCounter;
+                gTaskScheduler.Submit([this, deltaTime]()
+                    {
+                        SimulateFrame(deltaTime);
+                    },
+                    &simulationCounter);
+                gRenderManager.RenderFrame();
+                gTaskScheduler.Wait(simulationCounter);
+                gRenderManager.mSnapshots.CommitCaptureSnapshot();
+            }
+            else
+            {
+                SimulateFrame(deltaTime);
+                gRenderManager.mSnapshots.CommitCaptureSnapshot();
+                gRenderManager.RenderFrame();
+            }
+
+            // input events are dispatched during present, simulation must be idle at this point
+            gGraphicsDevice.Present();
+        }
+        gInputsRecorder.EndFrame();
 
-        // order in which subsystems gets updated is significant
-        gGuiSystem.UpdateFrame(deltaTime);
-        gCarnageGame.UpdateFrame(deltaTime);
-        gRenderManager.RenderFrame();
         mPreviousFrameTimestamp = mCurrentTimestamp;
         if (mIgnoreInputs) // ingore inputs at very first frame
         {
@@ -83,9 +129,22 @@ void System::Execute(const SysStartupParameters& sysStartupParams)
         }
     }
 
+    if (gInputsRecorder.IsReplaying())
+    {
+        gInputsRecorder.StopReplay();
+        gInputsRecorder.DumpReplayStats();
+    }
     Deinit();
 }
 
+void System::SimulateFrame(Timespan deltaTime)
+{
+    gCarnageGame.UpdateFrame(deltaTime);
+
+    RenderSnapshot& snapshot = gRenderManager.mSnapshots.GetCaptureSnapshot();
+    gCarnageGame.CaptureRenderSnapshot(snapshot);
+}
+
 void System::Initialize()
 {
     if (!gConsole.Initialize())
@@ -94,6 +153,12 @@ void System::Initialize()
     }
 
     gConsole.LogMessage(eLogMessage_Info, "System initialize");
+
+    if (mStartupParams.mHeadless && mStartupParams.mReplayInputsPath.empty())
+    {
+        gConsole.LogMessage(eLogMessage_Warning, "Headless mode requires inputs replay, ignored");
+        mStartupParams.mHeadless = false;
+    }
     
     if (!gFiles.Initialize())
     {
@@ -113,22 +178,31 @@ void System::Initialize()
         Terminate();
     }
 
-    if (!gGraphicsDevice.Initialize(mConfig.mScreenSizex, mConfig.mScreenSizey, mConfig.mFullscreen, mConfig.mEnableVSync))
+    if (!gTaskScheduler.Initialize())
     {
-        gConsole.LogMessage(eLogMessage_Error, "Cannot initialize graphics device");
+        gConsole.LogMessage(eLogMessage_Error, "Cannot initialize task scheduler");
         Terminate();
     }
 
-    if (!gRenderManager.Initialize())
-    {
-        gConsole.LogMessage(eLogMessage_Error, "Cannot initialize render system");
-        Terminate();
-    }
+    if (!mStartupParams.mHeadless)
+    {
+        if (!gGraphicsDevice.Initialize(mConfig.mScreenSizex, mConfig.mScreenSizey, mConfig.mFullscreen, mConfig.mEnableVSync))
+        {
+            gConsole.LogMessage(eLogMessage_Error, "Cannot initialize graphics device");
+            Terminate();
+        }
+
+        if (!gRenderManager.Initialize())
+        {
+            gConsole.LogMessage(eLogMessage_Error, "Cannot initialize render system");
+            Terminate();
+        }
 
-    if (!gGuiSystem.Initialize())
-    {
-        gConsole.LogMessage(eLogMessage_Error, "Cannot initialize gui system");
-        Terminate();
+        if (!gGuiSystem.Initialize())
+        {
+            gConsole.LogMessage(eLogMessage_Error, "Cannot initialize gui system");
+            Terminate();
+        }
     }
 
     if (!gCarnageGame.Initialize())
@@ -136,6 +210,25 @@ void System::Initialize()
         gConsole.LogMessage(eLogMessage_Error, "Cannot initialize game");
         Terminate();
     }
+
+    // session is recorded or replayed from game start so that simulation begins in same state
+    if (!mStartupParams.mReplayInputsPath.empty())
+    {
+        if (!mStartupParams.mRecordInputsPath.empty())
+        {
+            gConsole.LogMessage(eLogMessage_Warning, "Cannot record inputs during replay, ignored");
+        }
+
+        if (!gInputsRecorder.StartReplay(mStartupParams.mReplayInputsPath.c_str()))
+        {
+            gConsole.LogMessage(eLogMessage_Error, "Cannot start inputs replay");
+            Terminate();
+        }
+    }
+    else if (!mStartupParams.mRecordInputsPath.empty())
+    {
+        gInputsRecorder.StartRecording(mStartupParams.mRecordInputsPath.c_str());
+    }
     mQuitRequested = false;
 }
 
@@ -143,10 +236,15 @@ void System::Deinit()
 {
     gConsole.LogMessage(eLogMessage_Info, "System shutdown");
 
+    gInputsRecorder.StopRecording();
     gCarnageGame.Deinit();
-    gGuiSystem.Deinit();
-    gRenderManager.Deinit();
-    gGraphicsDevice.Deinit();
+    if (!mStartupParams.mHeadless)
+    {
+        gGuiSystem.Deinit();
+        gRenderManager.Deinit();
+        gGraphicsDevice.Deinit();
+    }
+    gTaskScheduler.Deinit();
     gMemoryManager.Deinit();
     gFiles.Deinit();
     gConsole.Deinit();
@@ -165,58 +263,66 @@ void System::QuitRequest()
 
 void System::HandleEvent(MouseButtonInputEvent& inputEvent)
 {
-    if (mIgnoreInputs)
+    if (mIgnoreInputs || gInputsRecorder.IsReplaying())
         return;
 
     gInputs.HandleEvent(inputEvent);
     gGuiSystem.HandleEvent(inputEvent);
+    gInputsRecorder.RecordEvent(inputEvent);
     gCarnageGame.InputEvent(inputEvent);
 }
 
 void System::HandleEvent(MouseMovedInputEvent& inputEvent)
 {
-    if (mIgnoreInputs)
+    if (mIgnoreInputs || gInputsRecorder.IsReplaying())
         return;
 
     gInputs.HandleEvent(inputEvent);
     gGuiSystem.HandleEvent(inputEvent);
+    gInputsRecorder.RecordEvent(inputEvent);
     gCarnageGame.InputEvent(inputEvent);
 }
 
 void System::HandleEvent(MouseScrollInputEvent& inputEvent)
 {
-    if (mIgnoreInputs)
+    if (mIgnoreInputs || gInputsRecorder.IsReplaying())
         return;
 
     gInputs.HandleEvent(inputEvent);
     gGuiSystem.HandleEvent(inputEvent);
+    gInputsRecorder.RecordEvent(inputEvent);
     gCarnageGame.InputEvent(inputEvent);
 }
 
 void System::HandleEvent(KeyInputEvent& inputEvent)
 {
-    if (mIgnoreInputs)
+    if (mIgnoreInputs || gInputsRecorder.IsReplaying())
         return;
 
     gInputs.HandleEvent(inputEvent);
     gGuiSystem.HandleEvent(inputEvent);
+    gInputsRecorder.RecordEvent(inputEvent);
     gCarnageGame.InputEvent(inputEvent);
 }
 
 void System::HandleEvent(KeyCharEvent& inputEvent)
 {
-    if (mIgnoreInputs)
+    if (mIgnoreInputs || gInputsRecorder.IsReplaying())
         return;
 
     gInputs.HandleEvent(inputEvent);
     gGuiSystem.HandleEvent(inputEvent);
+    gInputsRecorder.RecordEvent(inputEvent);
     gCarnageGame.InputEvent(inputEvent);
 }
 
 long System::GetSysMilliseconds() const
 {
-    double totalSeconds = ::glfwGetTime();
-    return static_cast<long>(totalSeconds * 1000.0);
+    // steady clock does not require graphics device to be initialized, so it works in headless mode
+    static const std::chrono::steady_clock::time_point SysStartTime = std::chrono::steady_clock::now();
+
+    std::chrono::milliseconds totalMilliseconds = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - SysStartTime);
+    return static_cast<long>(totalMilliseconds.count());
 }
 
 bool System::LoadConfiguration()
@@ -284,6 +390,19 @@ bool System::LoadConfiguration()
     {
         mConfig.mEnableFrameHeapAllocator = memConfig.get_child("enable_frame_heap_allocator").get_value_boolean();
     }
+
+    // cache
+    if (cxx::config_node cacheConfig = configDocument.get_root_node().get_child("cache"))
+    {
+        mConfig.mEnableMapCache = cacheConfig.get_child("enable_map_cache").get_value_boolean();
+    }
+
+    // simulation
+    if (cxx::config_node simulationConfig = configDocument.get_root_node().get_child("simulation"))
+    {
+        mConfig.mSimulationFrameLatency = glm::clamp(simulationConfig.get_child("frame_latency").get_value_integer(), 0, 1);
+        mConfig.mEnableRenderInterpolation = simulationConfig.get_child("render_interpolation").get_value_boolean();
+    }
     return true;
 }
 
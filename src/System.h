@@ -27,6 +27,11 @@ public:
     float mScreenAspectRatio = 1.0f;
     // memory settings
     bool mEnableFrameHeapAllocator = true;
+    // cache settings
+    bool mEnableMapCache = true; // store decoded map data in binary cache files
+    // simulation settings
+    int mSimulationFrameLatency = 1; // 0 - simulate and render frame serially, 1 - simulate next frame while current one is rendered
+    bool mEnableRenderInterpolation = true; // blend objects between two latest physics steps
 };
 
 // defines system startup parameters
@@ -40,6 +45,9 @@ public:
 
 public:
     cxx::string_buffer_16 mDebugMapName; // startup map name
+    std::string mRecordInputsPath; // record input events and frames delta time to file
+    std::string mReplayInputsPath; // replay recorded session and print frame time statistics
+    bool mHeadless = false; // simulate replayed session without window, rendering and gui
 };
 
 // Common system specific stuff collected in System class
@@ -75,6 +83,11 @@ private:
     void Initialize();
     void Deinit();
 
+    // process game logic and capture render snapshot
+    // @param deltaTime: Time since last frame
+    // @param frameTimestamp: System milliseconds when frame has started
+    void SimulateFrame(Timespan deltaTime);
+
     // Save/Load configuration to/from external file
     bool LoadConfiguration();
     bool SaveConfiguration();
@@ -0,0 +1,277 @@
+#include "stdafx.h"
+#include "TaskScheduler.h"
+
+TaskScheduler gTaskScheduler;
+
+// index of worker queue owned by current thread, -1 for threads which are not scheduler workers
+static thread_local int CurrentWorkerIndex = -1;
+
+TaskScheduler::TaskScheduler()
+    : mWorkersCount(1)
+    , mQueuedTasksCount(0)
+    , mSleepingWorkersCount(0)
+    , mQuitRequested()
+{
+}
+
+bool TaskScheduler::Initialize()
+{
+    debug_assert(mWorkerThreads.empty());
+
+    mMainThreadID = std::this_thread::get_id();
+    CurrentWorkerIndex = 0;
+
+    int numHardwareThreads = (int) std::thread::hardware_concurrency();
+    mWorkersCount = glm::clamp(numHardwareThreads, 1, TASK_SCHEDULER_MAX_WORKERS);
+    mQuitRequested = false;
+
+    for (int iworker = 1; iworker < mWorkersCount; ++iworker)
+    {
+        mWorkerThreads.emplace_back(&TaskScheduler::WorkerThreadProc, this, iworker);
+    }
+
+    gConsole.LogMessage(eLogMessage_Info, "Task scheduler workers: %d", mWorkersCount);
+    return true;
+}
+
+void TaskScheduler::Deinit()
+{
+    {
+        std::lock_guard<std::mutex> lock (mWakeMutex);
+        mQuitRequested = true;
+    }
+    mWakeCondition.notify_all();
+
+    for (std::thread& currentThread: mWorkerThreads)
+    {
+        currentThread.join();
+    }
+    mWorkerThreads.clear();
+
+    // finish remaining tasks so that counters reach zero
+    while (ExecuteNextTask(0))
+    {
+    }
+    ProcessMainThreadTasks();
+
+    mWorkersCount = 1;
+}
+
+void TaskScheduler::Submit(TaskProcedure_t procedure, TaskCounter* completionCounter, TaskCounter* dependencyCounter, eTaskAffinity affinity)
+{
+    debug_assert(procedure);
+
+    TaskDesc task;
+    task.mProcedure = std::move(procedure);
+    task.mCompletionCounter = completionCounter;
+    task.mAffinity = affinity;
+
+    if (completionCounter)
+    {
+        ++completionCounter->mUnfinishedTasks;
+    }
+
+    if (dependencyCounter)
+    {
+        std::lock_guard<std::mutex> lock (dependencyCounter->mWaitingTasksMutex);
+        if (!dependencyCounter->IsDone())
+        {
+            // task will be queued once dependency is finished
+            dependencyCounter->mWaitingTasks.push_back(std::move(task));
+            return;
+        }
+    }
+    QueueTask(task);
+}
+
+void TaskScheduler::Wait(TaskCounter& counter)
+{
+    while (!counter.IsDone())
+    {
+        if (!ExecuteNextTask(CurrentWorkerIndex))
+        {
+            std::this_thread::yield();
+        }
+    }
+    // make sure that thread which finished last task does not touch counter anymore
+    std::lock_guard<std::mutex> lock (counter.mWaitingTasksMutex);
+}
+
+void TaskScheduler::ParallelFor(int count, int batchSize, const TaskRangeProcedure_t& procedure)
+{
+    if (count < 1)
+        return;
+
+    batchSize = glm::max(batchSize, 1);
+    if (count <= batchSize || mWorkersCount < 2)
+    {
+        procedure(0, count);
+        return;
+    }
+
+    TaskCounter counter;
+    for (int rangeBegin = batchSize; rangeBegin < count; rangeBegin += batchSize)
+    {
+        int rangeEnd = glm::min(rangeBegin + batchSize, count);
+        Submit([&procedure, rangeBegin, rangeEnd]()
+            {
+                procedure(rangeBegin, rangeEnd);
+            },
+            &counter);
+    }
+
+    // process first batch on current thread
+    procedure(0, batchSize);
+    Wait(counter);
+}
+
+void TaskScheduler::ProcessMainThreadTasks()
+{
+    debug_assert(IsMainThread());
+
+    // tasks submitted during processing will be executed on next call
+    {
+        std::lock_guard<std::mutex> lock (mMainThreadTasksMutex);
+        mMainThreadTasksBuffer.assign(std::make_move_iterator(mMainThreadTasks.begin()), std::make_move_iterator(mMainThreadTasks.end()));
+        mMainThreadTasks.clear();
+    }
+
+    for (TaskDesc& currentTask: mMainThreadTasksBuffer)
+    {
+        ExecuteTask(currentTask);
+    }
+    mMainThreadTasksBuffer.clear();
+}
+
+bool TaskScheduler::IsMainThread() const
+{
+    return std::this_thread::get_id() == mMainThreadID;
+}
+
+void TaskScheduler::WorkerThreadProc(int workerIndex)
+{
+    CurrentWorkerIndex = workerIndex;
+
+    for (;;)
+    {
+        if (ExecuteNextTask(workerIndex))
+            continue;
+
+        std::unique_lock<std::mutex> lock (mWakeMutex);
+        ++mSleepingWorkersCount;
+        mWakeCondition.wait(lock, [this]()
+            {
+                return mQuitRequested || mQueuedTasksCount > 0;
+            });
+        --mSleepingWorkersCount;
+
+        if (mQuitRequested)
+            break;
+    }
+}
+
+void TaskScheduler::QueueTask(TaskDesc& task)
+{
+    if (task.mAffinity == eTaskAffinity_MainThread)
+    {
+        std::lock_guard<std::mutex> lock (mMainThreadTasksMutex);
+        mMainThreadTasks.push_back(std::move(task));
+        return;
+    }
+
+    // threads which are not workers are pushing tasks to main thread queue
+    WorkerQueue& workerQueue = mWorkerQueues[CurrentWorkerIndex > -1 ? CurrentWorkerIndex : 0];
+    {
+        std::lock_guard<std::mutex> lock (workerQueue.mMutex);
+        workerQueue.mTasks.push_back(std::move(task));
+    }
+    ++mQueuedTasksCount;
+
+    // worker checks queued tasks count after it is registered as sleeping, so wakeup cannot be lost
+    if (mSleepingWorkersCount > 0)
+    {
+        {
+            std::lock_guard<std::mutex> lock (mWakeMutex);
+        }
+        mWakeCondition.notify_one();
+    }
+}
+
+bool TaskScheduler::PopTask(int workerIndex, TaskDesc& task)
+{
+    // own queue first, most recent task is likely to have its data in cache
+    if (workerIndex > -1)
+    {
+        WorkerQueue& workerQueue = mWorkerQueues[workerIndex];
+        std::lock_guard<std::mutex> lock (workerQueue.mMutex);
+        if (!workerQueue.mTasks.empty())
+        {
+            task = std::move(workerQueue.mTasks.back());
+            workerQueue.mTasks.pop_back();
+            --mQueuedTasksCount;
+            return true;
+        }
+    }
+
+    // steal oldest task from other workers
+    for (int ioffset = 1; ioffset <= mWorkersCount; ++ioffset)
+    {
+        int victimIndex = (glm::max(workerIndex, 0) + ioffset) % mWorkersCount;
+        if (victimIndex == workerIndex)
+            continue;
+
+        WorkerQueue& workerQueue = mWorkerQueues[victimIndex];
+        std::lock_guard<std::mutex> lock (workerQueue.mMutex);
+        if (!workerQueue.mTasks.empty())
+        {
+            task = std::move(workerQueue.mTasks.front());
+            workerQueue.mTasks.pop_front();
+            --mQueuedTasksCount;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool TaskScheduler::ExecuteNextTask(int workerIndex)
+{
+    TaskDesc task;
+    if (IsMainThread())
+    {
+        std::lock_guard<std::mutex> lock (mMainThreadTasksMutex);
+        if (!mMainThreadTasks.empty())
+        {
+            task = std::move(mMainThreadTasks.front());
+            mMainThreadTasks.pop_front();
+        }
+    }
+
+    if (!task.mProcedure && !PopTask(workerIndex, task))
+        return false;
+
+    ExecuteTask(task);
+    return true;
+}
+
+void TaskScheduler::ExecuteTask(TaskDesc& task)
+{
+    task.mProcedure();
+
+    TaskCounter* counter = task.mCompletionCounter;
+    if (counter == nullptr)
+        return;
+
+    std::vector<TaskDesc> readyTasks;
+    {
+        std::lock_guard<std::mutex> lock (counter->mWaitingTasksMutex);
+        if (--counter->mUnfinishedTasks > 0)
+            return;
+
+        readyTasks.swap(counter->mWaitingTasks);
+    }
+
+    for (TaskDesc& currentTask: readyTasks)
+    {
+        QueueTask(currentTask);
+    }
+}
\ No newline at end of file
@@ -0,0 +1,125 @@
+#pragma once
+
+#define TASK_SCHEDULER_MAX_WORKERS 32 // including main thread
+
+class TaskCounter;
+
+using TaskProcedure_t = std::function<void()>;
+using TaskRangeProcedure_t = std::function<void(int rangeBegin, int rangeEnd)>;
+
+// task execution thread affinity
+enum eTaskAffinity
+{
+    eTaskAffinity_Any, // task may be executed by any worker including main thread
+    eTaskAffinity_MainThread, // task is executed only by main thread
+};
+
+// scheduled task
+struct TaskDesc
+{
+public:
+    TaskProcedure_t mProcedure;
+    TaskCounter* mCompletionCounter = nullptr;
+    eTaskAffinity mAffinity = eTaskAffinity_Any;
+};
+
+// defines number of unfinished tasks, used to wait for tasks completion and to build tasks dependencies
+// counter must stay alive until it reaches zero
+class TaskCounter final: public cxx::noncopyable
+{
+    friend class TaskScheduler;
+
+public:
+    ~TaskCounter()
+    {
+        debug_assert(IsDone());
+    }
+    // test whether all tasks associated with counter are finished
+    inline bool IsDone() const
+    {
+        return mUnfinishedTasks.load() == 0;
+    }
+
+private:
+    std::atomic<int> mUnfinishedTasks {0};
+    std::mutex mWaitingTasksMutex;
+    std::vector<TaskDesc> mWaitingTasks; // tasks that depend on this counter
+};
+
+// defines work stealing tasks scheduler,
+// each worker thread owns tasks queue, it pushes and pops tasks at back while idle workers steal tasks from front,
+// main thread participates as worker while it waits for tasks completion
+class TaskScheduler final: public cxx::noncopyable
+{
+public:
+    TaskScheduler();
+
+    // start worker threads, should be called from main thread
+    bool Initialize();
+
+    // stop worker threads, unfinished tasks are executed on main thread
+    void Deinit();
+
+    // schedule task for execution
+    // @param procedure: Task procedure
+    // @param completionCounter: Optional counter which is decremented when task is finished
+    // @param dependencyCounter: Optional counter, task will not start until it reaches zero
+    // @param affinity: Task thread affinity
+    void Submit(TaskProcedure_t procedure, TaskCounter* completionCounter = nullptr,
+        TaskCounter* dependencyCounter = nullptr, eTaskAffinity affinity = eTaskAffinity_Any);
+
+    // wait until counter reaches zero, current thread executes pending tasks meanwhile
+    // @param counter: Tasks counter
+    void Wait(TaskCounter& counter);
+
+    // split range into batches and process them in parallel, returns when whole range is processed
+    // @param count: Number of elements in range
+    // @param batchSize: Max number of elements per task
+    // @param procedure: Batch procedure
+    void ParallelFor(int count, int batchSize, const TaskRangeProcedure_t& procedure);
+
+    // execute pending tasks with main thread affinity, should be called once per frame
+    void ProcessMainThreadTasks();
+
+    // get number of workers including main thread
+    inline int GetWorkersCount() const { return mWorkersCount; }
+
+    // test whether current thread is main thread
+    bool IsMainThread() const;
+
+private:
+    void WorkerThreadProc(int workerIndex);
+
+    void QueueTask(TaskDesc& task);
+    bool PopTask(int workerIndex, TaskDesc& task);
+    bool ExecuteNextTask(int workerIndex);
+    void ExecuteTask(TaskDesc& task);
+
+private:
+    // worker tasks queue
+    struct WorkerQueue
+    {
+    public:
+        std::mutex mMutex;
+        std::deque<TaskDesc> mTasks;
+    };
+
+    WorkerQueue mWorkerQueues[TASK_SCHEDULER_MAX_WORKERS]; // first queue belongs to main thread
+    int mWorkersCount;
+
+    std::mutex mMainThreadTasksMutex;
+    std::deque<TaskDesc> mMainThreadTasks;
+    std::vector<TaskDesc> mMainThreadTasksBuffer;
+
+    std::vector<std::thread> mWorkerThreads;
+    std::thread::id mMainThreadID;
+
+    // idle workers are sleeping until new tasks arrive
+    std::mutex mWakeMutex;
+    std::condition_variable mWakeCondition;
+    std::atomic<int> mQueuedTasksCount;
+    std::atomic<int> mSleepingWorkersCount;
+    bool mQuitRequested;
+};
+
+extern TaskScheduler gTaskScheduler;
\ No newline at end of file
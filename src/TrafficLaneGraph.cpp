@@ -0,0 +1,351 @@
+#include "stdafx.h"
+#include "TrafficLaneGraph.h"
+#include "GameMapManager.h"
+
+#define TRAFFIC_BLOCKS_COUNT (MAP_DIMENSIONS * MAP_DIMENSIONS * MAP_LAYERS_COUNT)
+
+static const int TrafficDirectionOffsets[eTrafficDirection_COUNT][2] = {
+    {0, -1}, {0, 1}, {-1, 0}, {1, 0},
+};
+
+static const eTrafficDirection OppositeTrafficDirections[eTrafficDirection_COUNT] = {
+    eTrafficDirection_Down, eTrafficDirection_Up, eTrafficDirection_Right, eTrafficDirection_Left,
+};
+
+inline int get_block_linear_index(int coordx, int coordy, int layer)
+{
+    return (layer * MAP_DIMENSIONS + coordy) * MAP_DIMENSIONS + coordx;
+}
+
+inline void get_block_location(int blockIndex, int& coordx, int& coordy, int& layer)
+{
+    coordx = blockIndex % MAP_DIMENSIONS;
+    coordy = (blockIndex / MAP_DIMENSIONS) % MAP_DIMENSIONS;
+    layer = blockIndex / (MAP_DIMENSIONS * MAP_DIMENSIONS);
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+bool TrafficLaneGraph::Build()
+{
+    Cleanup();
+
+    BlockLanes emptyLanes;
+    for (int& currSegment: emptyLanes.mSegments)
+    {
+        currSegment = -1;
+    }
+
+    // collect road blocks
+    mBlocksLanesIndices.resize(TRAFFIC_BLOCKS_COUNT, -1);
+    for (int layer = 0; layer < MAP_LAYERS_COUNT; ++layer)
+    for (int coordy = 0; coordy < MAP_DIMENSIONS; ++coordy)
+    for (int coordx = 0; coordx < MAP_DIMENSIONS; ++coordx)
+    {
+        if (GetBlockDirections(coordx, coordy, layer) == 0)
+            continue;
+
+        mBlocksLanesIndices[get_block_linear_index(coordx, coordy, layer)] = (int) mBlocksLanes.size();
+        mBlocksLanes.push_back(emptyLanes);
+    }
+
+    // count incoming lanes for each road block to detect merges
+    std::vector<unsigned char> incomingCounts(TRAFFIC_BLOCKS_COUNT, 0);
+    for (int iblock = 0; iblock < TRAFFIC_BLOCKS_COUNT; ++iblock)
+    {
+        if (mBlocksLanesIndices[iblock] == -1)
+            continue;
+
+        int coordx;
+        int coordy;
+        int layer;
+        get_block_location(iblock, coordx, coordy, layer);
+
+        unsigned int directions = GetBlockDirections(coordx, coordy, layer);
+        for (int idirection = 0; idirection < eTrafficDirection_COUNT; ++idirection)
+        {
+            if ((directions & (1 << idirection)) == 0)
+                continue;
+
+            int exitBlock = FindExitBlock(iblock, (eTrafficDirection) idirection);
+            if (exitBlock != -1 && incomingCounts[exitBlock] < 255)
+            {
+                ++incomingCounts[exitBlock];
+            }
+        }
+    }
+
+    // chain block has single traffic direction and single incoming lane, chain blocks form segments
+    auto is_chain_block = [this, &incomingCounts](int blockIndex, eTrafficDirection direction)
+    {
+        int coordx;
+        int coordy;
+        int layer;
+        get_block_location(blockIndex, coordx, coordy, layer);
+        return GetBlockDirections(coordx, coordy, layer) == (1u << direction) && incomingCounts[blockIndex] < 2;
+    };
+
+    auto get_chain_continuation = [this, &is_chain_block](int blockIndex, eTrafficDirection direction)
+    {
+        int exitBlock = FindExitBlock(blockIndex, direction);
+        if (exitBlock == -1 || !is_chain_block(exitBlock, direction))
+            return -1;
+
+        // segment stays on single layer
+        if (exitBlock / (MAP_DIMENSIONS * MAP_DIMENSIONS) != blockIndex / (MAP_DIMENSIONS * MAP_DIMENSIONS))
+            return -1;
+
+        return exitBlock;
+    };
+
+    std::vector<bool> hasPredecessor(TRAFFIC_BLOCKS_COUNT, false);
+    for (int iblock = 0; iblock < TRAFFIC_BLOCKS_COUNT; ++iblock)
+    {
+        if (mBlocksLanesIndices[iblock] == -1)
+            continue;
+
+        for (int idirection = 0; idirection < eTrafficDirection_COUNT; ++idirection)
+        {
+            if (!is_chain_block(iblock, (eTrafficDirection) idirection))
+                continue;
+
+            int nextBlock = get_chain_continuation(iblock, (eTrafficDirection) idirection);
+            if (nextBlock != -1)
+            {
+                hasPredecessor[nextBlock] = true;
+            }
+        }
+    }
+
+    auto add_segment = [this, &get_chain_continuation](int startBlock, eTrafficDirection direction, bool isJunction)
+    {
+        int coordx;
+        int coordy;
+        int layer;
+        get_block_location(startBlock, coordx, coordy, layer);
+
+        const int segmentIndex = (int) mSegments.size();
+
+        TrafficLaneSegment segment;
+        segment.mFirstNextSegment = 0;
+        segment.mLength = 0;
+        segment.mStartX = (unsigned char) coordx;
+        segment.mStartY = (unsigned char) coordy;
+        segment.mLayer = (unsigned char) layer;
+        segment.mNextSegmentsCount = 0;
+        segment.mDirection = direction;
+        segment.mIsJunction = isJunction;
+
+        for (int currBlock = startBlock; currBlock != -1 && segment.mLength < 0xFFFF; )
+        {
+            BlockLanes& blockLanes = mBlocksLanes[mBlocksLanesIndices[currBlock]];
+            if (blockLanes.mSegments[direction] != -1) // closed loop
+                break;
+
+            blockLanes.mSegments[direction] = segmentIndex;
+            ++segment.mLength;
+            if (isJunction)
+                break;
+
+            currBlock = get_chain_continuation(currBlock, direction);
+        }
+        mSegments.push_back(segment);
+    };
+
+    // segments starts at junctions and at chain blocks without predecessor, remaining chain blocks are closed loops
+    for (int ipass = 0; ipass < 2; ++ipass)
+    {
+        for (int iblock = 0; iblock < TRAFFIC_BLOCKS_COUNT; ++iblock)
+        {
+            if (mBlocksLanesIndices[iblock] == -1)
+                continue;
+
+            int coordx;
+            int coordy;
+            int layer;
+            get_block_location(iblock, coordx, coordy, layer);
+
+            unsigned int directions = GetBlockDirections(coordx, coordy, layer);
+            for (int idirection = 0; idirection < eTrafficDirection_COUNT; ++idirection)
+            {
+                const eTrafficDirection direction = (eTrafficDirection) idirection;
+                if ((directions & (1 << idirection)) == 0 ||
+                    mBlocksLanes[mBlocksLanesIndices[iblock]].mSegments[direction] != -1)
+                {
+                    continue;
+                }
+
+                const bool isChainBlock = is_chain_block(iblock, direction);
+                if (ipass == 0 && isChainBlock && hasPredecessor[iblock])
+                    continue;
+
+                add_segment(iblock, direction, !isChainBlock);
+            }
+        }
+    }
+
+    // link segments
+    for (TrafficLaneSegment& currSegment: mSegments)
+    {
+        currSegment.mFirstNextSegment = (int) mNextSegments.size();
+
+        const int lastBlock = get_block_linear_index(
+            currSegment.mStartX + TrafficDirectionOffsets[currSegment.mDirection][0] * (currSegment.mLength - 1),
+            currSegment.mStartY + TrafficDirectionOffsets[currSegment.mDirection][1] * (currSegment.mLength - 1),
+            currSegment.mLayer);
+
+        int exitBlock = FindExitBlock(lastBlock, currSegment.mDirection);
+        if (exitBlock == -1)
+            continue;
+
+        const BlockLanes& exitLanes = mBlocksLanes[mBlocksLanesIndices[exitBlock]];
+        for (int idirection = 0; idirection < eTrafficDirection_COUNT; ++idirection)
+        {
+            if (idirection == OppositeTrafficDirections[currSegment.mDirection] || exitLanes.mSegments[idirection] == -1)
+                continue;
+
+            // lanes are entered only at segment start
+            const TrafficLaneSegment& nextSegment = mSegments[exitLanes.mSegments[idirection]];
+            if (get_block_linear_index(nextSegment.mStartX, nextSegment.mStartY, nextSegment.mLayer) != exitBlock)
+                continue;
+
+            mNextSegments.push_back(exitLanes.mSegments[idirection]);
+            ++currSegment.mNextSegmentsCount;
+        }
+    }
+
+    gConsole.LogMessage(eLogMessage_Debug, "Traffic lanes built: %d road blocks, %d segments",
+        (int) mBlocksLanes.size(), GetSegmentsCount());
+    return true;
+}
+
+void TrafficLaneGraph::Cleanup()
+{
+    mSegments.clear();
+    mNextSegments.clear();
+    mBlocksLanesIndices.clear();
+    mBlocksLanes.clear();
+}
+
+bool TrafficLaneGraph::IsBuilt() const
+{
+    return !mBlocksLanesIndices.empty();
+}
+
+unsigned int TrafficLaneGraph::GetBlockDirections(int coordx, int coordy, int layer) const
+{
+    BlockStyle* blockData = gGameMap.GetBlock(coordx, coordy, layer);
+
+    unsigned int directions = 0;
+    if (blockData->mUpDirection) directions |= (1 << eTrafficDirection_Up);
+    if (blockData->mDownDirection) directions |= (1 << eTrafficDirection_Down);
+    if (blockData->mLeftDirection) directions |= (1 << eTrafficDirection_Left);
+    if (blockData->mRightDirection) directions |= (1 << eTrafficDirection_Right);
+    return directions;
+}
+
+int TrafficLaneGraph::FindExitBlock(int blockIndex, eTrafficDirection direction) const
+{
+    int coordx;
+    int coordy;
+    int layer;
+    get_block_location(blockIndex, coordx, coordy, layer);
+
+    coordx += TrafficDirectionOffsets[direction][0];
+    coordy += TrafficDirectionOffsets[direction][1];
+    if (coordx < 0 || coordx >= MAP_DIMENSIONS || coordy < 0 || coordy >= MAP_DIMENSIONS)
+        return -1;
+
+    static const int LayerOffsets[] = { 0, 1, -1 };
+    for (int layerOffset: LayerOffsets)
+    {
+        int exitLayer = layer + layerOffset;
+        if (exitLayer < 0 || exitLayer >= MAP_LAYERS_COUNT)
+            continue;
+
+        int exitBlock = get_block_linear_index(coordx, coordy, exitLayer);
+        if (mBlocksLanesIndices[exitBlock] != -1)
+            return exitBlock;
+    }
+    return -1;
+}
+
+int TrafficLaneGraph::FindSegment(int coordx, int coordy, int layer, eTrafficDirection direction) const
+{
+    if (coordx < 0 || coordx >= MAP_DIMENSIONS || coordy < 0 || coordy >= MAP_DIMENSIONS ||
+        layer < 0 || layer >= MAP_LAYERS_COUNT || mBlocksLanesIndices.empty())
+    {
+        return -1;
+    }
+
+    int lanesIndex = mBlocksLanesIndices[get_block_linear_index(coordx, coordy, layer)];
+    if (lanesIndex == -1)
+        return -1;
+
+    return mBlocksLanes[lanesIndex].mSegments[direction];
+}
+
+int TrafficLaneGraph::FindSegment(const glm::vec3& position, const glm::vec2& heading) const
+{
+    int coordx = (int) position.x;
+    int coordy = (int) position.z;
+    int layer = (int) (position.y + 0.5f);
+
+    // vehicles on slopes may be slightly above or below its layer
+    static const int LayerOffsets[] = { 0, -1, 1 };
+    for (int layerOffset: LayerOffsets)
+    {
+        int bestSegment = -1;
+        float bestAlignment = -2.0f;
+        for (int idirection = 0; idirection < eTrafficDirection_COUNT; ++idirection)
+        {
+            int segmentIndex = FindSegment(coordx, coordy, layer + layerOffset, (eTrafficDirection) idirection);
+            if (segmentIndex == -1)
+                continue;
+
+            float alignment = glm::dot(heading, GetDirectionVector((eTrafficDirection) idirection));
+            if (alignment > bestAlignment)
+            {
+                bestAlignment = alignment;
+                bestSegment = segmentIndex;
+            }
+        }
+
+        if (bestSegment != -1)
+            return bestSegment;
+    }
+    return -1;
+}
+
+int TrafficLaneGraph::GetNextSegmentsCount(int segmentIndex) const
+{
+    return GetSegment(segmentIndex).mNextSegmentsCount;
+}
+
+int TrafficLaneGraph::GetNextSegment(int segmentIndex, unsigned int choice) const
+{
+    const TrafficLaneSegment& segment = GetSegment(segmentIndex);
+    if (segment.mNextSegmentsCount == 0)
+        return -1;
+
+    return mNextSegments[segment.mFirstNextSegment + (choice % segment.mNextSegmentsCount)];
+}
+
+glm::vec3 TrafficLaneGraph::GetSegmentPosition(int segmentIndex, float distance) const
+{
+    const TrafficLaneSegment& segment = GetSegment(segmentIndex);
+
+    glm::vec3 position (
+        (segment.mStartX + 0.5f + TrafficDirectionOffsets[segment.mDirection][0] * distance) * MAP_BLOCK_LENGTH,
+        segment.mLayer * MAP_BLOCK_LENGTH,
+        (segment.mStartY + 0.5f + TrafficDirectionOffsets[segment.mDirection][1] * distance) * MAP_BLOCK_LENGTH);
+
+    position.y = gGameMap.GetHeightAtPosition(position);
+    return position;
+}
+
+glm::vec2 TrafficLaneGraph::GetDirectionVector(eTrafficDirection direction)
+{
+    debug_assert(direction < eTrafficDirection_COUNT);
+    return glm::vec2(TrafficDirectionOffsets[direction][0] * 1.0f, TrafficDirectionOffsets[direction][1] * 1.0f);
+}
\ No newline at end of file
@@ -0,0 +1,101 @@
+#pragma once
+
+#include "GameDefs.h"
+
+// traffic movement direction, matches road block direction bits
+enum eTrafficDirection : unsigned char
+{
+    eTrafficDirection_Up, // toward lower map y
+    eTrafficDirection_Down, // toward higher map y
+    eTrafficDirection_Left, // toward lower map x
+    eTrafficDirection_Right, // toward higher map x
+    eTrafficDirection_COUNT
+};
+
+// straight run of road blocks with same traffic direction
+// segment ends at junctions, merges and dead ends, every junction block gets single block segment per exit direction
+struct TrafficLaneSegment
+{
+public:
+    int mFirstNextSegment; // index in next segments list
+    unsigned short mLength; // number of blocks
+    unsigned char mStartX;
+    unsigned char mStartY;
+    unsigned char mLayer;
+    unsigned char mNextSegmentsCount;
+    eTrafficDirection mDirection;
+    bool mIsJunction;
+};
+
+// defines traffic lanes graph compiled from road blocks direction bits
+class TrafficLaneGraph final: public cxx::noncopyable
+{
+public:
+    // compile lanes from currently loaded map data
+    bool Build();
+
+    // free lanes data
+    void Cleanup();
+
+    // find lane segment at specific world position which direction best matches heading
+    // @param position: World position
+    // @param heading: Movement direction in world x and z
+    // @returns -1 if there is no road at position
+    int FindSegment(const glm::vec3& position, const glm::vec2& heading) const;
+
+    // get lane segment passing through map block in specified direction
+    // @returns -1 if there is no lane
+    int FindSegment(int coordx, int coordy, int layer, eTrafficDirection direction) const;
+
+    // get number of segments which continue lane segment
+    // @param segmentIndex: Lane segment
+    int GetNextSegmentsCount(int segmentIndex) const;
+
+    // get segment which continues lane segment, turns are included, u-turns are not
+    // @param segmentIndex: Lane segment
+    // @param choice: Arbitrary number, for example random, used to choose between available next segments
+    // @returns -1 if lane has dead end
+    int GetNextSegment(int segmentIndex, unsigned int choice) const;
+
+    // get world position of point on lane segment
+    // @param segmentIndex: Lane segment
+    // @param distance: Distance from center of first block, in blocks
+    glm::vec3 GetSegmentPosition(int segmentIndex, float distance) const;
+
+    // get world direction of traffic movement
+    static glm::vec2 GetDirectionVector(eTrafficDirection direction);
+
+    inline const TrafficLaneSegment& GetSegment(int segmentIndex) const
+    {
+        debug_assert(segmentIndex > -1 && segmentIndex < GetSegmentsCount());
+        return mSegments[segmentIndex];
+    }
+
+    inline int GetSegmentsCount() const { return (int) mSegments.size(); }
+
+    // test whether graph is built
+    bool IsBuilt() const;
+
+private:
+    // get direction bits of road block, 0 if not a road
+    unsigned int GetBlockDirections(int coordx, int coordy, int layer) const;
+
+    // get next road block in traffic direction, roads may go up or down by single layer on slopes
+    // @returns -1 if there is no road
+    int FindExitBlock(int blockIndex, eTrafficDirection direction) const;
+
+private:
+    // lane segments passing through road block
+    struct BlockLanes
+    {
+    public:
+        int mSegments[eTrafficDirection_COUNT]; // per direction, -1 if no lane
+    };
+
+    std::vector<TrafficLaneSegment> mSegments;
+    std::vector<int> mNextSegments;
+
+    // lane segments of road blocks, per direction
+    std::vector<int> mBlocksLanesIndices; // index in mBlocksLanes for each map block, -1 if not a road
+    std::vector<BlockLanes> mBlocksLanes;
+};
\ No newline at end of file
@@ -0,0 +1,341 @@
+#include "stdafx.h"
+#include "TrafficManager.h"
+#include "CarnageGame.h"
+#include "GameMapManager.h"
+#include "PhysicsComponents.h"
+#include "GameCamera.h"
+
+#define TRAFFIC_SPAWN_ATTEMPTS_PER_FRAME 16
+#define TRAFFIC_PHYSICS_RADIUS_HYSTERESIS 2.0f // prevents cars from switching simulation back and forth
+#define TRAFFIC_SPAWN_CLEARANCE 2.0f // min distance to other cars when spawning, in blocks
+#define TRAFFIC_LANE_CURSOR_DISTANCE 1.5f // physics cars follow point on lane ahead of them, in blocks
+#define TRAFFIC_LANE_LOST_DISTANCE 4.0f // physics car is snapped back to lane if pushed that far, in blocks
+
+inline cxx::angle_t get_lane_heading(const TrafficLaneSegment& segment)
+{
+    glm::vec2 direction = TrafficLaneGraph::GetDirectionVector(segment.mDirection);
+    return cxx::angle_t::from_radians(atan2f(direction.y, direction.x));
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+TrafficManager::TrafficManager()
+    : mRandom(1)
+{
+}
+
+void TrafficManager::Cleanup()
+{
+    for (const TrafficCar& currTrafficCar: mTrafficCars)
+    {
+        if (!currTrafficCar.mPhysicsEnabled)
+            continue;
+
+        Vehicle* car = gCarnageGame.mObjectsManager.GetCarByID(currTrafficCar.mCarID);
+        if (car)
+        {
+            car->mMarkForDeletion = true;
+        }
+    }
+    mTrafficCars.clear();
+    mCarTypes.clear();
+}
+
+int TrafficManager::GetPhysicsCarsCount() const
+{
+    int numPhysicsCars = 0;
+    for (const TrafficCar& currTrafficCar: mTrafficCars)
+    {
+        if (currTrafficCar.mPhysicsEnabled)
+        {
+            ++numPhysicsCars;
+        }
+    }
+    return numPhysicsCars;
+}
+
+void TrafficManager::UpdateFrame(Timespan deltaTime)
+{
+    Pedestrian* player = gCarnageGame.mPlayerPedestrian;
+    if (player == nullptr || !gCarnageGame.mTrafficLaneGraph.IsBuilt())
+        return;
+
+    const glm::vec3 playerPosition = player->mPhysicsComponent->GetPosition();
+    const glm::vec2 centerPosition (playerPosition.x, playerPosition.z);
+    const glm::vec2 cameraPosition (gCamera.mPosition.x, gCamera.mPosition.z);
+
+    const float despawnRadius2 = gGameRules.mTrafficDespawnRadius * gGameRules.mTrafficDespawnRadius;
+    const float physicsEnableRadius = gGameRules.mTrafficPhysicsRadius;
+    const float physicsDisableRadius = gGameRules.mTrafficPhysicsRadius + TRAFFIC_PHYSICS_RADIUS_HYSTERESIS;
+
+    for (size_t icar = 0; icar < mTrafficCars.size(); )
+    {
+        TrafficCar& trafficCar = mTrafficCars[icar];
+
+        bool keepCar = true;
+        Vehicle* car = nullptr;
+        if (trafficCar.mPhysicsEnabled)
+        {
+            // car could be destroyed by someone else
+            car = gCarnageGame.mObjectsManager.GetCarByID(trafficCar.mCarID);
+            keepCar = (car && !car->mMarkForDeletion && !car->mDead);
+            if (keepCar)
+            {
+                trafficCar.mPosition = car->mPhysicsComponent->GetPosition();
+            }
+        }
+
+        if (keepCar)
+        {
+            glm::vec2 carPosition2 (trafficCar.mPosition.x, trafficCar.mPosition.z);
+            keepCar = glm::length2(carPosition2 - centerPosition) <= despawnRadius2;
+            if (keepCar)
+            {
+                float cameraDistance2 = glm::length2(carPosition2 - cameraPosition);
+                if (!trafficCar.mPhysicsEnabled && cameraDistance2 < physicsEnableRadius * physicsEnableRadius)
+                {
+                    car = CreatePhysicsCar(trafficCar);
+                }
+                else if (trafficCar.mPhysicsEnabled && cameraDistance2 > physicsDisableRadius * physicsDisableRadius)
+                {
+                    DestroyPhysicsCar(trafficCar, car);
+                    car = nullptr;
+                }
+            }
+        }
+
+        if (keepCar)
+        {
+            if (trafficCar.mPhysicsEnabled)
+            {
+                UpdatePhysicsCar(trafficCar, car, deltaTime);
+            }
+            else
+            {
+                keepCar = UpdateCarOnLane(trafficCar, gGameRules.mTrafficCarSpeed * deltaTime.ToSeconds());
+                if (keepCar)
+                {
+                    UpdateRailCar(trafficCar);
+                }
+            }
+        }
+
+        if (!keepCar)
+        {
+            if (car)
+            {
+                car->mMarkForDeletion = true;
+            }
+            // order is not important
+            mTrafficCars[icar] = mTrafficCars.back();
+            mTrafficCars.pop_back();
+            continue;
+        }
+        ++icar;
+    }
+
+    SpawnCars(centerPosition);
+}
+
+void TrafficManager::SpawnCars(const glm::vec2& centerPosition)
+{
+    const TrafficLaneGraph& laneGraph = gCarnageGame.mTrafficLaneGraph;
+
+    if (mCarTypes.empty())
+    {
+        const StyleData& styleData = gGameMap.mStyleData;
+        for (int icartype = 0, numCarTypes = (int) styleData.mCars.size(); icartype < numCarTypes; ++icartype)
+        {
+            eCarVType vtype = styleData.mCars[icartype].mVType;
+            if (vtype == eCarVType_StandardCar || vtype == eCarVType_Bus)
+            {
+                mCarTypes.push_back(icartype);
+            }
+        }
+        if (mCarTypes.empty())
+            return;
+    }
+
+    const float spawnMinDistance = gGameRules.mTrafficSpawnMinDistance;
+    const float spawnMaxDistance = glm::max(gGameRules.mTrafficSpawnRadius, spawnMinDistance);
+
+    for (int iattempt = 0; iattempt < TRAFFIC_SPAWN_ATTEMPTS_PER_FRAME; ++iattempt)
+    {
+        if ((int) mTrafficCars.size() >= gGameRules.mTrafficCarsBudget)
+            break;
+
+        // pick random block within spawn ring
+        cxx::angle_t spawnAngle = cxx::angle_t::from_degrees(mRandom.generate_float() * 360.0f);
+        float spawnDistance = spawnMinDistance + mRandom.generate_float() * (spawnMaxDistance - spawnMinDistance);
+        int coordx = (int) floorf((centerPosition.x + cosf(spawnAngle.to_radians()) * spawnDistance) / MAP_BLOCK_LENGTH);
+        int coordy = (int) floorf((centerPosition.y + sinf(spawnAngle.to_radians()) * spawnDistance) / MAP_BLOCK_LENGTH);
+
+        int laneSegment = -1;
+        int firstDirection = mRandom.generate_int(eTrafficDirection_COUNT);
+        for (int layer = MAP_LAYERS_COUNT - 1; layer > -1 && laneSegment == -1; --layer)
+        for (int idirection = 0; idirection < eTrafficDirection_COUNT && laneSegment == -1; ++idirection)
+        {
+            laneSegment = laneGraph.FindSegment(coordx, coordy, layer, (eTrafficDirection) ((firstDirection + idirection) % eTrafficDirection_COUNT));
+        }
+
+        if (laneSegment == -1)
+            continue;
+
+        const TrafficLaneSegment& segment = laneGraph.GetSegment(laneSegment);
+        float laneDistance = (float) (abs(coordx - segment.mStartX) + abs(coordy - segment.mStartY));
+
+        glm::vec3 spawnPosition = laneGraph.GetSegmentPosition(laneSegment, laneDistance);
+
+        const glm::vec2 spawnPosition2 (spawnPosition.x, spawnPosition.z);
+
+        // cars without physics are not registered in cars grid
+        mQueryCars.clear();
+        if (gCarnageGame.mObjectsManager.mCarsGrid.QueryRadius(spawnPosition2, TRAFFIC_SPAWN_CLEARANCE, mQueryCars) > 0 ||
+            HasRailCarsInRadius(spawnPosition2, TRAFFIC_SPAWN_CLEARANCE))
+        {
+            continue;
+        }
+
+        TrafficCar trafficCar;
+        trafficCar.mCarID = 0;
+        trafficCar.mCarType = mCarTypes[mRandom.generate_int((int) mCarTypes.size())];
+        trafficCar.mLaneSegment = laneSegment;
+        trafficCar.mLaneDistance = laneDistance;
+        trafficCar.mRouteSeed = (unsigned int) mRandom.generate_int();
+        trafficCar.mPosition = spawnPosition;
+        trafficCar.mPhysicsEnabled = false;
+        mTrafficCars.push_back(trafficCar);
+
+        // cars are spawned away from camera so most of them starts as lane records
+        glm::vec2 cameraPosition (gCamera.mPosition.x, gCamera.mPosition.z);
+        if (glm::length(spawnPosition2 - cameraPosition) <= gGameRules.mTrafficPhysicsRadius)
+        {
+            CreatePhysicsCar(mTrafficCars.back());
+        }
+    }
+}
+
+bool TrafficManager::UpdateCarOnLane(TrafficCar& trafficCar, float distance)
+{
+    const TrafficLaneGraph& laneGraph = gCarnageGame.mTrafficLaneGraph;
+
+    trafficCar.mLaneDistance += distance;
+    for (;;)
+    {
+        const TrafficLaneSegment& segment = laneGraph.GetSegment(trafficCar.mLaneSegment);
+        if (trafficCar.mLaneDistance < segment.mLength)
+            break;
+
+        int nextSegment = laneGraph.GetNextSegment(trafficCar.mLaneSegment, trafficCar.mRouteSeed);
+        if (nextSegment == -1) // dead end
+        {
+            trafficCar.mLaneDistance = segment.mLength - 1.0f;
+            return false;
+        }
+
+        trafficCar.mLaneDistance -= segment.mLength;
+        trafficCar.mLaneSegment = nextSegment;
+        trafficCar.mRouteSeed = trafficCar.mRouteSeed * 1664525u + 1013904223u;
+    }
+    return true;
+}
+
+void TrafficManager::UpdateRailCar(TrafficCar& trafficCar)
+{
+    const TrafficLaneGraph& laneGraph = gCarnageGame.mTrafficLaneGraph;
+
+    trafficCar.mPosition = laneGraph.GetSegmentPosition(trafficCar.mLaneSegment, trafficCar.mLaneDistance);
+}
+
+void TrafficManager::UpdatePhysicsCar(TrafficCar& trafficCar, Vehicle* car, Timespan deltaTime)
+{
+    const TrafficLaneGraph& laneGraph = gCarnageGame.mTrafficLaneGraph;
+
+    PhysicsComponent* physicsComponent = car->mPhysicsComponent;
+
+    const glm::vec3 carPosition = physicsComponent->GetPosition();
+    const glm::vec2 carPosition2 (carPosition.x, carPosition.z);
+
+    glm::vec3 cursorPosition = laneGraph.GetSegmentPosition(trafficCar.mLaneSegment, trafficCar.mLaneDistance);
+    glm::vec2 toCursor = glm::vec2(cursorPosition.x, cursorPosition.z) - carPosition2;
+
+    // car was pushed away from its lane
+    if (glm::length(toCursor) > TRAFFIC_LANE_LOST_DISTANCE)
+    {
+        int laneSegment = laneGraph.FindSegment(carPosition, physicsComponent->GetSignVector());
+        if (laneSegment == -1)
+        {
+            physicsComponent->SetLinearVelocity(glm::vec2(0.0f));
+            physicsComponent->SetAngularVelocity(0.0f);
+            return;
+        }
+        const TrafficLaneSegment& segment = laneGraph.GetSegment(laneSegment);
+        trafficCar.mLaneSegment = laneSegment;
+        trafficCar.mLaneDistance = (float) (abs((int) carPosition.x - segment.mStartX) + abs((int) carPosition.z - segment.mStartY));
+        cursorPosition = laneGraph.GetSegmentPosition(trafficCar.mLaneSegment, trafficCar.mLaneDistance);
+        toCursor = glm::vec2(cursorPosition.x, cursorPosition.z) - carPosition2;
+    }
+
+    // move cursor ahead while car keeps up with it, car stops at dead ends
+    float cursorDistance = glm::length(toCursor);
+    if (cursorDistance < TRAFFIC_LANE_CURSOR_DISTANCE)
+    {
+        UpdateCarOnLane(trafficCar, gGameRules.mTrafficCarSpeed * deltaTime.ToSeconds());
+    }
+
+    if (cursorDistance < 0.05f)
+    {
+        physicsComponent->SetLinearVelocity(glm::vec2(0.0f));
+        physicsComponent->SetAngularVelocity(0.0f);
+        return;
+    }
+
+    glm::vec2 moveDirection = toCursor / cursorDistance;
+    physicsComponent->SetLinearVelocity(moveDirection * gGameRules.mTrafficCarSpeed);
+
+    cxx::angle_t angleDelta = cxx::angle_t::from_radians(atan2f(moveDirection.y, moveDirection.x)) - physicsComponent->GetRotationAngle();
+    angleDelta.normalize_angle_180();
+    physicsComponent->SetAngularVelocity(glm::clamp(angleDelta.to_degrees() * 4.0f, -180.0f, 180.0f));
+}
+
+Vehicle* TrafficManager::CreatePhysicsCar(TrafficCar& trafficCar)
+{
+    debug_assert(!trafficCar.mPhysicsEnabled);
+
+    const TrafficLaneGraph& laneGraph = gCarnageGame.mTrafficLaneGraph;
+
+    Vehicle* car = gCarnageGame.mObjectsManager.CreateCar(trafficCar.mPosition, trafficCar.mCarType);
+    debug_assert(car);
+
+    car->mPhysicsComponent->SetPosition(trafficCar.mPosition, get_lane_heading(laneGraph.GetSegment(trafficCar.mLaneSegment)));
+
+    trafficCar.mCarID = car->mObjectID;
+    trafficCar.mPhysicsEnabled = true;
+    return car;
+}
+
+void TrafficManager::DestroyPhysicsCar(TrafficCar& trafficCar, Vehicle* car)
+{
+    debug_assert(trafficCar.mPhysicsEnabled);
+    debug_assert(car);
+
+    // car continues from its lane cursor
+    car->mMarkForDeletion = true;
+    trafficCar.mCarID = 0;
+    trafficCar.mPhysicsEnabled = false;
+    UpdateRailCar(trafficCar);
+}
+
+bool TrafficManager::HasRailCarsInRadius(const glm::vec2& position, float radius) const
+{
+    const float radius2 = radius * radius;
+    for (const TrafficCar& currTrafficCar: mTrafficCars)
+    {
+        if (currTrafficCar.mPhysicsEnabled)
+            continue;
+
+        if (glm::length2(glm::vec2(currTrafficCar.mPosition.x, currTrafficCar.mPosition.z) - position) < radius2)
+            return true;
+    }
+    return false;
+}
\ No newline at end of file
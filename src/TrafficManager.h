@@ -0,0 +1,59 @@
+#pragma once
+
+#include "GameDefs.h"
+
+// defines ambient traffic, cars are spawned around player and driven along traffic lanes
+// cars near camera are fully simulated by physics engine, distant cars are plain lane records without
+// game object and physics body, body is created once car enters physics radius and destroyed when it leaves
+class TrafficManager final: public cxx::noncopyable
+{
+public:
+    TrafficManager();
+
+    // remove all traffic cars
+    void Cleanup();
+
+    // spawn, despawn and drive traffic cars
+    // @param deltaTime: Time since last frame
+    void UpdateFrame(Timespan deltaTime);
+
+    // get traffic stats
+    inline int GetCarsCount() const { return (int) mTrafficCars.size(); }
+    int GetPhysicsCarsCount() const;
+
+private:
+    // traffic car state
+    struct TrafficCar
+    {
+    public:
+        GameObjectID_t mCarID; // valid only while physics is enabled
+        int mCarType;
+        int mLaneSegment;
+        float mLaneDistance; // distance from lane segment start, in blocks
+        unsigned int mRouteSeed; // used to choose turns
+        glm::vec3 mPosition; // current position, updated each frame
+        bool mPhysicsEnabled; // car game object with physics body exists
+    };
+
+    void SpawnCars(const glm::vec2& centerPosition);
+    bool UpdateCarOnLane(TrafficCar& trafficCar, float distance);
+    void UpdateRailCar(TrafficCar& trafficCar);
+    void UpdatePhysicsCar(TrafficCar& trafficCar, Vehicle* car, Timespan deltaTime);
+
+    // create car game object at current lane position or destroy it, car continues as lane record then
+    // @param trafficCar: Traffic car
+    // @param car: Car game object of traffic car
+    Vehicle* CreatePhysicsCar(TrafficCar& trafficCar);
+    void DestroyPhysicsCar(TrafficCar& trafficCar, Vehicle* car);
+
+    // test whether there are cars without physics near specified position
+    // @param position: Position on map
+    // @param radius: Search radius, in blocks
+    bool HasRailCarsInRadius(const glm::vec2& position, float radius) const;
+
+private:
+    std::vector<TrafficCar> mTrafficCars;
+    std::vector<int> mCarTypes; // car styles suitable for traffic
+    std::vector<Vehicle*> mQueryCars;
+    cxx::randomizer mRandom;
+};
\ No newline at end of file
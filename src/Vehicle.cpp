@@ -3,14 +3,14 @@
 #include "PhysicsManager.h"
 #include "PhysicsComponents.h"
 #include "GameMapManager.h"
-#include "SpriteBatch.h"
 #include "RenderingManager.h"
-#include "SpriteManager.h"
+#include "RenderSnapshot.h"
 
 Vehicle::Vehicle(GameObjectID_t id)
     : GameObject(id)
     , mActiveCarsNode(this)
     , mDeleteCarsNode(this)
+    , mGridNode(this)
     , mPhysicsComponent()
     , mDead()
     , mCarStyle()
@@ -24,7 +24,6 @@ Vehicle::~Vehicle()
     {
         gPhysics.DestroyPhysicsComponent(mPhysicsComponent);
     }
-    gSpriteManager.FlushSpritesCache(mObjectID);
 }
 
 void Vehicle::EnterTheGame()
@@ -49,20 +48,20 @@ void Vehicle::UpdateFrame(Timespan deltaTime)
     UpdateDeltaAnimations(deltaTime);
 }
 
-void Vehicle::DrawFrame(SpriteBatch& spriteBatch)
+void Vehicle::CaptureDrawState(SpriteDrawState& drawState)
 {   
-    cxx::angle_t rotationAngle = mPhysicsComponent->GetRotationAngle() - cxx::angle_t::from_degrees(SPRITE_ZERO_ANGLE);
+    const float interpolationFactor = gPhysics.GetInterpolationFactor();
 
-    glm::vec3 position = mPhysicsComponent->GetPosition();
+    cxx::angle_t rotationAngle = mPhysicsComponent->GetInterpolatedRotationAngle(interpolationFactor) - cxx::angle_t::from_degrees(SPRITE_ZERO_ANGLE);
+
+    glm::vec3 position = mPhysicsComponent->GetInterpolatedPosition(interpolationFactor);
     position.y = ComputeDrawHeight(position, rotationAngle);
 
-    gSpriteManager.GetSpriteTexture(mObjectID, mChassisSpriteIndex, GetSpriteDeltas(), mChassisDrawSprite);
-    mChassisDrawSprite.mPosition = glm::vec2(position.x, position.z);
-    mChassisDrawSprite.mScale = SPRITE_SCALE;
-    mChassisDrawSprite.mRotateAngle = rotationAngle;
-    mChassisDrawSprite.mHeight = ComputeDrawHeight(position, rotationAngle);
-    mChassisDrawSprite.SetOriginToCenter();
-    spriteBatch.DrawSprite(mChassisDrawSprite);
+    drawState.mObjectID = mObjectID;
+    drawState.mSpriteIndex = mChassisSpriteIndex;
+    drawState.mSpriteDeltaBits = GetSpriteDeltas();
+    drawState.mPosition = glm::vec3(position.x, ComputeDrawHeight(position, rotationAngle), position.z);
+    drawState.mRotateAngle = rotationAngle;
 
 #if 1 // debug
     // draw doors
@@ -3,13 +3,15 @@
 #include "GameDefs.h"
 #include "PhysicsDefs.h"
 #include "GameObject.h"
+#include "GameObjectsGrid.h"
 
-class SpriteBatch;
+struct SpriteDrawState;
 
 // defines vehicle instance
 class Vehicle final: public GameObject
 {
     friend class GameObjectsManager;
+    friend class GameObjectsGrid<Vehicle>;
 
 public:
     // public for convenience, should not be modified directly
@@ -28,7 +30,10 @@ public:
     void EnterTheGame();
 
     void UpdateFrame(Timespan deltaTime);
-    void DrawFrame(SpriteBatch& spriteBatch);
+
+    // get current sprite state for render snapshot
+    // @param drawState: Output state
+    void CaptureDrawState(SpriteDrawState& drawState);
 
     // doors animations
     void OpenDoor(int doorIndex);
@@ -53,8 +58,6 @@ private:
     SpriteDeltaBits_t GetSpriteDeltas() const;
 
 private:
-    Sprite mChassisDrawSprite;
-
     SpriteAnimation mDoorsAnims[MAX_CAR_DOORS];
     SpriteAnimation mEmergLightsAnim;
     SpriteDeltaBits_t mDamageDeltaBits;
@@ -64,4 +67,5 @@ private:
     // internal stuff that can be touched only by CarsManager
     cxx::intrusive_node<Vehicle> mActiveCarsNode;
     cxx::intrusive_node<Vehicle> mDeleteCarsNode;
+    GameObjectsGridNode<Vehicle> mGridNode;
 };
\ No newline at end of file
@@ -386,4 +386,11 @@ impl_enum_strings(eCarModel)
     {eCarModel_Limousine_2, "limousine_2"},
     {eCarModel_Impaler_2, "impaler_2"},
     {eCarModel_Helicopter, "helicopter"},
+};
+
+impl_enum_strings(eSimulationLOD)
+{
+    {eSimulationLOD_Full, "full"},
+    {eSimulationLOD_Reduced, "reduced"},
+    {eSimulationLOD_Dormant, "dormant"},
 };
\ No newline at end of file
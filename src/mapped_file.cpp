@@ -0,0 +1,103 @@
+#include "stdafx.h"
+#include "mapped_file.h"
+
+#if OS_NAME == OS_WINDOWS
+    #define WIN32_LEAN_AND_MEAN
+    #define NOMINMAX
+    #include <windows.h>
+#elif OS_NAME == OS_LINUX
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <fcntl.h>
+    #include <unistd.h>
+#endif
+
+namespace cxx
+{
+
+mapped_file::~mapped_file()
+{
+    unmap_file();
+}
+
+bool mapped_file::map_file(const std::string& pathto)
+{
+    unmap_file();
+
+#if OS_NAME == OS_WINDOWS
+    HANDLE fileHandle = ::CreateFileA(pathto.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (fileHandle == INVALID_HANDLE_VALUE)
+        return false;
+
+    LARGE_INTEGER fileSize;
+    if (!::GetFileSizeEx(fileHandle, &fileSize) || fileSize.QuadPart == 0 || fileSize.HighPart != 0)
+    {
+        ::CloseHandle(fileHandle);
+        return false;
+    }
+
+    HANDLE mappingHandle = ::CreateFileMappingA(fileHandle, NULL, PAGE_WRITECOPY, 0, 0, NULL);
+    if (mappingHandle == NULL)
+    {
+        ::CloseHandle(fileHandle);
+        return false;
+    }
+
+    void* mappedData = ::MapViewOfFile(mappingHandle, FILE_MAP_COPY, 0, 0, 0);
+    if (mappedData == NULL)
+    {
+        ::CloseHandle(mappingHandle);
+        ::CloseHandle(fileHandle);
+        return false;
+    }
+
+    mFileHandle = fileHandle;
+    mMappingHandle = mappingHandle;
+    mMappedData = static_cast<unsigned char*>(mappedData);
+    mMappedDataLength = static_cast<unsigned int>(fileSize.LowPart);
+    return true;
+#elif OS_NAME == OS_LINUX
+    int fileDescriptor = ::open(pathto.c_str(), O_RDONLY);
+    if (fileDescriptor == -1)
+        return false;
+
+    struct stat fileStat;
+    if (::fstat(fileDescriptor, &fileStat) == -1 || fileStat.st_size == 0)
+    {
+        ::close(fileDescriptor);
+        return false;
+    }
+
+    void* mappedData = ::mmap(nullptr, fileStat.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fileDescriptor, 0);
+    ::close(fileDescriptor); // mapping keeps its own reference to file
+    if (mappedData == MAP_FAILED)
+        return false;
+
+    mMappedData = static_cast<unsigned char*>(mappedData);
+    mMappedDataLength = static_cast<unsigned int>(fileStat.st_size);
+    return true;
+#else
+    debug_assert(false);
+    return false;
+#endif
+}
+
+void mapped_file::unmap_file()
+{
+    if (mMappedData == nullptr)
+        return;
+
+#if OS_NAME == OS_WINDOWS
+    ::UnmapViewOfFile(mMappedData);
+    ::CloseHandle(mMappingHandle);
+    ::CloseHandle(mFileHandle);
+    mMappingHandle = nullptr;
+    mFileHandle = nullptr;
+#elif OS_NAME == OS_LINUX
+    ::munmap(mMappedData, mMappedDataLength);
+#endif
+    mMappedData = nullptr;
+    mMappedDataLength = 0;
+}
+
+} // namespace cxx
\ No newline at end of file
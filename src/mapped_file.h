@@ -0,0 +1,38 @@
+#pragma once
+
+namespace cxx
+{
+    // implements file that mapped into process address space
+
+    class mapped_file: public noncopyable
+    {
+    public:
+        mapped_file() = default;
+        ~mapped_file();
+
+        // map existing file into memory, pages are private and copy-on-write
+        // so modifications is allowed but they never written back to file
+        // @param pathto: Path to file
+        // @returns false on error
+        bool map_file(const std::string& pathto);
+
+        // unmap currently mapped file
+        void unmap_file();
+
+        // test whether file is mapped
+        inline bool is_mapped() const { return mMappedData != nullptr; }
+
+        // get mapped data, returns null if file is not mapped
+        inline unsigned char* get_data() const { return mMappedData; }
+        inline unsigned int get_data_length() const { return mMappedDataLength; }
+
+    private:
+        unsigned char* mMappedData = nullptr;
+        unsigned int mMappedDataLength = 0;
+#if OS_NAME == OS_WINDOWS
+        void* mFileHandle = nullptr;
+        void* mMappingHandle = nullptr;
+#endif
+    };
+
+} // namespace cxx
\ No newline at end of file
@@ -196,6 +196,10 @@ namespace cxx
             }
 
             TPoolElement* poolElement = mFirstChunk->allocate_object(std::forward<TArgs>(args)...);
+            if (++mAllocatedCount > mHighWaterMark)
+            {
+                mHighWaterMark = mAllocatedCount;
+            }
             return poolElement;
         }
         // return object to pool
@@ -205,6 +209,7 @@ namespace cxx
             if (mFirstChunk)
             {
                 mFirstChunk->deallocate_object(element);
+                --mAllocatedCount;
             }
         }
         // frees allocated memory but does not destruct objects inside pool - user must do it manually
@@ -215,9 +220,16 @@ namespace cxx
                 delete mFirstChunk;
                 mFirstChunk = nullptr;
             }
+            mAllocatedCount = 0;
         }
+        // get number of objects currently in use
+        inline int get_allocated_count() const { return mAllocatedCount; }
+        // get max number of objects that were in use simultaneously
+        inline int get_high_water_mark() const { return mHighWaterMark; }
     private:
         pool_chunk_t* mFirstChunk = nullptr;
+        int mAllocatedCount = 0;
+        int mHighWaterMark = 0;
     };
 
 } // namespace cxx
\ No newline at end of file
@@ -74,6 +74,22 @@ bool is_directory_exists(std::string pathto)
     return filesystem::is_directory(pathto);
 }
 
+bool get_file_stats(std::string pathto, unsigned long long& fileSize, long long& lastWriteTime)
+{
+    filesystem::path sourcePath {pathto};
+    std::error_code errorCode;
+    fileSize = filesystem::file_size(sourcePath, errorCode);
+    if (errorCode)
+        return false;
+
+    filesystem::file_time_type writeTime = filesystem::last_write_time(sourcePath, errorCode);
+    if (errorCode)
+        return false;
+
+    lastWriteTime = static_cast<long long>(writeTime.time_since_epoch().count());
+    return true;
+}
+
 bool ensure_path_exists(std::string pathto)
 {
     filesystem::path sourcePath {pathto};
@@ -33,6 +33,12 @@ namespace cxx
     // @param sourcePath: Path
     bool is_directory_exists(std::string pathto);
 
+    // get file size and last write time without reading its content
+    // @param sourcePath: Path
+    // @param fileSize: Output size in bytes
+    // @param lastWriteTime: Output last write time, only comparable with values returned by this function
+    bool get_file_stats(std::string pathto, unsigned long long& fileSize, long long& lastWriteTime);
+
     // create directories in path
     bool ensure_path_exists(std::string pathto);
 
@@ -57,12 +57,17 @@ inline void SafeDeleteArray(TElement*& elementPointer)
 #include <deque>
 #include <list>
 #include <algorithm>
+#include <limits>
 #include <iostream>
 #include <fstream>
 #include <stdint.h>
 #include <cctype>
 #include <chrono>
 #include <thread>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
 
 // opengl
 #include <GL/glew.h>
@@ -97,6 +102,7 @@ inline void SafeDeleteArray(TElement*& elementPointer)
 #include "path_utils.h"
 #include "config_document.h"
 #include "mem_allocators.h"
+#include "mapped_file.h"
 
 // app
 #include "CommonTypes.h"